@@ -1,4 +1,4 @@
-QT       += core gui multimedia multimediawidgets
+QT       += core gui multimedia multimediawidgets network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -11,13 +11,94 @@ CONFIG += c++17
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
+    mediapath.cpp \
     settingsdialog.cpp \
-    positiondialog.cpp
+    positiondialog.cpp \
+    startupprofiler.cpp \
+    uirefreshscheduler.cpp \
+    readaheaddevice.cpp \
+    streamcache.cpp \
+    streamproxy.cpp \
+    singleinstance.cpp \
+    playlistio.cpp \
+    simdkernels.cpp \
+    videoframeutils.cpp \
+    scenedetector.cpp \
+    gridplaybackview.cpp \
+    subtitletrack.cpp \
+    subtitleindex.cpp \
+    subtitlesearchdialog.cpp \
+    segmentcache.cpp \
+    segmentplaybackview.cpp \
+    framecapture.cpp \
+    waveformgenerator.cpp \
+    waveformstrip.cpp \
+    perceptualhash.cpp \
+    framesampler.cpp \
+    duplicatefinder.cpp \
+    duplicatefinderdialog.cpp \
+    metadataprober.cpp \
+    playlistdelegate.cpp \
+    playbackqueue.cpp \
+    playlistmodel.cpp \
+    tracer.cpp \
+    videohash.cpp \
+    thumbnailcache.cpp \
+    thumbnailprovider.cpp \
+    audiobufferutils.cpp \
+    fft.cpp \
+    spectrumanalyzer.cpp \
+    spectrumview.cpp \
+    motioninterpolator.cpp \
+    slowmotionview.cpp \
+    keyframeindex.cpp \
+    metrics.cpp
 
 HEADERS += \
     mainwindow.h \
+    mediapath.h \
     settingsdialog.h \
-    positiondialog.h
+    positiondialog.h \
+    startupprofiler.h \
+    timeformat.h \
+    uirefreshscheduler.h \
+    readaheaddevice.h \
+    streamcache.h \
+    streamproxy.h \
+    singleinstance.h \
+    playlistio.h \
+    simdkernels.h \
+    videoframeutils.h \
+    scenedetector.h \
+    gridplaybackview.h \
+    subtitletrack.h \
+    subtitleindex.h \
+    subtitlesearchdialog.h \
+    segmentcache.h \
+    segmentplaybackview.h \
+    framecapture.h \
+    waveformgenerator.h \
+    waveformstrip.h \
+    perceptualhash.h \
+    framesampler.h \
+    duplicatefinder.h \
+    duplicatefinderdialog.h \
+    metadataprober.h \
+    playlistdelegate.h \
+    playbackqueue.h \
+    playlistmodel.h \
+    tracer.h \
+    videohash.h \
+    thumbnailcache.h \
+    thumbnailprovider.h \
+    audiobufferutils.h \
+    fft.h \
+    spectrumanalyzer.h \
+    spectrumview.h \
+    motioninterpolator.h \
+    slowmotionview.h \
+    keyframeindex.h \
+    metrics.h
 
 RESOURCES += \
     resources.qrc
@@ -25,6 +106,9 @@ RESOURCES += \
 # Windows应用程序图标
 win32:RC_FILE = VideoPlayer.rc
 
+# 指标中的进程内存（GetProcessMemoryInfo）
+win32:LIBS += -lpsapi
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -0,0 +1,55 @@
+#include "audiobufferutils.h"
+#include <QAudioFormat>
+#include <algorithm>
+
+namespace AudioBufferUtils {
+
+void toMonoFloat(const QAudioBuffer &buffer, std::vector<float> &out)
+{
+    const QAudioFormat format = buffer.format();
+    const int channels = qMax(1, format.channelCount());
+    const qsizetype frames = buffer.frameCount();
+    out.resize(size_t(frames));
+    
+    auto mix = [&](auto sampleAt) {
+        for (qsizetype frame = 0; frame < frames; ++frame) {
+            float sum = 0.0f;
+            for (int channel = 0; channel < channels; ++channel) {
+                sum += sampleAt(frame * channels + channel);
+            }
+            out[size_t(frame)] = sum / channels;
+        }
+    };
+    
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float: {
+        const float *data = buffer.constData<float>();
+        if (channels == 1) {
+            std::copy(data, data + frames, out.begin());
+        } else {
+            mix([data](qsizetype i) { return data[i]; });
+        }
+        break;
+    }
+    case QAudioFormat::Int16: {
+        const qint16 *data = buffer.constData<qint16>();
+        mix([data](qsizetype i) { return data[i] / 32768.0f; });
+        break;
+    }
+    case QAudioFormat::Int32: {
+        const qint32 *data = buffer.constData<qint32>();
+        mix([data](qsizetype i) { return float(data[i] / 2147483648.0); });
+        break;
+    }
+    case QAudioFormat::UInt8: {
+        const quint8 *data = buffer.constData<quint8>();
+        mix([data](qsizetype i) { return (int(data[i]) - 128) / 128.0f; });
+        break;
+    }
+    default:
+        out.clear();
+        break;
+    }
+}
+
+}
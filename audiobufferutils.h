@@ -0,0 +1,15 @@
+#ifndef AUDIOBUFFERUTILS_H
+#define AUDIOBUFFERUTILS_H
+
+#include <QAudioBuffer>
+#include <vector>
+
+// 音频缓冲辅助函数
+namespace AudioBufferUtils {
+
+// 把任意格式的缓冲转换为单声道浮点（多声道取平均），不支持的格式得到空结果
+void toMonoFloat(const QAudioBuffer &buffer, std::vector<float> &out);
+
+}
+
+#endif // AUDIOBUFFERUTILS_H
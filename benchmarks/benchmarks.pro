@@ -0,0 +1,27 @@
+# 播放列表和媒体库操作的性能基准（不涉及解码）
+# 运行: ./benchmarks            打印结果
+#       ./benchmarks -o results.csv,csv    输出CSV（也可用 xml、junitxml、tap 等格式）
+#       ./benchmarks -tickcounter          按CPU周期计数
+
+QT       += core gui testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = benchmarks
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    playlistbenchmark.cpp \
+    ../playbackqueue.cpp \
+    ../playlistmodel.cpp \
+    ../videohash.cpp \
+    ../mediapath.cpp
+
+HEADERS += \
+    ../playbackqueue.h \
+    ../playlistmodel.h \
+    ../videohash.h \
+    ../mediapath.h \
+    ../timeformat.h
@@ -0,0 +1,278 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QFile>
+#include <QDir>
+#include <QRandomGenerator>
+#include "playlistmodel.h"
+#include "videohash.h"
+#include "mediapath.h"
+#include "timeformat.h"
+
+namespace {
+
+// 与MainWindow::loadVideosFromFolder使用的扩展名一致
+const QStringList VideoExtensions = {"*.mp4", "*.avi", "*.mkv", "*.mov", "*.wmv", "*.flv", "*.webm", "*.m4v", "*.3gp", "*.ts", "*.mts"};
+
+QString episodeName(int index)
+{
+    // 数字不补零，名称排序需要按数值比较
+    return QString("Episode %1.mp4").arg(index);
+}
+
+QList<QueueEntry> syntheticEntries(int count, const QString &folder = "/videos")
+{
+    QList<QueueEntry> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QueueEntry entry;
+        entry.title = episodeName(i);
+        entry.path = folder + "/" + entry.title;
+        entries.append(entry);
+    }
+    return entries;
+}
+
+}
+
+class PlaylistBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void enumerateFolder_data();
+    void enumerateFolder();
+    void addVideoFiles_data();
+    void addVideoFiles();
+    void appendDuplicates_data();
+    void appendDuplicates();
+    void moveAndRemove_data();
+    void moveAndRemove();
+    void resortByName_data();
+    void resortByName();
+    void videoHash();
+    void resumePositionLookup_data();
+    void resumePositionLookup();
+    void formatTime();
+
+private:
+    void addScaleRows();
+
+    QTemporaryDir m_folder;
+    QHash<int, QString> m_folders;   // 文件数 -> 存放这些空文件的目录
+};
+
+void PlaylistBenchmark::initTestCase()
+{
+    QVERIFY(m_folder.isValid());
+    // 文件夹扫描只依赖目录项，用空文件代替视频
+    for (int count : {10000, 100000}) {
+        QString folder = m_folder.filePath(QString::number(count));
+        QVERIFY(QDir().mkpath(folder));
+        for (int i = 0; i < count; ++i) {
+            QFile file(folder + "/" + episodeName(i));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+        m_folders.insert(count, folder);
+    }
+}
+
+void PlaylistBenchmark::addScaleRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void PlaylistBenchmark::enumerateFolder_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::enumerateFolder()
+{
+    QFETCH(int, count);
+    const QString folder = m_folders.value(count);
+
+    // 与打开文件夹相同：列出文件、加入列表、按名称自然排序
+    QBENCHMARK {
+        PlaylistModel model;
+        QFileInfoList files = QDir(folder).entryInfoList(VideoExtensions, QDir::Files | QDir::Readable, QDir::NoSort);
+        QList<QueueEntry> entries;
+        entries.reserve(files.size());
+        for (const QFileInfo &fileInfo : std::as_const(files)) {
+            QueueEntry entry;
+            entry.path = fileInfo.absoluteFilePath();
+            entry.title = fileInfo.fileName();
+            entries.append(entry);
+        }
+        model.append(entries);
+        model.sortBy(PlaylistModel::SortByName);
+        QCOMPARE(model.rowCount(), count);
+    }
+}
+
+void PlaylistBenchmark::addVideoFiles_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::addVideoFiles()
+{
+    QFETCH(int, count);
+    const QString folder = m_folders.value(count);
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        paths.append(folder + "/" + episodeName(i));
+    }
+
+    // 与MainWindow::addVideoFile相同：检查文件和格式、去重后逐个添加，
+    // 与拖入或命令行打开多个文件相同
+    QBENCHMARK {
+        PlaylistModel model;
+        for (const QString &path : std::as_const(paths)) {
+            QueueEntry entry;
+            if (queueEntryForPath(path, &entry) && !model.containsPath(entry.path)) {
+                model.append({entry});
+            }
+        }
+        QCOMPARE(model.rowCount(), count);
+    }
+}
+
+void PlaylistBenchmark::appendDuplicates_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::appendDuplicates()
+{
+    QFETCH(int, count);
+    const QList<QueueEntry> entries = syntheticEntries(count);
+    PlaylistModel model;
+    model.append(entries);
+
+    // 重复的路径全部被忽略
+    QBENCHMARK {
+        model.append(entries);
+    }
+    QCOMPARE(model.rowCount(), count);
+}
+
+void PlaylistBenchmark::moveAndRemove_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::moveAndRemove()
+{
+    QFETCH(int, count);
+    const QList<QueueEntry> entries = syntheticEntries(count);
+    constexpr int Operations = 1000;
+    // 列表在计时之外建立，只计移动和删除；操作会改变列表，所以只运行一次
+    PlaylistModel model;
+    model.append(entries);
+    PlaylistModel::ItemId current = model.idAt(count / 2);
+    model.setCurrent(current);
+    QRandomGenerator random(42);
+
+    // 随机上下移动和删除，当前播放项始终跟随
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < Operations; ++i) {
+            int rows = model.rowCount();
+            int row = int(random.bounded(rows));
+            if (i % 4 == 3 && model.idAt(row) != current) {
+                model.removeRows(row, 1);
+            } else {
+                int destination = int(random.bounded(rows + 1));
+                model.moveRows(QModelIndex(), row, 1, QModelIndex(), destination);
+            }
+        }
+    }
+    QCOMPARE(model.queue().current(), current);
+    QCOMPARE(model.idAt(model.rowOf(current)), current);
+}
+
+void PlaylistBenchmark::resortByName_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::resortByName()
+{
+    QFETCH(int, count);
+    PlaylistModel model;
+    model.append(syntheticEntries(count));
+    // 第一次排序计算并缓存排序键，之后只比较缓存的键
+    model.sortBy(PlaylistModel::SortByName);
+
+    bool descending = false;
+    QBENCHMARK {
+        descending = !descending;
+        model.sortBy(PlaylistModel::SortByName, descending ? Qt::DescendingOrder : Qt::AscendingOrder);
+    }
+    QCOMPARE(model.rowCount(), count);
+}
+
+void PlaylistBenchmark::videoHash()
+{
+    // 真实文件，包含读取文件大小和修改时间的开销
+    const QString folder = m_folders.value(10000);
+    QStringList paths;
+    for (int i = 0; i < 1000; ++i) {
+        paths << folder + "/" + episodeName(i);
+    }
+
+    QBENCHMARK {
+        for (const QString &path : std::as_const(paths)) {
+            QVERIFY(!VideoHash::compute(path).isEmpty());
+        }
+    }
+}
+
+void PlaylistBenchmark::resumePositionLookup_data()
+{
+    addScaleRows();
+}
+
+void PlaylistBenchmark::resumePositionLookup()
+{
+    QFETCH(int, count);
+
+    // 设置中保存了count个视频的播放位置，查找其中1000个
+    QSettings settings(m_folder.filePath(QString("positions_%1.ini").arg(count)), QSettings::IniFormat);
+    QStringList keys;
+    for (int i = 0; i < count; ++i) {
+        QString key = QString("videoPosition_%1").arg(VideoHash::compute(QString("/videos/%1").arg(episodeName(i))));
+        settings.setValue(key, qint64(i) * 1000 + 30001);
+        if (i % (count / 1000) == 0) {
+            keys << key;
+        }
+    }
+    settings.sync();
+
+    QBENCHMARK {
+        for (const QString &key : std::as_const(keys)) {
+            QVERIFY(settings.value(key, -1).toLongLong() > 0);
+        }
+    }
+}
+
+void PlaylistBenchmark::formatTime()
+{
+    QChar buffer[TimeTextCapacity];
+    int totalLength = 0;
+    QBENCHMARK {
+        for (qint64 ms = 0; ms < 100000000; ms += 997) {
+            totalLength += formatTimeTo(ms, buffer);
+        }
+    }
+    QVERIFY(totalLength > 0);
+}
+
+QTEST_GUILESS_MAIN(PlaylistBenchmark)
+
+#include "playlistbenchmark.moc"
@@ -0,0 +1,449 @@
+#include "duplicatefinder.h"
+#include "framesampler.h"
+#include "perceptualhash.h"
+#include "videoframeutils.h"
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThread>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QMap>
+#include <iterator>
+#include <numeric>
+
+namespace {
+
+constexpr quint32 CacheMagic = 0x50485348;   // "PHSH"
+constexpr quint32 CacheVersion = 1;
+constexpr int SaveInterval = 16;             // 每完成若干个视频保存一次缓存
+constexpr int MinCommonFrames = 3;
+constexpr qint64 MinDurationToleranceMs = 2000;
+constexpr int DownscaleFactor = 4;           // 先取4倍尺寸再按块平均，减少最近邻采样的噪声
+
+const qreal SampleFractions[DuplicateFinder::SamplesPerVideo] = {0.1, 0.3, 0.5, 0.7, 0.9};
+
+// 在线程池中计算一帧的感知哈希
+bool hashFrame(const QVideoFrame &frame, quint64 &hash)
+{
+    TraceScope scope("感知哈希");
+    constexpr int Size = PerceptualHash::InputSize;
+    constexpr int LargeSize = Size * DownscaleFactor;
+    
+    quint8 large[LargeSize * LargeSize];
+    if (!VideoFrameUtils::downscaleLuma(frame, large, LargeSize, LargeSize)) {
+        return false;
+    }
+    
+    quint8 luma[Size * Size];
+    for (int y = 0; y < Size; ++y) {
+        for (int x = 0; x < Size; ++x) {
+            int sum = 0;
+            for (int dy = 0; dy < DownscaleFactor; ++dy) {
+                const quint8 *row = large + (y * DownscaleFactor + dy) * LargeSize + x * DownscaleFactor;
+                for (int dx = 0; dx < DownscaleFactor; ++dx) {
+                    sum += row[dx];
+                }
+            }
+            luma[y * Size + x] = quint8(sum / (DownscaleFactor * DownscaleFactor));
+        }
+    }
+    hash = PerceptualHash::compute(luma);
+    return true;
+}
+
+// 以汉明距离为度量的BK树，用于查找距离不超过给定半径的哈希
+class BkTree
+{
+public:
+    void insert(quint64 hash, int value)
+    {
+        Node node;
+        node.hash = hash;
+        node.value = value;
+        if (m_nodes.isEmpty()) {
+            m_nodes.append(node);
+            return;
+        }
+        
+        int current = 0;
+        for (;;) {
+            int distance = PerceptualHash::distance(hash, m_nodes.at(current).hash);
+            auto child = m_nodes.at(current).children.constFind(distance);
+            if (child == m_nodes.at(current).children.constEnd()) {
+                m_nodes[current].children.insert(distance, m_nodes.size());
+                m_nodes.append(node);
+                return;
+            }
+            current = child.value();
+        }
+    }
+    
+    QList<int> search(quint64 hash, int radius) const
+    {
+        QList<int> results;
+        if (m_nodes.isEmpty()) {
+            return results;
+        }
+        
+        // 三角不等式：只有与当前节点距离在[d - r, d + r]内的子树可能命中
+        QList<int> stack = {0};
+        while (!stack.isEmpty()) {
+            const Node &node = m_nodes.at(stack.takeLast());
+            int distance = PerceptualHash::distance(hash, node.hash);
+            if (distance <= radius) {
+                results.append(node.value);
+            }
+            for (auto it = node.children.lowerBound(distance - radius);
+                 it != node.children.constEnd() && it.key() <= distance + radius; ++it) {
+                stack.append(it.value());
+            }
+        }
+        return results;
+    }
+
+private:
+    struct Node
+    {
+        quint64 hash = 0;
+        int value = -1;
+        QMap<int, int> children;   // 距离 -> 子节点下标
+    };
+    QList<Node> m_nodes;
+};
+
+bool isDuplicate(const VideoSignature &a, const VideoSignature &b)
+{
+    qint64 longer = qMax(a.durationMs, b.durationMs);
+    qint64 tolerance = qMax(MinDurationToleranceMs, longer / 50);
+    if (qAbs(a.durationMs - b.durationMs) > tolerance) {
+        return false;
+    }
+    
+    quint32 common = a.validMask & b.validMask;
+    int frames = 0;
+    int totalDistance = 0;
+    for (int i = 0; i < DuplicateFinder::SamplesPerVideo; ++i) {
+        if (common & (1u << i)) {
+            totalDistance += PerceptualHash::distance(a.hashes.at(i), b.hashes.at(i));
+            ++frames;
+        }
+    }
+    return frames >= MinCommonFrames && totalDistance <= DuplicateFinder::MaxAverageDistance * frames;
+}
+
+}
+
+DuplicateFinder::DuplicateFinder(const QString &cacheFile, QObject *parent)
+    : QObject(parent)
+    , m_cacheFile(cacheFile)
+    , m_cacheLoaded(false)
+    , m_cacheDirty(false)
+    , m_session(0)
+    , m_done(0)
+    , m_total(0)
+    , m_unsavedCount(0)
+{
+    // 每个抽帧器由后端多线程解码，并行的视频数量只需核数的一半
+    int samplerCount = qBound(2, QThread::idealThreadCount() / 2, 6);
+    for (int i = 0; i < samplerCount; ++i) {
+        FrameSampler *sampler = new FrameSampler(this);
+        connect(sampler, &FrameSampler::frameSampled, this, [this, sampler](int index, const QVideoFrame &frame) {
+            onFrameSampled(sampler, index, frame);
+        });
+        connect(sampler, &FrameSampler::finished, this, [this, sampler](bool ok, qint64 durationMs) {
+            onSamplerFinished(sampler, ok, durationMs);
+        });
+        m_samplers.append(sampler);
+    }
+    m_hashPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+DuplicateFinder::~DuplicateFinder()
+{
+    cancel();
+    m_hashPool.waitForDone();
+}
+
+void DuplicateFinder::start(const QStringList &videoPaths)
+{
+    cancel();
+    if (!m_cacheLoaded) {
+        loadCache();
+    }
+    
+    QSet<QString> seen;
+    for (const QString &path : videoPaths) {
+        QFileInfo info(path);
+        if (!info.isFile() || seen.contains(path)) {
+            continue;
+        }
+        seen.insert(path);
+        m_paths.append(path);
+        
+        // 文件未变化时直接使用缓存的指纹
+        auto cached = m_cache.constFind(path);
+        if (cached != m_cache.constEnd() && cached->size == info.size()
+            && cached->modified == info.lastModified().toMSecsSinceEpoch()) {
+            ++m_done;
+        } else {
+            m_queue.append(path);
+        }
+    }
+    
+    m_total = m_paths.size();
+    emit progress(m_done, m_total);
+    if (m_queue.isEmpty()) {
+        // 与正常完成一致，在事件循环中发出结果
+        quint64 session = m_session;
+        QMetaObject::invokeMethod(this, [this, session]() {
+            if (session == m_session) {
+                finishRun();
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+    dispatch();
+}
+
+void DuplicateFinder::cancel()
+{
+    // 递增会话号，线程池中尚未返回的哈希结果都会被丢弃
+    ++m_session;
+    for (FrameSampler *sampler : m_samplers) {
+        sampler->cancel();
+    }
+    m_paths.clear();
+    m_queue.clear();
+    m_inProgress.clear();
+    m_activePaths.clear();
+    m_pendingHashes.clear();
+    m_sampled.clear();
+    m_done = 0;
+    m_total = 0;
+    
+    // 已完成的指纹保留下来，下次查找时跳过
+    saveCache();
+}
+
+void DuplicateFinder::dispatch()
+{
+    QList<qreal> fractions(std::begin(SampleFractions), std::end(SampleFractions));
+    for (FrameSampler *sampler : m_samplers) {
+        if (m_queue.isEmpty()) {
+            break;
+        }
+        if (sampler->isBusy() || m_activePaths.contains(sampler)) {
+            continue;
+        }
+        
+        QString path = m_queue.takeFirst();
+        QFileInfo info(path);
+        VideoSignature signature;
+        signature.size = info.size();
+        signature.modified = info.lastModified().toMSecsSinceEpoch();
+        signature.hashes = QList<quint64>(SamplesPerVideo, 0);
+        m_inProgress.insert(path, signature);
+        m_pendingHashes.insert(path, 0);
+        m_activePaths.insert(sampler, path);
+        sampler->start(path, fractions);
+    }
+}
+
+void DuplicateFinder::onFrameSampled(FrameSampler *sampler, int index, const QVideoFrame &frame)
+{
+    QString path = m_activePaths.value(sampler);
+    if (path.isEmpty()) {
+        return;
+    }
+    ++m_pendingHashes[path];
+    
+    QPointer<DuplicateFinder> guard(this);
+    quint64 session = m_session;
+    m_hashPool.start([guard, session, path, index, frame]() {
+        quint64 hash = 0;
+        bool ok = hashFrame(frame, hash);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, session, path, index, ok, hash]() {
+            if (guard) {
+                guard->onHashComputed(session, path, ok ? index : -1, hash);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void DuplicateFinder::onSamplerFinished(FrameSampler *sampler, bool ok, qint64 durationMs)
+{
+    QString path = m_activePaths.take(sampler);
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // 无法打开的文件也记录下来（没有有效帧），避免每次都重新尝试
+    m_inProgress[path].durationMs = ok ? durationMs : 0;
+    m_sampled.insert(path);
+    completeIfDone(path);
+    dispatch();
+}
+
+void DuplicateFinder::onHashComputed(quint64 session, const QString &path, int index, quint64 hash)
+{
+    if (session != m_session || !m_pendingHashes.contains(path)) {
+        return;
+    }
+    --m_pendingHashes[path];
+    if (index >= 0) {
+        VideoSignature &signature = m_inProgress[path];
+        signature.hashes[index] = hash;
+        signature.validMask |= 1u << index;
+    }
+    completeIfDone(path);
+}
+
+void DuplicateFinder::completeIfDone(const QString &path)
+{
+    if (!m_sampled.contains(path) || m_pendingHashes.value(path) > 0) {
+        return;
+    }
+    m_sampled.remove(path);
+    m_pendingHashes.remove(path);
+    m_cache.insert(path, m_inProgress.take(path));
+    m_cacheDirty = true;
+    
+    ++m_done;
+    if (++m_unsavedCount >= SaveInterval) {
+        saveCache();
+    }
+    emit progress(m_done, m_total);
+    
+    if (m_done == m_total) {
+        finishRun();
+    }
+}
+
+void DuplicateFinder::finishRun()
+{
+    QList<QStringList> groups = groupDuplicates();
+    saveCache();
+    m_paths.clear();
+    m_done = 0;
+    m_total = 0;
+    emit finished(groups);
+}
+
+QList<QStringList> DuplicateFinder::groupDuplicates() const
+{
+    // 每个采样位置一棵树，只比较同一位置的帧：某个副本在某个位置取帧失败时，
+    // 仍能通过其他共同的位置找到它
+    QList<const VideoSignature *> signatures;
+    QStringList paths;
+    BkTree trees[SamplesPerVideo];
+    for (const QString &path : m_paths) {
+        auto it = m_cache.constFind(path);
+        if (it == m_cache.constEnd() || it->validMask == 0) {
+            continue;
+        }
+        for (int index = 0; index < SamplesPerVideo; ++index) {
+            if (it->validMask & (1u << index)) {
+                trees[index].insert(it->hashes.at(index), signatures.size());
+            }
+        }
+        signatures.append(&it.value());
+        paths.append(path);
+    }
+    
+    // 并查集合并所有确认重复的视频对
+    QList<int> parent(signatures.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    
+    for (int i = 0; i < signatures.size(); ++i) {
+        const VideoSignature &signature = *signatures.at(i);
+        // 各位置的帧距离放宽一倍作为候选，再用全部帧确认
+        for (int index = 0; index < SamplesPerVideo; ++index) {
+            if (!(signature.validMask & (1u << index))) {
+                continue;
+            }
+            const QList<int> candidates = trees[index].search(signature.hashes.at(index), MaxAverageDistance * 2);
+            for (int j : candidates) {
+                if (j > i && root(i) != root(j) && isDuplicate(signature, *signatures.at(j))) {
+                    parent[root(j)] = root(i);
+                }
+            }
+        }
+    }
+    
+    QMap<int, QStringList> members;
+    for (int i = 0; i < signatures.size(); ++i) {
+        members[root(i)].append(paths.at(i));
+    }
+    QList<QStringList> groups;
+    for (QStringList &group : members) {
+        if (group.size() > 1) {
+            group.sort();
+            groups.append(group);
+        }
+    }
+    return groups;
+}
+
+void DuplicateFinder::loadCache()
+{
+    m_cacheLoaded = true;
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion) {
+        return;
+    }
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        VideoSignature signature;
+        stream >> path >> signature.size >> signature.modified >> signature.durationMs
+               >> signature.validMask >> signature.hashes;
+        if (stream.status() == QDataStream::Ok && signature.hashes.size() == SamplesPerVideo) {
+            m_cache.insert(path, signature);
+        }
+    }
+}
+
+void DuplicateFinder::saveCache()
+{
+    m_unsavedCount = 0;
+    if (!m_cacheDirty) {
+        return;
+    }
+    
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << CacheMagic << CacheVersion << qint32(m_cache.size());
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        stream << it.key() << it->size << it->modified << it->durationMs
+               << it->validMask << it->hashes;
+    }
+    if (file.commit()) {
+        m_cacheDirty = false;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVideoFrame>
+
+class FrameSampler;
+
+// 视频的感知指纹：在固定相对位置抽取的若干帧的pHash
+struct VideoSignature
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    qint64 durationMs = 0;
+    QList<quint64> hashes;   // 与抽帧位置一一对应
+    quint32 validMask = 0;   // 第i位表示第i帧是否抽取成功
+};
+
+// 播放列表重复视频查找
+// 多个抽帧器并行解码不同的视频，抽出的帧在线程池中计算感知哈希；
+// 全部完成后用BK树按汉明距离查找相近的视频，合并为重复组。
+// 指纹按路径、大小和修改时间缓存到磁盘，中途取消后再次查找只处理剩余的视频。
+class DuplicateFinder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicateFinder(const QString &cacheFile, QObject *parent = nullptr);
+    ~DuplicateFinder() override;
+    
+    // 开始查找（会取消正在进行的查找），只处理本地文件
+    void start(const QStringList &videoPaths);
+    void cancel();
+    bool isRunning() const { return m_total > 0; }
+    
+    static constexpr int SamplesPerVideo = 5;
+    static constexpr int MaxAverageDistance = 10;   // 各帧平均汉明距离上限（共64位）
+
+signals:
+    void progress(int done, int total);
+    // 每组为同一视频的多个副本，按路径排序
+    void finished(const QList<QStringList> &groups);
+
+private:
+    void dispatch();
+    void onFrameSampled(FrameSampler *sampler, int index, const QVideoFrame &frame);
+    void onSamplerFinished(FrameSampler *sampler, bool ok, qint64 durationMs);
+    void onHashComputed(quint64 session, const QString &path, int index, quint64 hash);
+    void completeIfDone(const QString &path);
+    void finishRun();
+    QList<QStringList> groupDuplicates() const;
+    void loadCache();
+    void saveCache();
+    
+    QString m_cacheFile;
+    QHash<QString, VideoSignature> m_cache;
+    bool m_cacheLoaded;
+    bool m_cacheDirty;
+    
+    QList<FrameSampler *> m_samplers;
+    QThreadPool m_hashPool;
+    QStringList m_paths;
+    QStringList m_queue;
+    QHash<QString, VideoSignature> m_inProgress;
+    QHash<FrameSampler *, QString> m_activePaths;
+    QHash<QString, int> m_pendingHashes;
+    QSet<QString> m_sampled;
+    quint64 m_session;
+    int m_done;
+    int m_total;
+    int m_unsavedCount;
+};
+
+#endif // DUPLICATEFINDER_H
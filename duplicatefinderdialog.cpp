@@ -0,0 +1,127 @@
+#include "duplicatefinderdialog.h"
+#include <QFileInfo>
+#include <QLocale>
+
+DuplicateFinderDialog::DuplicateFinderDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_groupTree(nullptr)
+    , m_progressBar(nullptr)
+    , m_statusLabel(nullptr)
+    , m_startButton(nullptr)
+    , m_running(false)
+{
+    setupUI();
+    setupConnections();
+    
+    setWindowTitle("查找重复视频");
+    resize(600, 440);
+    setModal(false); // 非模态对话框，查找时可以继续播放
+}
+
+void DuplicateFinderDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    
+    m_groupTree = new QTreeWidget();
+    m_groupTree->setHeaderLabels({"文件", "大小"});
+    m_groupTree->setColumnWidth(0, 460);
+    m_groupTree->setUniformRowHeights(true);
+    m_groupTree->setStyleSheet("QTreeWidget { background-color: white; border: 1px solid #ccc; color: black; } QTreeWidget::item { padding: 3px; } QTreeWidget::item:selected { background-color: #0078d4; color: white; }");
+    
+    m_progressBar = new QProgressBar();
+    m_progressBar->setTextVisible(false);
+    m_progressBar->setFixedHeight(6);
+    m_progressBar->setStyleSheet("QProgressBar { border: none; background-color: #eee; border-radius: 3px; } QProgressBar::chunk { background-color: #0078d4; border-radius: 3px; }");
+    
+    m_statusLabel = new QLabel("对比播放列表中的本地视频画面，找出重复的文件");
+    m_statusLabel->setStyleSheet("color: #666; font-size: 12px;");
+    
+    m_startButton = new QPushButton("开始查找");
+    m_startButton->setStyleSheet("QPushButton { padding: 6px 16px; border: 1px solid #ccc; border-radius: 4px; background-color: white; color: black; } QPushButton:hover { background-color: #f0f0f0; }");
+    
+    QHBoxLayout *bottomLayout = new QHBoxLayout();
+    bottomLayout->addWidget(m_statusLabel, 1);
+    bottomLayout->addWidget(m_startButton);
+    
+    mainLayout->addWidget(m_groupTree, 1);
+    mainLayout->addWidget(m_progressBar);
+    mainLayout->addLayout(bottomLayout);
+    mainLayout->setContentsMargins(12, 12, 12, 12);
+    
+    setStyleSheet("QDialog { background-color: white; }");
+}
+
+void DuplicateFinderDialog::setupConnections()
+{
+    connect(m_startButton, &QPushButton::clicked, this, &DuplicateFinderDialog::onStartClicked);
+    connect(m_groupTree, &QTreeWidget::itemActivated, this, &DuplicateFinderDialog::onItemActivated);
+}
+
+void DuplicateFinderDialog::onStartClicked()
+{
+    if (m_running) {
+        setRunning(false);
+        m_statusLabel->setText("已取消，已处理的视频下次无需重新分析");
+        emit cancelRequested();
+    } else {
+        m_groupTree->clear();
+        setRunning(true);
+        emit startRequested();
+    }
+}
+
+void DuplicateFinderDialog::setRunning(bool running)
+{
+    m_running = running;
+    m_startButton->setText(running ? "取消" : "开始查找");
+    if (!running) {
+        m_progressBar->setRange(0, 1);
+        m_progressBar->setValue(0);
+    }
+}
+
+void DuplicateFinderDialog::setProgress(int done, int total)
+{
+    if (!m_running) {
+        return;
+    }
+    m_progressBar->setRange(0, qMax(1, total));
+    m_progressBar->setValue(done);
+    m_statusLabel->setText(QString("正在分析 %1/%2").arg(done).arg(total));
+}
+
+void DuplicateFinderDialog::setGroups(const QList<QStringList> &groups)
+{
+    setRunning(false);
+    
+    m_groupTree->setUpdatesEnabled(false);
+    m_groupTree->clear();
+    QLocale locale;
+    int fileCount = 0;
+    for (int i = 0; i < groups.size(); ++i) {
+        QTreeWidgetItem *groupItem = new QTreeWidgetItem(m_groupTree);
+        groupItem->setText(0, QString("第%1组（%2个）").arg(i + 1).arg(groups.at(i).size()));
+        groupItem->setFlags(Qt::ItemIsEnabled);
+        for (const QString &path : groups.at(i)) {
+            QTreeWidgetItem *fileItem = new QTreeWidgetItem(groupItem);
+            fileItem->setText(0, path);
+            fileItem->setText(1, locale.formattedDataSize(QFileInfo(path).size()));
+            fileItem->setData(0, Qt::UserRole, path);
+            fileItem->setToolTip(0, path);
+        }
+        fileCount += groups.at(i).size();
+    }
+    m_groupTree->expandAll();
+    m_groupTree->setUpdatesEnabled(true);
+    
+    m_statusLabel->setText(groups.isEmpty() ? QString("没有发现重复的视频")
+                                            : QString("发现 %1 组重复，共 %2 个文件").arg(groups.size()).arg(fileCount));
+}
+
+void DuplicateFinderDialog::onItemActivated(QTreeWidgetItem *item)
+{
+    QString path = item ? item->data(0, Qt::UserRole).toString() : QString();
+    if (!path.isEmpty()) {
+        emit fileActivated(path);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef DUPLICATEFINDERDIALOG_H
+#define DUPLICATEFINDERDIALOG_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+// 重复视频查找面板（非模态），按组列出重复的视频，双击播放
+class DuplicateFinderDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicateFinderDialog(QWidget *parent = nullptr);
+
+public slots:
+    void setProgress(int done, int total);
+    void setGroups(const QList<QStringList> &groups);
+
+signals:
+    void startRequested();
+    void cancelRequested();
+    void fileActivated(const QString &filePath);
+
+private slots:
+    void onStartClicked();
+    void onItemActivated(QTreeWidgetItem *item);
+
+private:
+    void setupUI();
+    void setupConnections();
+    void setRunning(bool running);
+    
+    QTreeWidget *m_groupTree;
+    QProgressBar *m_progressBar;
+    QLabel *m_statusLabel;
+    QPushButton *m_startButton;
+    bool m_running;
+};
+
+#endif // DUPLICATEFINDERDIALOG_H
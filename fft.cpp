@@ -0,0 +1,55 @@
+#include "fft.h"
+#include "simdkernels.h"
+#include <QtMath>
+#include <cmath>
+#include <utility>
+
+Fft::Fft(int size)
+    : m_size(size)
+    , m_bitReverse(size_t(size))
+{
+    int bits = 0;
+    while ((1 << bits) < size) {
+        ++bits;
+    }
+    for (int i = 0; i < size; ++i) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_bitReverse[size_t(i)] = reversed;
+    }
+    
+    m_twiddleRe.reserve(size_t(size));
+    m_twiddleIm.reserve(size_t(size));
+    for (int half = 1; half < size; half *= 2) {
+        for (int j = 0; j < half; ++j) {
+            double angle = -M_PI * j / half;
+            m_twiddleRe.push_back(float(std::cos(angle)));
+            m_twiddleIm.push_back(float(std::sin(angle)));
+        }
+    }
+}
+
+void Fft::transform(float *re, float *im) const
+{
+    for (int i = 0; i < m_size; ++i) {
+        int j = m_bitReverse[size_t(i)];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    
+    // 前两级每组只有1、2个蝶形，由内核的标量部分处理；之后每组都能按4个一批向量化
+    size_t twiddleOffset = 0;
+    for (int half = 1; half < m_size; half *= 2) {
+        const float *twiddleRe = m_twiddleRe.data() + twiddleOffset;
+        const float *twiddleIm = m_twiddleIm.data() + twiddleOffset;
+        for (int start = 0; start < m_size; start += 2 * half) {
+            SimdKernels::butterflyF32(re + start, im + start, re + start + half, im + start + half,
+                                      twiddleRe, twiddleIm, half);
+        }
+        twiddleOffset += size_t(half);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+// 基2复数FFT（原位计算，实部与虚部分开存储）
+// 位反转表和每一级的旋转因子在构造时算好，变换本身不分配内存；蝶形运算使用SimdKernels
+class Fft
+{
+public:
+    // size必须是2的幂
+    explicit Fft(int size);
+    
+    int size() const { return m_size; }
+    
+    // 正变换，re和im各size个元素，输入按自然顺序，输出按频率顺序
+    void transform(float *re, float *im) const;
+
+private:
+    int m_size;
+    std::vector<int> m_bitReverse;
+    // 各级依次存放，半长为h的一级占h个：exp(-2πi·j/2h)，j = 0 .. h-1
+    std::vector<float> m_twiddleRe;
+    std::vector<float> m_twiddleIm;
+};
+
+#endif // FFT_H
@@ -0,0 +1,156 @@
+#include "framecapture.h"
+#include <QVideoSink>
+#include <QImage>
+#include <QImageWriter>
+#include <QDir>
+#include <QFileInfo>
+#include <QPointer>
+#include <QThread>
+
+FrameCapture::FrameCapture(QObject *parent)
+    : QObject(parent)
+    , m_format("png")
+    , m_lastBurstFrameTime(-1)
+    , m_burstFrameCount(0)
+    , m_burstRemaining(0)
+    , m_burstPending(0)
+    , m_burstSaved(0)
+{
+    // 编码线程不宜过多，避免和解码争抢CPU导致丢帧
+    m_encodePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    
+    m_burstTimer.setSingleShot(true);
+    m_burstTimer.setInterval(BurstStallTimeoutMs);
+    connect(&m_burstTimer, &QTimer::timeout, this, &FrameCapture::cancelBurst);
+}
+
+FrameCapture::~FrameCapture()
+{
+    disconnect(m_burstConnection);
+    m_encodePool.waitForDone();
+}
+
+bool FrameCapture::snapshot(QVideoSink *sink, const QString &baseName)
+{
+    QVideoFrame frame = sink ? sink->videoFrame() : QVideoFrame();
+    if (!frame.isValid()) {
+        return false;
+    }
+    encode(frame, filePathFor(baseName, frame, -1), false);
+    return true;
+}
+
+void FrameCapture::startBurst(QVideoSink *sink, const QString &baseName, int frameCount)
+{
+    if (!sink || frameCount <= 0 || isBurstActive()) {
+        return;
+    }
+    m_burstBaseName = baseName;
+    m_burstFrameCount = frameCount;
+    m_burstRemaining = frameCount;
+    m_burstPending = 0;
+    m_burstSaved = 0;
+    m_lastBurstFrameTime = -1;
+    m_burstConnection = connect(sink, &QVideoSink::videoFrameChanged, this, &FrameCapture::onBurstFrame);
+    m_burstTimer.start();
+}
+
+void FrameCapture::cancelBurst()
+{
+    if (!isBurstActive()) {
+        return;
+    }
+    disconnect(m_burstConnection);
+    m_burstTimer.stop();
+    m_burstRemaining = 0;
+    // 仍在编码的帧完成后由onEncoded报告结果
+    if (m_burstPending == 0) {
+        emit burstFinished(m_burstSaved, m_burstFrameCount);
+    }
+}
+
+void FrameCapture::onBurstFrame(const QVideoFrame &frame)
+{
+    // 同一帧可能重复送达（如暂停后重绘），按时间戳去重
+    if (!frame.isValid() || frame.startTime() == m_lastBurstFrameTime) {
+        return;
+    }
+    m_lastBurstFrameTime = frame.startTime();
+    
+    int index = m_burstFrameCount - m_burstRemaining;
+    encode(frame, filePathFor(m_burstBaseName, frame, index), true);
+    ++m_burstPending;
+    if (--m_burstRemaining == 0) {
+        disconnect(m_burstConnection);
+        m_burstTimer.stop();
+    } else {
+        m_burstTimer.start();
+    }
+}
+
+void FrameCapture::encode(const QVideoFrame &frame, const QString &filePath, bool burst)
+{
+    QPointer<FrameCapture> guard(this);
+    m_encodePool.start([frame, filePath, burst, guard]() {
+        QImage image = frame.toImage();
+        bool ok = false;
+        if (!image.isNull()) {
+            QImageWriter writer(filePath);
+            if (filePath.endsWith(".jpg")) {
+                writer.setQuality(95);
+            } else {
+                // PNG以编码速度优先，文件稍大
+                writer.setCompression(1);
+            }
+            ok = writer.write(image);
+        }
+        QMetaObject::invokeMethod(guard.data(), [guard, filePath, ok, burst]() {
+            if (guard) {
+                guard->onEncoded(filePath, ok, burst);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FrameCapture::onEncoded(const QString &filePath, bool ok, bool burst)
+{
+    if (ok) {
+        emit saved(filePath);
+    } else {
+        emit failed(filePath);
+    }
+    
+    if (burst) {
+        --m_burstPending;
+        if (ok) {
+            ++m_burstSaved;
+        }
+        if (m_burstRemaining == 0 && m_burstPending == 0) {
+            emit burstFinished(m_burstSaved, m_burstFrameCount);
+        }
+    }
+}
+
+QString FrameCapture::filePathFor(const QString &baseName, const QVideoFrame &frame, int burstIndex) const
+{
+    QDir().mkpath(m_outputDirectory);
+    
+    // 文件名包含帧的时间戳，格式 名称_时-分-秒.毫秒[_序号]
+    qint64 ms = qMax<qint64>(0, frame.startTime() / 1000);
+    QString timestamp = QString("%1-%2-%3.%4")
+                            .arg(ms / 3600000, 2, 10, QChar('0'))
+                            .arg((ms / 60000) % 60, 2, 10, QChar('0'))
+                            .arg((ms / 1000) % 60, 2, 10, QChar('0'))
+                            .arg(ms % 1000, 3, 10, QChar('0'));
+    QString name = QString("%1_%2").arg(baseName, timestamp);
+    if (burstIndex >= 0) {
+        name += QString("_%1").arg(burstIndex + 1, 2, 10, QChar('0'));
+    }
+    
+    QDir dir(m_outputDirectory);
+    QString filePath = dir.filePath(name + "." + m_format);
+    for (int suffix = 2; QFileInfo::exists(filePath); ++suffix) {
+        filePath = dir.filePath(QString("%1 (%2).%3").arg(name).arg(suffix).arg(m_format));
+    }
+    return filePath;
+}
@@ -0,0 +1,65 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVideoFrame>
+
+class QVideoSink;
+
+// 截图和连拍
+// GUI线程只复制QVideoFrame（引用计数，不复制像素），颜色转换和PNG/JPEG编码
+// 在独立的线程池中完成，连拍期间不会阻塞界面或造成丢帧。
+class FrameCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameCapture(QObject *parent = nullptr);
+    ~FrameCapture() override;
+    
+    void setOutputDirectory(const QString &directory) { m_outputDirectory = directory; }
+    QString outputDirectory() const { return m_outputDirectory; }
+    // "png" 或 "jpg"
+    void setFormat(const QString &format) { m_format = format; }
+    
+    // 保存视频输出当前显示的帧
+    bool snapshot(QVideoSink *sink, const QString &baseName);
+    
+    // 保存接下来的frameCount帧（需要正在播放）
+    void startBurst(QVideoSink *sink, const QString &baseName, int frameCount = DefaultBurstFrames);
+    bool isBurstActive() const { return m_burstRemaining > 0; }
+    // 提前结束连拍（暂停、停止或切换视频），已保存的帧照常报告
+    void cancelBurst();
+    
+    static constexpr int DefaultBurstFrames = 30;
+    // 连续这么久没有新帧时自动结束连拍
+    static constexpr int BurstStallTimeoutMs = 2000;
+
+signals:
+    void saved(const QString &filePath);
+    void failed(const QString &filePath);
+    void burstFinished(int savedCount, int frameCount);
+
+private:
+    void onBurstFrame(const QVideoFrame &frame);
+    void encode(const QVideoFrame &frame, const QString &filePath, bool burst);
+    void onEncoded(const QString &filePath, bool ok, bool burst);
+    QString filePathFor(const QString &baseName, const QVideoFrame &frame, int burstIndex) const;
+    
+    QThreadPool m_encodePool;
+    QString m_outputDirectory;
+    QString m_format;
+    
+    QMetaObject::Connection m_burstConnection;
+    QTimer m_burstTimer;
+    QString m_burstBaseName;
+    qint64 m_lastBurstFrameTime;
+    int m_burstFrameCount;
+    int m_burstRemaining;
+    int m_burstPending;
+    int m_burstSaved;
+};
+
+#endif // FRAMECAPTURE_H
@@ -0,0 +1,131 @@
+#include "framesampler.h"
+#include <QVideoSink>
+#include <QTimer>
+#include <QUrl>
+
+namespace {
+
+// 后端可能定位到目标之前的关键帧，允许的偏差
+constexpr qint64 SeekToleranceMs = 5000;
+
+}
+
+FrameSampler::FrameSampler(QObject *parent)
+    : QObject(parent)
+    , m_player(nullptr)
+    , m_videoSink(nullptr)
+    , m_timeoutTimer(nullptr)
+    , m_index(-1)
+    , m_duration(0)
+    , m_targetPosition(0)
+    , m_awaitingFrame(false)
+{
+    m_player = new QMediaPlayer(this);
+    m_videoSink = new QVideoSink(this);
+    m_player->setVideoSink(m_videoSink);
+    
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setSingleShot(true);
+    
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &FrameSampler::onMediaStatusChanged);
+    connect(m_videoSink, &QVideoSink::videoFrameChanged, this, &FrameSampler::onVideoFrameChanged);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &FrameSampler::onTimeout);
+}
+
+void FrameSampler::start(const QString &filePath, const QList<qreal> &fractions)
+{
+    cancel();
+    
+    m_filePath = filePath;
+    m_fractions = fractions;
+    m_index = -1;
+    m_duration = 0;
+    m_awaitingFrame = false;
+    m_player->setSource(QUrl::fromLocalFile(filePath));
+    m_timeoutTimer->start(LoadTimeoutMs);
+}
+
+void FrameSampler::cancel()
+{
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+    m_filePath.clear();
+    m_awaitingFrame = false;
+    m_timeoutTimer->stop();
+    m_player->stop();
+    m_player->setSource(QUrl());
+}
+
+void FrameSampler::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+    
+    if (status == QMediaPlayer::LoadedMedia && m_index < 0) {
+        m_duration = qMax<qint64>(0, m_player->duration());
+        // 暂停状态下定位也会解码并输出目标位置的一帧
+        m_player->pause();
+        requestNext();
+    } else if (status == QMediaPlayer::InvalidMedia) {
+        finish(false);
+    }
+}
+
+void FrameSampler::onVideoFrameChanged(const QVideoFrame &frame)
+{
+    if (!m_awaitingFrame || !frame.isValid()) {
+        return;
+    }
+    
+    // 进入暂停状态时输出的首帧可能晚于定位请求到达，按时间戳过滤
+    if (frame.startTime() >= 0 && qAbs(frame.startTime() / 1000 - m_targetPosition) > SeekToleranceMs) {
+        return;
+    }
+    
+    m_awaitingFrame = false;
+    m_timeoutTimer->stop();
+    emit frameSampled(m_index, frame);
+    
+    // 接收方可能在信号中取消，下一次定位放到事件循环中进行
+    QTimer::singleShot(0, this, [this]() {
+        if (!m_filePath.isEmpty() && !m_awaitingFrame) {
+            requestNext();
+        }
+    });
+}
+
+void FrameSampler::onTimeout()
+{
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+    if (m_index < 0) {
+        finish(false);
+    } else {
+        m_awaitingFrame = false;
+        requestNext();
+    }
+}
+
+void FrameSampler::requestNext()
+{
+    ++m_index;
+    if (m_index >= m_fractions.size()) {
+        finish(true);
+        return;
+    }
+    
+    m_targetPosition = qint64(qBound<qreal>(0.0, m_fractions.at(m_index), 1.0) * m_duration);
+    m_awaitingFrame = true;
+    m_player->setPosition(m_targetPosition);
+    m_timeoutTimer->start(SeekTimeoutMs);
+}
+
+void FrameSampler::finish(bool ok)
+{
+    qint64 duration = m_duration;
+    cancel();
+    emit finished(ok, duration);
+}
@@ -0,0 +1,55 @@
+#ifndef FRAMESAMPLER_H
+#define FRAMESAMPLER_H
+
+#include <QObject>
+#include <QList>
+#include <QMediaPlayer>
+#include <QVideoFrame>
+
+class QVideoSink;
+class QTimer;
+
+// 从视频中按相对位置抽取若干帧
+// 用一个静音、暂停状态的播放器依次定位到各个位置，每次定位后取解码出的第一帧。
+// 定位超时的位置会被跳过；加载失败时finished的ok为false。
+class FrameSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameSampler(QObject *parent = nullptr);
+    
+    // fractions为相对位置（0.0 - 1.0），会取消正在进行的抽帧
+    void start(const QString &filePath, const QList<qreal> &fractions);
+    void cancel();
+    bool isBusy() const { return !m_filePath.isEmpty(); }
+    QString filePath() const { return m_filePath; }
+    
+    static constexpr int LoadTimeoutMs = 10000;
+    static constexpr int SeekTimeoutMs = 3000;
+
+signals:
+    void frameSampled(int index, const QVideoFrame &frame);
+    void finished(bool ok, qint64 durationMs);
+
+private slots:
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onVideoFrameChanged(const QVideoFrame &frame);
+    void onTimeout();
+
+private:
+    void requestNext();
+    void finish(bool ok);
+    
+    QMediaPlayer *m_player;
+    QVideoSink *m_videoSink;
+    QTimer *m_timeoutTimer;
+    QString m_filePath;
+    QList<qreal> m_fractions;
+    int m_index;
+    qint64 m_duration;
+    qint64 m_targetPosition;
+    bool m_awaitingFrame;
+};
+
+#endif // FRAMESAMPLER_H
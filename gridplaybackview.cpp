@@ -0,0 +1,255 @@
+#include "gridplaybackview.h"
+#include <QGridLayout>
+#include <QThreadPool>
+#include <QThread>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QPainter>
+#include <QPointer>
+#include <QMouseEvent>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QUrl>
+#include <cmath>
+
+namespace {
+
+constexpr qint64 SyncCheckIntervalMs = 2000;
+constexpr qint64 MaxDriftMs = 300;
+
+}
+
+// 单个格子：播放器 + 视频接收器，绘制缩小后的最新帧
+class GridTile : public QWidget
+{
+public:
+    GridTile(const QString &filePath, QWidget *parent)
+        : QWidget(parent)
+        , m_filePath(filePath)
+        , m_player(new QMediaPlayer(this))
+        , m_videoSink(new QVideoSink(this))
+        , m_converting(false)
+    {
+        setAttribute(Qt::WA_OpaquePaintEvent);
+        setMinimumSize(80, 45);
+        setToolTip(QFileInfo(filePath).fileName());
+        
+        m_player->setVideoSink(m_videoSink);
+        m_player->setSource(QUrl::fromLocalFile(filePath));
+        QObject::connect(m_videoSink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame) {
+            onFrame(frame);
+        });
+    }
+    
+    QMediaPlayer *player() const { return m_player; }
+    QString filePath() const { return m_filePath; }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::black);
+        if (!m_image.isNull()) {
+            QSize imageSize = m_image.deviceIndependentSize().toSize();
+            QRect target(QPoint(0, 0), imageSize.scaled(size(), Qt::KeepAspectRatio));
+            target.moveCenter(rect().center());
+            painter.drawImage(target, m_image);
+        }
+    }
+    
+    void mouseDoubleClickEvent(QMouseEvent *event) override
+    {
+        if (event->button() == Qt::LeftButton) {
+            if (GridPlaybackView *view = qobject_cast<GridPlaybackView *>(parentWidget())) {
+                emit view->tileActivated(m_filePath);
+            }
+        }
+        QWidget::mouseDoubleClickEvent(event);
+    }
+
+private:
+    void onFrame(const QVideoFrame &frame)
+    {
+        if (!frame.isValid()) {
+            return;
+        }
+        if (m_converting) {
+            // 上一帧还在转换，只保留最新一帧，其余丢弃
+            m_pendingFrame = frame;
+            return;
+        }
+        submit(frame);
+    }
+    
+    void submit(const QVideoFrame &frame)
+    {
+        m_converting = true;
+        qreal ratio = devicePixelRatioF();
+        QSize targetSize = (QSizeF(size()) * ratio).toSize();
+        QPointer<GridTile> guard(this);
+        
+        GridPlaybackView::framePool()->start([frame, targetSize, ratio, guard]() {
+            QImage image = frame.toImage();
+            if (!image.isNull() && targetSize.isValid()
+                && (image.width() > targetSize.width() || image.height() > targetSize.height())) {
+                image = image.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+            image.setDevicePixelRatio(ratio);
+            
+            // 回到GUI线程交付结果，格子已销毁时直接丢弃
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, image]() {
+                if (guard) {
+                    guard->onConverted(image);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+    
+    void onConverted(const QImage &image)
+    {
+        m_converting = false;
+        if (!image.isNull()) {
+            m_image = image;
+            update();
+        }
+        if (m_pendingFrame.isValid()) {
+            QVideoFrame frame = m_pendingFrame;
+            m_pendingFrame = QVideoFrame();
+            submit(frame);
+        }
+    }
+    
+    QString m_filePath;
+    QMediaPlayer *m_player;
+    QVideoSink *m_videoSink;
+    bool m_converting;
+    QVideoFrame m_pendingFrame;
+    QImage m_image;
+};
+
+GridPlaybackView::GridPlaybackView(QWidget *parent)
+    : QWidget(parent)
+    , m_layout(nullptr)
+    , m_lastSyncCheck(0)
+{
+    setStyleSheet("background-color: black;");
+    m_layout = new QGridLayout(this);
+    m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->setSpacing(2);
+}
+
+GridPlaybackView::~GridPlaybackView()
+{
+    clear();
+}
+
+QThreadPool *GridPlaybackView::framePool()
+{
+    // 所有格子共用，线程数不超过核心数，九宫格也不会超额占用CPU
+    static QThreadPool *pool = []() {
+        QThreadPool *threadPool = new QThreadPool(QCoreApplication::instance());
+        threadPool->setMaxThreadCount(qMax(2, QThread::idealThreadCount() - 1));
+        return threadPool;
+    }();
+    return pool;
+}
+
+void GridPlaybackView::setSources(const QStringList &filePaths)
+{
+    clear();
+    
+    int count = qMin(int(filePaths.size()), int(MaxTiles));
+    int columns = int(std::ceil(std::sqrt(double(count))));
+    for (int i = 0; i < count; ++i) {
+        GridTile *tile = new GridTile(filePaths.at(i), this);
+        m_layout->addWidget(tile, i / columns, i % columns);
+        m_tiles.append(tile);
+    }
+    
+    if (!m_tiles.isEmpty()) {
+        QMediaPlayer *master = m_tiles.first()->player();
+        connect(master, &QMediaPlayer::positionChanged, this, &GridPlaybackView::onMasterPositionChanged);
+        connect(master, &QMediaPlayer::durationChanged, this, &GridPlaybackView::durationChanged);
+        connect(master, &QMediaPlayer::playbackStateChanged, this, &GridPlaybackView::playbackStateChanged);
+    }
+}
+
+void GridPlaybackView::clear()
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->stop();
+        delete tile;
+    }
+    m_tiles.clear();
+    m_lastSyncCheck = 0;
+}
+
+void GridPlaybackView::play()
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->play();
+    }
+}
+
+void GridPlaybackView::pause()
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->pause();
+    }
+}
+
+void GridPlaybackView::stop()
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->stop();
+    }
+}
+
+void GridPlaybackView::setPosition(qint64 position)
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->setPosition(position);
+    }
+}
+
+void GridPlaybackView::setPlaybackRate(qreal rate)
+{
+    for (GridTile *tile : std::as_const(m_tiles)) {
+        tile->player()->setPlaybackRate(rate);
+    }
+}
+
+QMediaPlayer::PlaybackState GridPlaybackView::playbackState() const
+{
+    return m_tiles.isEmpty() ? QMediaPlayer::StoppedState : m_tiles.first()->player()->playbackState();
+}
+
+qint64 GridPlaybackView::position() const
+{
+    return m_tiles.isEmpty() ? 0 : m_tiles.first()->player()->position();
+}
+
+qint64 GridPlaybackView::duration() const
+{
+    return m_tiles.isEmpty() ? 0 : m_tiles.first()->player()->duration();
+}
+
+void GridPlaybackView::onMasterPositionChanged(qint64 position)
+{
+    emit positionChanged(position);
+    
+    // 定期把偏差过大的格子拉回基准位置（较短的视频播完后不再调整）
+    if (qAbs(position - m_lastSyncCheck) < SyncCheckIntervalMs) {
+        return;
+    }
+    m_lastSyncCheck = position;
+    for (int i = 1; i < m_tiles.size(); ++i) {
+        QMediaPlayer *player = m_tiles.at(i)->player();
+        if (player->mediaStatus() == QMediaPlayer::EndOfMedia || position >= player->duration()) {
+            continue;
+        }
+        if (qAbs(player->position() - position) > MaxDriftMs) {
+            player->setPosition(position);
+        }
+    }
+}
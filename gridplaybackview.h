@@ -0,0 +1,59 @@
+#ifndef GRIDPLAYBACKVIEW_H
+#define GRIDPLAYBACKVIEW_H
+
+#include <QWidget>
+#include <QList>
+#include <QStringList>
+#include <QMediaPlayer>
+
+class QGridLayout;
+class QThreadPool;
+class GridTile;
+
+// 宫格播放视图，同时播放2-16个视频
+// 每个格子一个静音播放器，解码出的帧在共享的有界线程池中转换并缩小到格子尺寸，
+// 格子正在转换时新到的帧只保留最新一帧，避免积压。
+// 播放控制统一作用于所有格子，以第一个格子为基准同步进度。
+class GridPlaybackView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GridPlaybackView(QWidget *parent = nullptr);
+    ~GridPlaybackView() override;
+    
+    void setSources(const QStringList &filePaths);
+    void clear();
+    int tileCount() const { return m_tiles.size(); }
+    
+    void play();
+    void pause();
+    void stop();
+    void setPosition(qint64 position);
+    void setPlaybackRate(qreal rate);
+    QMediaPlayer::PlaybackState playbackState() const;
+    qint64 position() const;
+    qint64 duration() const;
+    
+    // 帧转换共享的线程池
+    static QThreadPool *framePool();
+    
+    static constexpr int MinTiles = 2;
+    static constexpr int MaxTiles = 16;
+
+signals:
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    void tileActivated(const QString &filePath);
+
+private slots:
+    void onMasterPositionChanged(qint64 position);
+
+private:
+    QGridLayout *m_layout;
+    QList<GridTile *> m_tiles;
+    qint64 m_lastSyncCheck;
+};
+
+#endif // GRIDPLAYBACKVIEW_H
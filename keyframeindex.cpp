@@ -0,0 +1,816 @@
+#include "keyframeindex.h"
+#include "tracer.h"
+#include <QThread>
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 IndexMagic = 0x4B455946;   // "KEYF"
+constexpr quint32 IndexVersion = 1;
+constexpr qint64 MaxMetadataBytes = 64 * 1024 * 1024;   // moov、Cues读入内存的上限
+constexpr int TsChunkPackets = 4096;
+
+inline quint32 fourcc(const char *text)
+{
+    return (quint32(quint8(text[0])) << 24) | (quint32(quint8(text[1])) << 16)
+           | (quint32(quint8(text[2])) << 8) | quint32(quint8(text[3]));
+}
+
+inline quint64 readBigEndian(const uchar *data, int bytes)
+{
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+// 时间向上取整到毫秒：跳转目标落在关键帧之前哪怕一点，后端也会退回上一个关键帧
+inline qint64 ceilToMs(qint64 ticks, qint64 timescale)
+{
+    if (ticks <= 0) {
+        return 0;
+    }
+    return (ticks * 1000 + timescale - 1) / timescale;
+}
+
+QByteArray readAt(QFile &file, qint64 position, qint64 size)
+{
+    if (!file.seek(position)) {
+        return QByteArray();
+    }
+    return file.read(size);
+}
+
+// ---- MP4 / MOV ----
+
+// 依次回调父box中的每个子box：type、内容起点、内容长度
+template<typename Callback>
+void forEachBox(const uchar *data, qint64 size, Callback callback)
+{
+    qint64 offset = 0;
+    while (offset + 8 <= size) {
+        qint64 boxSize = qint64(readBigEndian(data + offset, 4));
+        quint32 type = quint32(readBigEndian(data + offset + 4, 4));
+        int headerSize = 8;
+        if (boxSize == 1) {
+            if (offset + 16 > size) {
+                return;
+            }
+            boxSize = qint64(readBigEndian(data + offset + 8, 8));
+            headerSize = 16;
+        } else if (boxSize == 0) {
+            boxSize = size - offset;
+        }
+        if (boxSize < headerSize || boxSize > size - offset) {
+            return;
+        }
+        if (!callback(type, data + offset + headerSize, boxSize - headerSize)) {
+            return;
+        }
+        offset += boxSize;
+    }
+}
+
+struct Mp4Track
+{
+    bool isVideo = false;
+    qint64 timescale = 0;
+    qint64 editShift = 0;   // 编辑列表中第一段的起始媒体时间
+    QByteArray stss;
+    QByteArray stts;
+    QByteArray ctts;
+};
+
+void parseSampleTable(const uchar *data, qint64 size, Mp4Track &track)
+{
+    forEachBox(data, size, [&](quint32 type, const uchar *payload, qint64 payloadSize) {
+        QByteArray box(reinterpret_cast<const char *>(payload), int(payloadSize));
+        if (type == fourcc("stss")) {
+            track.stss = box;
+        } else if (type == fourcc("stts")) {
+            track.stts = box;
+        } else if (type == fourcc("ctts")) {
+            track.ctts = box;
+        }
+        return true;
+    });
+}
+
+void parseMedia(const uchar *data, qint64 size, Mp4Track &track)
+{
+    forEachBox(data, size, [&](quint32 type, const uchar *payload, qint64 payloadSize) {
+        if (type == fourcc("mdhd") && payloadSize >= 24) {
+            // version 1的创建、修改时间是64位
+            int timescaleOffset = payload[0] == 1 ? 20 : 12;
+            if (payloadSize >= timescaleOffset + 4) {
+                track.timescale = qint64(readBigEndian(payload + timescaleOffset, 4));
+            }
+        } else if (type == fourcc("hdlr") && payloadSize >= 12) {
+            track.isVideo = readBigEndian(payload + 8, 4) == fourcc("vide");
+        } else if (type == fourcc("minf")) {
+            forEachBox(payload, payloadSize, [&](quint32 childType, const uchar *child, qint64 childSize) {
+                if (childType == fourcc("stbl")) {
+                    parseSampleTable(child, childSize, track);
+                }
+                return true;
+            });
+        }
+        return true;
+    });
+}
+
+void parseEditList(const uchar *data, qint64 size, Mp4Track &track)
+{
+    forEachBox(data, size, [&](quint32 type, const uchar *payload, qint64 payloadSize) {
+        if (type != fourcc("elst") || payloadSize < 8) {
+            return true;
+        }
+        bool wide = payload[0] == 1;
+        int entrySize = wide ? 20 : 12;
+        qint64 count = qint64(readBigEndian(payload + 4, 4));
+        for (qint64 i = 0; i < count && 8 + (i + 1) * entrySize <= payloadSize; ++i) {
+            const uchar *entry = payload + 8 + i * entrySize;
+            qint64 mediaTime = wide ? qint64(readBigEndian(entry + 8, 8)) : qint32(readBigEndian(entry + 4, 4));
+            // -1 是开头的空白段，跳过
+            if (mediaTime >= 0) {
+                track.editShift = mediaTime;
+                break;
+            }
+        }
+        return false;
+    });
+}
+
+QList<qint64> mp4Keyframes(const Mp4Track &track)
+{
+    QList<qint64> keyframes;
+    const uchar *stss = reinterpret_cast<const uchar *>(track.stss.constData());
+    const uchar *stts = reinterpret_cast<const uchar *>(track.stts.constData());
+    const uchar *ctts = reinterpret_cast<const uchar *>(track.ctts.constData());
+    if (track.timescale <= 0 || track.stss.size() < 8 || track.stts.size() < 8) {
+        return keyframes;
+    }
+    qint64 syncCount = qMin(qint64(readBigEndian(stss + 4, 4)), qint64(track.stss.size() - 8) / 4);
+    qint64 timeRuns = qMin(qint64(readBigEndian(stts + 4, 4)), qint64(track.stts.size() - 8) / 8);
+    qint64 offsetRuns = track.ctts.size() >= 8
+                            ? qMin(qint64(readBigEndian(ctts + 4, 4)), qint64(track.ctts.size() - 8) / 8) : 0;
+
+    // 同步帧编号升序，两张表各用一个游标顺序前进
+    qint64 timeRun = 0;
+    qint64 timeRunFirst = 0;     // 当前段第一个样本的序号（从0开始）
+    qint64 timeRunStart = 0;     // 当前段第一个样本的解码时间
+    qint64 offsetRun = 0;
+    qint64 offsetRunFirst = 0;
+    keyframes.reserve(syncCount);
+    for (qint64 i = 0; i < syncCount; ++i) {
+        qint64 sample = qint64(readBigEndian(stss + 8 + i * 4, 4)) - 1;
+        if (sample < 0) {
+            continue;
+        }
+        while (timeRun < timeRuns) {
+            const uchar *run = stts + 8 + timeRun * 8;
+            qint64 count = qint64(readBigEndian(run, 4));
+            if (sample < timeRunFirst + count) {
+                break;
+            }
+            timeRunStart += count * qint64(readBigEndian(run + 4, 4));
+            timeRunFirst += count;
+            ++timeRun;
+        }
+        if (timeRun >= timeRuns) {
+            break;
+        }
+        qint64 decodeTime = timeRunStart + (sample - timeRunFirst) * qint64(readBigEndian(stts + 8 + timeRun * 8 + 4, 4));
+
+        qint64 compositionOffset = 0;
+        while (offsetRun < offsetRuns) {
+            qint64 count = qint64(readBigEndian(ctts + 8 + offsetRun * 8, 4));
+            if (sample < offsetRunFirst + count) {
+                // version 1的偏移是有符号数，version 0按有符号读取也兼容常见文件
+                compositionOffset = qint32(readBigEndian(ctts + 8 + offsetRun * 8 + 4, 4));
+                break;
+            }
+            offsetRunFirst += count;
+            ++offsetRun;
+        }
+        keyframes.append(ceilToMs(decodeTime + compositionOffset - track.editShift, track.timescale));
+    }
+    return keyframes;
+}
+
+QList<qint64> parseMp4(QFile &file, const std::function<bool()> &isAborted)
+{
+    // 顶层box中只读取moov，mdat等直接跳过
+    const qint64 fileSize = file.size();
+    qint64 position = 0;
+    QByteArray moov;
+    while (position + 8 <= fileSize && !isAborted()) {
+        QByteArray header = readAt(file, position, 16);
+        if (header.size() < 8) {
+            break;
+        }
+        const uchar *bytes = reinterpret_cast<const uchar *>(header.constData());
+        qint64 boxSize = qint64(readBigEndian(bytes, 4));
+        quint32 type = quint32(readBigEndian(bytes + 4, 4));
+        int headerSize = 8;
+        if (boxSize == 1 && header.size() >= 16) {
+            boxSize = qint64(readBigEndian(bytes + 8, 8));
+            headerSize = 16;
+        } else if (boxSize == 0) {
+            boxSize = fileSize - position;
+        }
+        if (boxSize < headerSize) {
+            break;
+        }
+        if (type == fourcc("moov")) {
+            if (boxSize - headerSize <= MaxMetadataBytes) {
+                moov = readAt(file, position + headerSize, boxSize - headerSize);
+            }
+            break;
+        }
+        position += boxSize;
+    }
+
+    QList<qint64> keyframes;
+    const uchar *data = reinterpret_cast<const uchar *>(moov.constData());
+    forEachBox(data, moov.size(), [&](quint32 type, const uchar *payload, qint64 payloadSize) {
+        if (type != fourcc("trak")) {
+            return true;
+        }
+        Mp4Track track;
+        forEachBox(payload, payloadSize, [&](quint32 childType, const uchar *child, qint64 childSize) {
+            if (childType == fourcc("mdia")) {
+                parseMedia(child, childSize, track);
+            } else if (childType == fourcc("edts")) {
+                parseEditList(child, childSize, track);
+            }
+            return true;
+        });
+        if (!track.isVideo) {
+            return true;
+        }
+        // 只取第一条视频轨；没有stss表示每一帧都是关键帧
+        keyframes = mp4Keyframes(track);
+        return false;
+    });
+    return keyframes;
+}
+
+// ---- Matroska / WebM ----
+
+constexpr quint32 EbmlHeaderId = 0x1A45DFA3;
+constexpr quint32 SegmentId = 0x18538067;
+constexpr quint32 SeekHeadId = 0x114D9B74;
+constexpr quint32 SeekId = 0x4DBB;
+constexpr quint32 SeekIdId = 0x53AB;
+constexpr quint32 SeekPositionId = 0x53AC;
+constexpr quint32 InfoId = 0x1549A966;
+constexpr quint32 TimestampScaleId = 0x2AD7B1;
+constexpr quint32 TracksId = 0x1654AE6B;
+constexpr quint32 TrackEntryId = 0xAE;
+constexpr quint32 TrackNumberId = 0xD7;
+constexpr quint32 TrackTypeId = 0x83;
+constexpr quint32 CuesId = 0x1C53BB6B;
+constexpr quint32 CuePointId = 0xBB;
+constexpr quint32 CueTimeId = 0xB3;
+constexpr quint32 CueTrackPositionsId = 0xB7;
+constexpr quint32 CueTrackId = 0xF7;
+constexpr quint32 ClusterId = 0x1F43B675;
+constexpr quint64 UnknownSize = ~quint64(0);
+
+// 读取EBML变长整数；ID保留长度标记位，长度去掉标记位，全1表示未知长度
+bool readVint(const uchar *&data, const uchar *end, quint64 &value, bool isId)
+{
+    if (data >= end || *data == 0) {
+        return false;
+    }
+    int length = 1;
+    while (!(*data & (0x80 >> (length - 1)))) {
+        ++length;
+    }
+    if (length > (isId ? 4 : 8) || end - data < length) {
+        return false;
+    }
+    value = isId ? *data : (*data & (0xFF >> length));
+    bool allOnes = value == quint64(0xFF >> length);
+    for (int i = 1; i < length; ++i) {
+        value = (value << 8) | data[i];
+        allOnes = allOnes && data[i] == 0xFF;
+    }
+    if (!isId && allOnes) {
+        value = UnknownSize;
+    }
+    data += length;
+    return true;
+}
+
+template<typename Callback>
+void forEachElement(const uchar *data, qint64 size, Callback callback)
+{
+    const uchar *end = data + size;
+    while (data < end) {
+        quint64 id = 0;
+        quint64 elementSize = 0;
+        if (!readVint(data, end, id, true) || !readVint(data, end, elementSize, false)
+            || elementSize > quint64(end - data)) {
+            return;
+        }
+        callback(quint32(id), data, qint64(elementSize));
+        data += elementSize;
+    }
+}
+
+// 从文件中读取一个元素头，返回头部长度，失败返回0
+int readElementHeader(QFile &file, qint64 position, quint32 &id, quint64 &size)
+{
+    QByteArray header = readAt(file, position, 12);
+    const uchar *begin = reinterpret_cast<const uchar *>(header.constData());
+    const uchar *data = begin;
+    quint64 elementId = 0;
+    if (!readVint(data, begin + header.size(), elementId, true)
+        || !readVint(data, begin + header.size(), size, false)) {
+        return 0;
+    }
+    id = quint32(elementId);
+    return int(data - begin);
+}
+
+QList<qint64> parseMatroska(QFile &file, const std::function<bool()> &isAborted)
+{
+    QList<qint64> keyframes;
+    const qint64 fileSize = file.size();
+    quint32 id = 0;
+    quint64 size = 0;
+    int headerSize = readElementHeader(file, 0, id, size);
+    if (!headerSize || id != EbmlHeaderId || size == UnknownSize) {
+        return keyframes;
+    }
+    qint64 position = headerSize + qint64(size);
+    headerSize = readElementHeader(file, position, id, size);
+    if (!headerSize || id != SegmentId) {
+        return keyframes;
+    }
+    const qint64 segmentStart = position + headerSize;
+    const qint64 segmentEnd = size == UnknownSize ? fileSize : qMin(fileSize, segmentStart + qint64(size));
+
+    qint64 timestampScale = 1000000;   // 纳秒
+    quint64 videoTrack = 0;
+    qint64 cuesPosition = -1;
+    bool jumpedToCues = false;
+    QList<QPair<qint64, quint64>> cues;   // 时间、轨道（0表示未标明）
+
+    position = segmentStart;
+    while (position < segmentEnd && !isAborted()) {
+        headerSize = readElementHeader(file, position, id, size);
+        if (!headerSize) {
+            break;
+        }
+        const qint64 payloadStart = position + headerSize;
+        const bool wanted = id == SeekHeadId || id == InfoId || id == TracksId || id == CuesId;
+        if (wanted && size != UnknownSize && qint64(size) <= MaxMetadataBytes) {
+            QByteArray payload = readAt(file, payloadStart, qint64(size));
+            const uchar *data = reinterpret_cast<const uchar *>(payload.constData());
+            if (id == SeekHeadId) {
+                forEachElement(data, payload.size(), [&](quint32 seekId, const uchar *seek, qint64 seekSize) {
+                    if (seekId != SeekId) {
+                        return;
+                    }
+                    quint32 target = 0;
+                    qint64 targetPosition = -1;
+                    forEachElement(seek, seekSize, [&](quint32 childId, const uchar *child, qint64 childSize) {
+                        if (childId == SeekIdId && childSize <= 4) {
+                            target = quint32(readBigEndian(child, int(childSize)));
+                        } else if (childId == SeekPositionId && childSize <= 8) {
+                            targetPosition = qint64(readBigEndian(child, int(childSize)));
+                        }
+                    });
+                    if (target == CuesId && targetPosition >= 0) {
+                        cuesPosition = segmentStart + targetPosition;
+                    }
+                });
+            } else if (id == InfoId) {
+                forEachElement(data, payload.size(), [&](quint32 childId, const uchar *child, qint64 childSize) {
+                    if (childId == TimestampScaleId && childSize <= 8) {
+                        timestampScale = qMax<qint64>(1, qint64(readBigEndian(child, int(childSize))));
+                    }
+                });
+            } else if (id == TracksId) {
+                forEachElement(data, payload.size(), [&](quint32 entryId, const uchar *entry, qint64 entrySize) {
+                    if (entryId != TrackEntryId || videoTrack) {
+                        return;
+                    }
+                    quint64 number = 0;
+                    quint64 type = 0;
+                    forEachElement(entry, entrySize, [&](quint32 childId, const uchar *child, qint64 childSize) {
+                        if (childId == TrackNumberId && childSize <= 8) {
+                            number = readBigEndian(child, int(childSize));
+                        } else if (childId == TrackTypeId && childSize <= 8) {
+                            type = readBigEndian(child, int(childSize));
+                        }
+                    });
+                    if (type == 1) {
+                        videoTrack = number;
+                    }
+                });
+            } else {
+                forEachElement(data, payload.size(), [&](quint32 pointId, const uchar *point, qint64 pointSize) {
+                    if (pointId != CuePointId) {
+                        return;
+                    }
+                    qint64 time = -1;
+                    QList<quint64> tracks;
+                    forEachElement(point, pointSize, [&](quint32 childId, const uchar *child, qint64 childSize) {
+                        if (childId == CueTimeId && childSize <= 8) {
+                            time = qint64(readBigEndian(child, int(childSize)));
+                        } else if (childId == CueTrackPositionsId) {
+                            forEachElement(child, childSize, [&](quint32 positionId, const uchar *value, qint64 valueSize) {
+                                if (positionId == CueTrackId && valueSize <= 8) {
+                                    tracks.append(readBigEndian(value, int(valueSize)));
+                                }
+                            });
+                        }
+                    });
+                    if (time < 0) {
+                        return;
+                    }
+                    if (tracks.isEmpty()) {
+                        tracks.append(0);
+                    }
+                    for (quint64 track : std::as_const(tracks)) {
+                        cues.append({time, track});
+                    }
+                });
+                break;
+            }
+        }
+
+        // Cues通常在文件末尾，遇到第一个Cluster时按SeekHead直接跳过去
+        if (id == ClusterId && cuesPosition > position && !jumpedToCues) {
+            jumpedToCues = true;
+            position = cuesPosition;
+            continue;
+        }
+        if (size == UnknownSize) {
+            break;
+        }
+        position = payloadStart + qint64(size);
+    }
+
+    for (const auto &cue : std::as_const(cues)) {
+        if (cue.second == 0 || videoTrack == 0 || cue.second == videoTrack) {
+            // CueTime的单位是TimestampScale纳秒
+            keyframes.append(ceilToMs(cue.first * timestampScale, 1000000000));
+        }
+    }
+    return keyframes;
+}
+
+// ---- MPEG-TS / M2TS ----
+
+bool isVideoStreamType(int streamType)
+{
+    switch (streamType) {
+    case 0x01:   // MPEG-1
+    case 0x02:   // MPEG-2
+    case 0x10:   // MPEG-4 Part 2
+    case 0x1B:   // H.264
+    case 0x24:   // HEVC
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 在本包的视频数据中查找关键帧的标志：H.264的IDR/SPS，HEVC的IRAP/VPS/SPS，MPEG-1/2/4的序列头或GOP头
+bool containsKeyframeStart(const uchar *data, int size, int streamType)
+{
+    for (int i = 0; i + 3 < size; ++i) {
+        if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+            continue;
+        }
+        const uchar code = data[i + 3];
+        switch (streamType) {
+        case 0x1B: {
+            int nalType = code & 0x1F;
+            if (nalType == 5 || nalType == 7) {
+                return true;
+            }
+            break;
+        }
+        case 0x24: {
+            int nalType = (code >> 1) & 0x3F;
+            if ((nalType >= 16 && nalType <= 21) || nalType == 32 || nalType == 33) {
+                return true;
+            }
+            break;
+        }
+        default:
+            if (code == 0xB3 || code == 0xB8 || code == 0xB0) {
+                return true;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+QList<qint64> parseTransportStream(QFile &file, int packetSize, const std::function<bool()> &isAborted)
+{
+    const int prefix = packetSize - 188;   // M2TS每包前有4字节时间码
+    int pmtPid = -1;
+    int videoPid = -1;
+    int videoStreamType = 0;
+    QSet<int> elementaryPids;
+    QHash<int, qint64> firstPts;          // 各流第一个PTS，播放器以其中最早的为起点
+    QList<qint64> keyframePts;
+    qint64 lastVideoPts = -1;
+    qint64 wrapOffset = 0;
+
+    if (!file.seek(0)) {
+        return {};
+    }
+    QByteArray chunk;
+    while (!isAborted()) {
+        chunk = file.read(qint64(packetSize) * TsChunkPackets);
+        if (chunk.size() < packetSize) {
+            break;
+        }
+        const uchar *bytes = reinterpret_cast<const uchar *>(chunk.constData());
+        for (int offset = 0; offset + packetSize <= chunk.size(); offset += packetSize) {
+            const uchar *packet = bytes + offset + prefix;
+            if (packet[0] != 0x47) {
+                continue;
+            }
+            const int pid = ((packet[1] & 0x1F) << 8) | packet[2];
+            const bool unitStart = packet[1] & 0x40;
+            const int adaptation = (packet[3] >> 4) & 0x3;
+            int payload = 4;
+            bool randomAccess = false;
+            if (adaptation & 0x2) {
+                int length = packet[4];
+                randomAccess = length > 0 && (packet[5] & 0x40);
+                payload = 5 + length;
+            }
+            if (!(adaptation & 0x1) || payload >= 188 || !unitStart) {
+                continue;
+            }
+            const uchar *data = packet + payload;
+            const int size = 188 - payload;
+
+            if (pid == 0 || pid == pmtPid) {
+                // PSI表：指针字段之后是表头
+                int table = 1 + data[0];
+                if (table + 12 > size) {
+                    continue;
+                }
+                const uchar *section = data + table;
+                int sectionEnd = qMin(size - table, 3 + (((section[1] & 0x0F) << 8) | section[2]) - 4);
+                if (pid == 0 && section[0] == 0x00) {
+                    for (int i = 8; i + 4 <= sectionEnd; i += 4) {
+                        int program = (section[i] << 8) | section[i + 1];
+                        if (program != 0) {
+                            pmtPid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+                            break;
+                        }
+                    }
+                } else if (pid == pmtPid && section[0] == 0x02 && videoPid < 0) {
+                    int i = 12 + (((section[10] & 0x0F) << 8) | section[11]);
+                    for (; i + 5 <= sectionEnd; i += 5 + (((section[i + 3] & 0x0F) << 8) | section[i + 4])) {
+                        int streamType = section[i];
+                        int elementaryPid = ((section[i + 1] & 0x1F) << 8) | section[i + 2];
+                        elementaryPids.insert(elementaryPid);
+                        if (videoPid < 0 && isVideoStreamType(streamType)) {
+                            videoPid = elementaryPid;
+                            videoStreamType = streamType;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            if (!elementaryPids.contains(pid) || size < 14 || data[0] != 0 || data[1] != 0 || data[2] != 1) {
+                continue;
+            }
+            // PES头：标志位中有PTS时读取
+            if (!(data[7] & 0x80)) {
+                continue;
+            }
+            const uchar *p = data + 9;
+            qint64 pts = (qint64(p[0] >> 1) & 0x07) << 30 | qint64(p[1]) << 22 | qint64(p[2] >> 1) << 15
+                         | qint64(p[3]) << 7 | qint64(p[4] >> 1);
+            if (!firstPts.contains(pid)) {
+                firstPts.insert(pid, pts);
+            }
+            if (pid != videoPid) {
+                continue;
+            }
+            // 33位PTS回绕后继续递增
+            if (lastVideoPts >= 0 && pts + wrapOffset < lastVideoPts - (qint64(1) << 32)) {
+                wrapOffset += qint64(1) << 33;
+            }
+            pts += wrapOffset;
+            lastVideoPts = pts;
+
+            int headerEnd = 9 + data[8];
+            if (randomAccess || (headerEnd < size && containsKeyframeStart(data + headerEnd, size - headerEnd, videoStreamType))) {
+                keyframePts.append(pts);
+            }
+        }
+    }
+
+    QList<qint64> keyframes;
+    if (keyframePts.isEmpty() || isAborted()) {
+        return keyframes;
+    }
+    qint64 start = *std::min_element(firstPts.cbegin(), firstPts.cend());
+    keyframes.reserve(keyframePts.size());
+    for (qint64 pts : std::as_const(keyframePts)) {
+        keyframes.append(ceilToMs(pts - start, 90000));
+    }
+    return keyframes;
+}
+
+}
+
+namespace KeyframeIndex {
+
+QList<qint64> build(const QString &filePath, const std::function<bool()> &isAborted)
+{
+    TraceScope scope("关键帧索引");
+    auto aborted = [&isAborted]() { return isAborted && isAborted(); };
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    // 按文件内容判断容器格式，不依赖扩展名
+    QByteArray head = file.read(200);
+    const uchar *bytes = reinterpret_cast<const uchar *>(head.constData());
+    QList<qint64> keyframes;
+    if (head.size() >= 8) {
+        const quint32 type = quint32(readBigEndian(bytes + 4, 4));
+        if (readBigEndian(bytes, 4) == EbmlHeaderId) {
+            keyframes = parseMatroska(file, aborted);
+        } else if (type == fourcc("ftyp") || type == fourcc("moov") || type == fourcc("mdat")
+                   || type == fourcc("free") || type == fourcc("wide") || type == fourcc("skip")) {
+            keyframes = parseMp4(file, aborted);
+        } else if (head.size() >= 189 && bytes[0] == 0x47 && bytes[188] == 0x47) {
+            keyframes = parseTransportStream(file, 188, aborted);
+        } else if (head.size() >= 197 && bytes[4] == 0x47 && bytes[196] == 0x47) {
+            keyframes = parseTransportStream(file, 192, aborted);
+        }
+    }
+    if (aborted()) {
+        return {};
+    }
+
+    std::sort(keyframes.begin(), keyframes.end());
+    keyframes.erase(std::unique(keyframes.begin(), keyframes.end()), keyframes.end());
+    // 只有一个关键帧或每帧都是关键帧时，对齐没有意义
+    if (keyframes.size() < 2) {
+        keyframes.clear();
+    }
+    return keyframes;
+}
+
+qint64 snap(const QList<qint64> &keyframes, qint64 target, qint64 from)
+{
+    if (keyframes.isEmpty()) {
+        return target;
+    }
+    auto after = std::lower_bound(keyframes.cbegin(), keyframes.cend(), target);
+    qint64 snapped;
+    if (after == keyframes.cend()) {
+        snapped = keyframes.last();
+    } else if (after == keyframes.cbegin() || *after - target < target - *(after - 1)) {
+        snapped = *after;
+    } else {
+        snapped = *(after - 1);
+    }
+    if (from < 0) {
+        return snapped;
+    }
+
+    if (target > from && snapped <= from) {
+        auto next = std::upper_bound(keyframes.cbegin(), keyframes.cend(), from);
+        return next != keyframes.cend() ? *next : target;
+    }
+    if (target < from && snapped > from - MinBackwardStepMs) {
+        auto previous = std::lower_bound(keyframes.cbegin(), keyframes.cend(), from - MinBackwardStepMs);
+        return previous != keyframes.cbegin() ? *(previous - 1) : 0;
+    }
+    return snapped;
+}
+
+}
+
+// 运行在工作线程中
+class KeyframeIndexWorker : public QObject
+{
+public:
+    KeyframeIndexWorker(const QString &cacheDirectory, KeyframeIndexer *owner)
+        : m_cacheDirectory(cacheDirectory)
+        , m_owner(owner)
+    {
+    }
+
+    void build(const QString &filePath, const QString &videoHash, const std::function<bool()> &isAborted)
+    {
+        if (isAborted()) {
+            return;
+        }
+        QString cachePath = m_cacheDirectory + "/" + videoHash + ".kfi";
+        QList<qint64> keyframes;
+        if (!loadCache(cachePath, keyframes)) {
+            keyframes = KeyframeIndex::build(filePath, isAborted);
+            if (isAborted()) {
+                return;
+            }
+            saveCache(cachePath, keyframes);
+        }
+
+        KeyframeIndexer *owner = m_owner;
+        QMetaObject::invokeMethod(owner, [owner, videoHash, keyframes]() {
+            emit owner->ready(videoHash, keyframes);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    bool loadCache(const QString &cachePath, QList<qint64> &keyframes) const
+    {
+        QFile file(cachePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version >> keyframes;
+        return stream.status() == QDataStream::Ok && magic == IndexMagic && version == IndexVersion;
+    }
+
+    void saveCache(const QString &cachePath, const QList<qint64> &keyframes) const
+    {
+        // 没有关键帧信息的文件也记录下来，下次不再解析
+        QDir().mkpath(m_cacheDirectory);
+        QSaveFile file(cachePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << IndexMagic << IndexVersion << keyframes;
+        file.commit();
+    }
+
+    QString m_cacheDirectory;
+    KeyframeIndexer *m_owner;
+};
+
+KeyframeIndexer::KeyframeIndexer(const QString &cacheDirectory, QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+    , m_generation(0)
+{
+    m_worker = new KeyframeIndexWorker(cacheDirectory, this);
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("关键帧索引");
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start(QThread::LowestPriority);
+}
+
+KeyframeIndexer::~KeyframeIndexer()
+{
+    cancel();
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void KeyframeIndexer::load(const QString &filePath, const QString &videoHash)
+{
+    // 递增代数，正在解析的旧文件在下一次检查时中止
+    quint64 generation = ++m_generation;
+    KeyframeIndexWorker *worker = m_worker;
+    std::atomic<quint64> *current = &m_generation;
+    QMetaObject::invokeMethod(m_worker, [worker, filePath, videoHash, generation, current]() {
+        worker->build(filePath, videoHash, [current, generation]() {
+            return current->load(std::memory_order_relaxed) != generation;
+        });
+    }, Qt::QueuedConnection);
+}
+
+void KeyframeIndexer::cancel()
+{
+    ++m_generation;
+}
@@ -0,0 +1,53 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QObject>
+#include <QList>
+#include <atomic>
+#include <functional>
+
+class QThread;
+class KeyframeIndexWorker;
+
+// 从容器结构读取关键帧时间（毫秒，升序），不解码视频
+// MP4/MOV：视频轨的stss（同步帧）配合stts、ctts和编辑列表换算为显示时间；
+// Matroska/WebM：Cues中视频轨的索引点；
+// MPEG-TS/M2TS：扫描视频PES，随机访问标志或包含IDR/参数集/序列头的包作为关键帧。
+// 不支持的格式或没有关键帧信息（例如全部是关键帧）时返回空列表。
+namespace KeyframeIndex {
+
+// isAborted返回true时尽快结束（结果为空）
+QList<qint64> build(const QString &filePath, const std::function<bool()> &isAborted = {});
+
+// 把跳转目标对齐到最近的关键帧；from >= 0 时保证跳转方向不变
+// （向前跳转不会落在from或之前，向后跳转至少后退MinBackwardStepMs）
+qint64 snap(const QList<qint64> &keyframes, qint64 target, qint64 from = -1);
+
+constexpr qint64 MinBackwardStepMs = 500;
+
+}
+
+// 后台建立关键帧索引
+// 低优先级线程中解析容器，结果按视频哈希保存在缓存目录中，再次打开同一视频时直接读取
+class KeyframeIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KeyframeIndexer(const QString &cacheDirectory, QObject *parent = nullptr);
+    ~KeyframeIndexer() override;
+    
+    // 开始为视频建立索引（会中止正在进行的解析）
+    void load(const QString &filePath, const QString &videoHash);
+    void cancel();
+
+signals:
+    void ready(const QString &videoHash, const QList<qint64> &keyframes);
+
+private:
+    QThread *m_workerThread;
+    KeyframeIndexWorker *m_worker;
+    std::atomic<quint64> m_generation;
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -1,11 +1,76 @@
 #include "mainwindow.h"
+#include "startupprofiler.h"
+#include "singleinstance.h"
+#include "mediapath.h"
+#include "tracer.h"
+#include "metrics.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
+    // 尽早创建分析器，使计时起点接近进程启动
+    StartupProfiler &profiler = StartupProfiler::instance();
+
     QApplication a(argc, argv);
+    profiler.mark("创建QApplication");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "要打开的视频文件、文件夹或网址", "[paths...]");
+    QCommandLineOption startupProfileOption("startup-profile", "打印启动各阶段的耗时");
+    parser.addOption(startupProfileOption);
+    QCommandLineOption newInstanceOption("new-instance", "不转发给已运行的播放器，启动新的实例");
+    parser.addOption(newInstanceOption);
+    QCommandLineOption traceOption("trace", "记录播放流程的时间线，按Ctrl+Shift+T或退出时写入Chrome跟踪文件", "file");
+    parser.addOption(traceOption);
+    QCommandLineOption metricsOption("metrics-port", "在127.0.0.1的指定端口以Prometheus格式提供运行指标（/metrics）", "port");
+    parser.addOption(metricsOption);
+    parser.process(a);
+    profiler.setEnabled(parser.isSet(startupProfileOption));
+    if (parser.isSet(traceOption)) {
+        Tracer::start(QFileInfo(parser.value(traceOption)).absoluteFilePath());
+    }
+    if (parser.isSet(metricsOption)) {
+        bool ok = false;
+        quint16 port = parser.value(metricsOption).toUShort(&ok);
+        if (!ok || port == 0 || !Metrics::start(port)) {
+            qWarning().noquote() << QString("无法在端口 %1 提供运行指标").arg(parser.value(metricsOption));
+        }
+    }
+
+    // 相对路径按当前进程的工作目录解析，转发给其他实例后仍然有效
+    QStringList paths;
+    for (const QString &argument : parser.positionalArguments()) {
+        paths << (isStreamUrl(argument) ? argument : QFileInfo(argument).absoluteFilePath());
+    }
+
+    // 单实例模式：已有播放器在运行时把参数交给它，当前进程立即退出
+    SingleInstance instance("VideoPlayer");
+    bool singleInstanceMode = QSettings("VideoPlayer", "Settings").value("singleInstance", true).toBool()
+                              && !parser.isSet(newInstanceOption);
+    if (singleInstanceMode) {
+        if (instance.forwardToRunningInstance(paths)) {
+            return 0;
+        }
+        instance.listen();
+    }
+    profiler.mark("单实例检查");
+
     MainWindow w;
+    QObject::connect(&instance, &SingleInstance::argumentsReceived, &w, &MainWindow::openPaths);
     w.show();
-    return a.exec();
+    profiler.mark("显示窗口");
+
+    if (!paths.isEmpty()) {
+        w.openPaths(paths);
+    }
+    int result = a.exec();
+    if (Tracer::isEnabled()) {
+        Tracer::dump();
+    }
+    Metrics::stop();
+    return result;
 }
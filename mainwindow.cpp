@@ -3,6 +3,19 @@
 #include <QFileInfo>
 #include <QMimeDatabase>
 #include <QStandardPaths>
+#include <QPaintEvent>
+#include <QInputDialog>
+#include <QVideoSink>
+#include <QMediaMetaData>
+#include <QDebug>
+#include <QToolTip>
+#include <QScrollBar>
+#include "startupprofiler.h"
+#include "timeformat.h"
+#include "videohash.h"
+#include "mediapath.h"
+#include "metrics.h"
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -11,14 +24,23 @@ MainWindow::MainWindow(QWidget *parent)
     , m_videoContainer(nullptr)
     , m_playlistContainer(nullptr)
     , m_videoWidget(nullptr)
-    , m_playlistWidget(nullptr)
+    , m_playlistView(nullptr)
+    , m_playlistModel(nullptr)
     , m_controlsWidget(nullptr)
     , m_playButton(nullptr)
     , m_stopButton(nullptr)
     , m_openFolderButton(nullptr)
+    , m_openUrlButton(nullptr)
     , m_togglePlaylistButton(nullptr)
     , m_positionSlider(nullptr)
+    , m_waveformStrip(nullptr)
+    , m_shuffleButton(nullptr)
+    , m_repeatButton(nullptr)
+    , m_importButton(nullptr)
+    , m_exportButton(nullptr)
     , m_speedComboBox(nullptr)
+    , m_sortComboBox(nullptr)
+    , m_sortOrderButton(nullptr)
     , m_timeLabel(nullptr)
     , m_mediaPlayer(nullptr)
     , m_audioOutput(nullptr)
@@ -26,7 +48,6 @@ MainWindow::MainWindow(QWidget *parent)
     , m_duration(0)
     , m_settings(nullptr)
     , m_positionSliderPressed(false)
-    , m_currentPlayingIndex(-1)
     , m_isMuted(false)
     , m_previousVolume(70)
     , m_longPressTimer(nullptr)
@@ -35,17 +56,74 @@ MainWindow::MainWindow(QWidget *parent)
     , m_longPressForward(true)
     , m_leftKeySpeed(2.0)
     , m_rightKeySpeed(2.0)
+    , m_smoothSlowMotion(false)
+    , m_fastSeek(false)
     , m_settingsDialog(nullptr)
     , m_positionDialog(nullptr)
     , m_currentVideoHash("")
     , m_pendingJumpPosition(-1)
+    , m_deferredInitScheduled(false)
+    , m_restoreLastFolder(false)
+    , m_mediaDevices(nullptr)
+    , m_uiRefreshScheduler(nullptr)
+    , m_lastPosition(0)
+    , m_displayedSecond(-1)
+    , m_displayedDurationSecond(-1)
+    , m_readAheadEnabled(false)
+    , m_singleInstanceEnabled(true)
+    , m_sourceDevice(nullptr)
+    , m_displayedFillPercent(-1)
+    , m_streamProxy(nullptr)
+    , m_playlistReader(nullptr)
+    , m_metadataProber(nullptr)
+    , m_visibleRowsTimer(nullptr)
+    , m_metadataProbeLimit(MetadataProber::DefaultMaxOpenFiles)
+    , m_thumbnailProvider(nullptr)
+    , m_thumbnailCacheMB(256)
+    , m_sceneDetector(nullptr)
+    , m_videoStack(nullptr)
+    , m_gridView(nullptr)
+    , m_subtitleIndex(nullptr)
+    , m_subtitleSearchDialog(nullptr)
+    , m_pendingSeekPosition(-1)
+    , m_loopStart(-1)
+    , m_loopEnd(-1)
+    , m_loopCacheMB(512)
+    , m_segmentCache(nullptr)
+    , m_segmentView(nullptr)
+    , m_loopAudioTap(false)
+    , m_audioBufferOutput(nullptr)
+    , m_spectrumAnalyzer(nullptr)
+    , m_spectrumView(nullptr)
+    , m_spectrumEnabled(false)
+    , m_slowMotionView(nullptr)
+    , m_frameCapture(nullptr)
+    , m_snapshotFormat("png")
+    , m_waveformGenerator(nullptr)
+    , m_keyframeIndexer(nullptr)
+    , m_duplicateFinder(nullptr)
+    , m_duplicateDialog(nullptr)
+    , m_traceOpenId(0)
+    , m_traceOpenLoaded(false)
+    , m_traceSeekId(0)
+    , m_traceSeekTarget(-1)
+    , m_metricsOpenLoaded(false)
+    , m_metricsSeekTarget(-1)
+    , m_metricsFrameInterval(0)
+    , m_metricsLastFrameTime(-1)
 {
+    StartupProfiler &profiler = StartupProfiler::instance();
+    
     // 初始化设置
     m_settings = new QSettings("VideoPlayer", "Settings", this);
+    profiler.mark("打开设置存储");
     
     setupUI();
+    profiler.mark("创建界面和媒体播放器");
     setupConnections();
+    profiler.mark("建立信号连接");
     loadSettings();
+    profiler.mark("加载设置");
     
     // 设置窗口属性
     setWindowTitle("视频播放器");
@@ -63,7 +141,13 @@ MainWindow::~MainWindow()
         // 保存当前播放位置
         saveVideoPosition();
         m_mediaPlayer->stop();
+        m_mediaPlayer->setSource(QUrl());
+    }
+    if (m_sourceDevice) {
+        delete m_sourceDevice;
+        m_sourceDevice = nullptr;
     }
+    delete m_playlistReader;
     saveSettings();
 }
 
@@ -87,6 +171,7 @@ void MainWindow::setupUI()
     // 创建媒体播放器和音频输出
     m_mediaPlayer = new QMediaPlayer(this);
     m_audioOutput = new QAudioOutput(this);
+    m_audioDeviceId = m_audioOutput->device().id();
     m_mediaPlayer->setAudioOutput(m_audioOutput);
     m_mediaPlayer->setVideoOutput(m_videoWidget);
     
@@ -109,6 +194,10 @@ void MainWindow::setupUI()
     m_openFolderButton = new QPushButton("选择文件/文件夹");
     m_openFolderButton->setStyleSheet("QPushButton { padding: 8px 16px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; }");
     
+    m_openUrlButton = new QPushButton("打开网址");
+    m_openUrlButton->setStyleSheet("QPushButton { padding: 8px 16px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; }");
+    m_openUrlButton->setToolTip("打开网络视频地址（HTTP/HLS）");
+    
     m_togglePlaylistButton = new QPushButton("隐藏播放列表");
     m_togglePlaylistButton->setStyleSheet("QPushButton { padding: 8px 16px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; }");
     
@@ -118,6 +207,16 @@ void MainWindow::setupUI()
     m_nextButton->setStyleSheet("QPushButton { border: none; background-color: #f0f0f0; border-radius: 20px; } QPushButton:hover { background-color: #e0e0e0; }");
     m_nextButton->setToolTip("播放下一个视频");
     
+    m_shuffleButton = new QPushButton("⇄");
+    m_shuffleButton->setCheckable(true);
+    m_shuffleButton->setFixedSize(40, 40);
+    m_shuffleButton->setStyleSheet("QPushButton { border: none; background-color: #f0f0f0; border-radius: 20px; color: black; font-size: 16px; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:checked { background-color: #0078d4; color: white; }");
+    m_shuffleButton->setToolTip("随机播放");
+    
+    m_repeatButton = new QPushButton();
+    m_repeatButton->setFixedSize(40, 40);
+    m_repeatButton->setStyleSheet("QPushButton { border: none; background-color: #f0f0f0; border-radius: 20px; color: black; font-size: 14px; } QPushButton:hover { background-color: #e0e0e0; }");
+    
     m_settingsButton = new QPushButton();
     m_settingsButton->setIcon(QIcon(":/Images/setting.png"));
     m_settingsButton->setFixedSize(40, 40);
@@ -128,6 +227,9 @@ void MainWindow::setupUI()
     m_positionSlider = new ClickableSlider(Qt::Horizontal);
     m_positionSlider->setStyleSheet("QSlider::groove:horizontal { border: 1px solid #ccc; height: 8px; background: #f5f5f5; margin: 2px 0; border-radius: 4px; } QSlider::handle:horizontal { background: #0078d4; border: 1px solid #0078d4; width: 18px; margin: -2px 0; border-radius: 9px; }");
     
+    // 创建进度条下方的音频波形
+    m_waveformStrip = new WaveformStrip();
+    
     // 创建倍速选择
     m_speedComboBox = new QComboBox();
     m_speedComboBox->addItems({"0.5x", "0.75x", "1.0x", "1.25x", "1.5x", "1.75x", "2.0x", "2.25x", "2.5x", "2.75x", "3.0x"});
@@ -156,7 +258,13 @@ void MainWindow::setupUI()
     controlsLayout->addWidget(m_playButton);
     controlsLayout->addWidget(m_stopButton);
     controlsLayout->addWidget(m_nextButton);
-    controlsLayout->addWidget(m_positionSlider, 1);
+    controlsLayout->addWidget(m_shuffleButton);
+    controlsLayout->addWidget(m_repeatButton);
+    QVBoxLayout *timelineLayout = new QVBoxLayout();
+    timelineLayout->addWidget(m_positionSlider);
+    timelineLayout->addWidget(m_waveformStrip);
+    timelineLayout->setSpacing(2);
+    controlsLayout->addLayout(timelineLayout, 1);
     controlsLayout->addWidget(m_timeLabel);
     controlsLayout->addWidget(m_volumeButton);
     controlsLayout->addWidget(m_volumeSlider);
@@ -166,6 +274,7 @@ void MainWindow::setupUI()
     controlsLayout->addWidget(speedLabel);
     controlsLayout->addWidget(m_speedComboBox);
     controlsLayout->addWidget(m_openFolderButton);
+    controlsLayout->addWidget(m_openUrlButton);
     controlsLayout->addWidget(m_settingsButton);
     controlsLayout->addWidget(m_togglePlaylistButton);
     controlsLayout->setContentsMargins(10, 10, 10, 10);
@@ -173,8 +282,12 @@ void MainWindow::setupUI()
     // 倍速标签样式已在上面设置
     
     // 布局视频容器
+    // 视频区域可在单视频和宫格播放之间切换
+    m_videoStack = new QStackedWidget();
+    m_videoStack->addWidget(m_videoWidget);
+    
     QVBoxLayout *videoLayout = new QVBoxLayout(m_videoContainer);
-    videoLayout->addWidget(m_videoWidget, 1);
+    videoLayout->addWidget(m_videoStack, 1);
     videoLayout->addWidget(m_controlsWidget);
     videoLayout->setContentsMargins(0, 0, 0, 0);
     videoLayout->setSpacing(0);
@@ -186,12 +299,28 @@ void MainWindow::setupUI()
     m_playlistContainer->setStyleSheet("background-color: white; border-left: 1px solid #ccc;");
     
     // 创建播放列表
-    m_playlistWidget = new QListWidget();
-    m_playlistWidget->setStyleSheet("QListWidget { background-color: white; border: none; color: black; } QListWidget::item { padding: 8px; border-bottom: 1px solid #eee; } QListWidget::item:selected { background-color: #0078d4; color: white; } QListWidget::item:hover { background-color: #f5f5f5; color: black; } QListWidget::item:selected:hover { background-color: #0078d4; color: white; }");
-    
-    // 启用拖拽排序
-    m_playlistWidget->setDragDropMode(QAbstractItemView::InternalMove);
-    m_playlistWidget->setDefaultDropAction(Qt::MoveAction);
+    m_playlistModel = new PlaylistModel(this);
+    m_playlistView = new PlaylistView();
+    m_playlistView->setModel(m_playlistModel);
+    m_playlistView->setStyleSheet("QListView { background-color: white; border: none; color: black; } QListView::item { padding: 8px; border-bottom: 1px solid #eee; } QListView::item:selected { background-color: #0078d4; color: white; } QListView::item:hover { background-color: #f5f5f5; color: black; } QListView::item:selected:hover { background-color: #0078d4; color: white; }");
+    m_playlistView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    
+    // 所有条目高度相同，大列表时无需逐项计算布局
+    m_playlistView->setUniformItemSizes(true);
+    
+    // 左侧显示缩略图，文件名下方显示探测到的元数据
+    m_metadataProber = new MetadataProber(this);
+    QString thumbnailDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    m_thumbnailProvider = new ThumbnailProvider(thumbnailDirectory, qint64(m_thumbnailCacheMB) * 1024 * 1024, this);
+    m_playlistView->setItemDelegate(new PlaylistDelegate(m_metadataProber, m_thumbnailProvider, m_playlistView));
+    m_visibleRowsTimer = new QTimer(this);
+    m_visibleRowsTimer->setSingleShot(true);
+    m_visibleRowsTimer->setInterval(100);
+    
+    // 启用拖拽排序，可以多选后一起拖动
+    m_playlistView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_playlistView->setDragDropMode(QAbstractItemView::InternalMove);
+    m_playlistView->setDefaultDropAction(Qt::MoveAction);
     
     // 创建上移下移按钮
     m_moveUpButton = new QPushButton("↑ 上移");
@@ -206,6 +335,40 @@ void MainWindow::setupUI()
     m_removeButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #ff4444; border: 1px solid #cc0000; border-radius: 4px; color: white; } QPushButton:hover { background-color: #cc0000; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
     m_removeButton->setToolTip("删除选中的视频");
     
+    m_importButton = new QPushButton("导入列表");
+    m_importButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
+    m_importButton->setToolTip("从M3U/M3U8文件导入播放列表");
+    
+    m_exportButton = new QPushButton("导出列表");
+    m_exportButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
+    m_exportButton->setToolTip("把播放列表导出为M3U8文件");
+    
+    // 排序方式，选择后立即重新排列；打开文件夹时也按此顺序
+    m_sortComboBox = new QComboBox();
+    m_sortComboBox->addItem("按名称", PlaylistModel::SortByName);
+    m_sortComboBox->addItem("按修改时间", PlaylistModel::SortByModified);
+    m_sortComboBox->addItem("按大小", PlaylistModel::SortBySize);
+    m_sortComboBox->addItem("按时长", PlaylistModel::SortByDuration);
+    m_sortComboBox->setStyleSheet("QComboBox { padding: 4px 8px; background-color: white; border: 1px solid #ccc; border-radius: 4px; color: black; } QComboBox::drop-down { border: none; } QComboBox::down-arrow { image: none; border: none; } QComboBox QAbstractItemView { background-color: white; color: black; border: 1px solid #ccc; }");
+    m_sortComboBox->setToolTip("重新排列播放列表（文件名中的数字按数值比较）");
+    
+    m_sortOrderButton = new QPushButton();
+    m_sortOrderButton->setCheckable(true);
+    m_sortOrderButton->setFixedWidth(32);
+    m_sortOrderButton->setStyleSheet("QPushButton { padding: 6px 0px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; }");
+    
+    m_gridButton = new QPushButton("宫格播放");
+    m_gridButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
+    m_gridButton->setToolTip("从当前选中的视频开始，同时静音播放多个视频");
+    
+    m_subtitleSearchButton = new QPushButton("搜索字幕");
+    m_subtitleSearchButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
+    m_subtitleSearchButton->setToolTip("在播放列表所有视频的字幕中查找台词 (Ctrl+F)");
+    
+    m_duplicateButton = new QPushButton("查找重复");
+    m_duplicateButton->setStyleSheet("QPushButton { padding: 6px 12px; background-color: #f0f0f0; border: 1px solid #ccc; border-radius: 4px; color: black; } QPushButton:hover { background-color: #e0e0e0; } QPushButton:disabled { background-color: #f8f8f8; color: #ccc; }");
+    m_duplicateButton->setToolTip("对比画面，找出播放列表中重复的视频");
+    
     // 初始状态下禁用按钮
     m_moveUpButton->setEnabled(false);
     m_moveDownButton->setEnabled(false);
@@ -227,11 +390,36 @@ void MainWindow::setupUI()
     buttonLayout->setContentsMargins(8, 8, 8, 8);
     buttonLayout->setSpacing(8);
     
+    // 创建导入导出按钮容器
+    QWidget *listIoContainer = new QWidget();
+    listIoContainer->setStyleSheet("background-color: #f8f8f8;");
+    QHBoxLayout *listIoLayout = new QHBoxLayout(listIoContainer);
+    listIoLayout->addWidget(m_importButton);
+    listIoLayout->addWidget(m_exportButton);
+    listIoLayout->addStretch();
+    listIoLayout->addWidget(m_sortComboBox);
+    listIoLayout->addWidget(m_sortOrderButton);
+    listIoLayout->setContentsMargins(8, 0, 8, 8);
+    listIoLayout->setSpacing(8);
+    
+    // 创建宫格播放、字幕搜索和重复查找按钮容器（播放列表宽度有限，单独一行）
+    QWidget *listToolsContainer = new QWidget();
+    listToolsContainer->setStyleSheet("background-color: #f8f8f8;");
+    QHBoxLayout *listToolsLayout = new QHBoxLayout(listToolsContainer);
+    listToolsLayout->addWidget(m_gridButton);
+    listToolsLayout->addWidget(m_subtitleSearchButton);
+    listToolsLayout->addWidget(m_duplicateButton);
+    listToolsLayout->addStretch();
+    listToolsLayout->setContentsMargins(8, 0, 8, 8);
+    listToolsLayout->setSpacing(8);
+    
     // 布局播放列表容器
     QVBoxLayout *playlistLayout = new QVBoxLayout(m_playlistContainer);
     playlistLayout->addWidget(playlistTitle);
-    playlistLayout->addWidget(m_playlistWidget, 1);
+    playlistLayout->addWidget(m_playlistView, 1);
     playlistLayout->addWidget(buttonContainer);
+    playlistLayout->addWidget(listIoContainer);
+    playlistLayout->addWidget(listToolsContainer);
     playlistLayout->setContentsMargins(0, 0, 0, 0);
     playlistLayout->setSpacing(0);
     
@@ -257,6 +445,10 @@ void MainWindow::setupUI()
     // 初始化连续跳转定时器
     m_continuousSeekTimer = new QTimer(this);
     m_continuousSeekTimer->setInterval(100); // 每100ms跳转一次
+    
+    // 初始化界面刷新调度器，预留时间文本缓冲区
+    m_uiRefreshScheduler = new UiRefreshScheduler(this);
+    m_timeText.reserve(TimeTextCapacity);
 }
 
 void MainWindow::setupConnections()
@@ -266,6 +458,7 @@ void MainWindow::setupConnections()
     connect(m_stopButton, &QPushButton::clicked, this, &MainWindow::stopVideo);
     connect(m_nextButton, &QPushButton::clicked, this, &MainWindow::playNextVideo);
     connect(m_openFolderButton, &QPushButton::clicked, this, &MainWindow::openFileOrFolder);
+    connect(m_openUrlButton, &QPushButton::clicked, this, &MainWindow::openUrl);
     connect(m_settingsButton, &QPushButton::clicked, this, &MainWindow::openSettings);
     connect(m_togglePlaylistButton, &QPushButton::clicked, this, &MainWindow::togglePlaylist);
     
@@ -283,26 +476,70 @@ void MainWindow::setupConnections()
     connect(m_speedComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::changePlaybackRate);
     
     // 播放列表连接
-    connect(m_playlistWidget, &QListWidget::itemDoubleClicked, this, &MainWindow::onPlaylistItemDoubleClicked);
-    connect(m_playlistWidget, &QListWidget::itemSelectionChanged, this, [this]() {
-        bool hasSelection = m_playlistWidget->currentRow() >= 0;
-        bool canMoveUp = hasSelection && m_playlistWidget->currentRow() > 0;
-        bool canMoveDown = hasSelection && m_playlistWidget->currentRow() < m_playlistWidget->count() - 1;
-        m_moveUpButton->setEnabled(canMoveUp);
-        m_moveDownButton->setEnabled(canMoveDown);
+    connect(m_playlistView, &QListView::doubleClicked, this, &MainWindow::onPlaylistItemDoubleClicked);
+    auto updateListButtons = [this]() {
+        QModelIndexList selected = m_playlistView->selectionModel()->selectedRows();
+        bool hasSelection = !selected.isEmpty();
+        int firstRow = m_playlistModel->rowCount();
+        int lastRow = -1;
+        for (const QModelIndex &index : selected) {
+            firstRow = qMin(firstRow, index.row());
+            lastRow = qMax(lastRow, index.row());
+        }
+        m_moveUpButton->setEnabled(hasSelection && firstRow > 0);
+        m_moveDownButton->setEnabled(hasSelection && lastRow < m_playlistModel->rowCount() - 1);
         m_removeButton->setEnabled(hasSelection);
-    });
+    };
+    connect(m_playlistView->selectionModel(), &QItemSelectionModel::selectionChanged, this, updateListButtons);
+    connect(m_playlistModel, &QAbstractItemModel::rowsMoved, this, updateListButtons);
+    
+    // 播放模式
+    connect(m_shuffleButton, &QPushButton::clicked, this, &MainWindow::toggleShuffle);
+    connect(m_repeatButton, &QPushButton::clicked, this, &MainWindow::cycleRepeatMode);
     
     // 上移下移删除按钮连接
     connect(m_moveUpButton, &QPushButton::clicked, this, &MainWindow::moveItemUp);
     connect(m_moveDownButton, &QPushButton::clicked, this, &MainWindow::moveItemDown);
     connect(m_removeButton, &QPushButton::clicked, this, &MainWindow::removeSelectedVideo);
+    connect(m_importButton, &QPushButton::clicked, this, &MainWindow::importPlaylist);
+    connect(m_exportButton, &QPushButton::clicked, this, &MainWindow::exportPlaylist);
+    connect(m_gridButton, &QPushButton::clicked, this, &MainWindow::toggleGridMode);
+    connect(m_subtitleSearchButton, &QPushButton::clicked, this, &MainWindow::openSubtitleSearch);
+    connect(m_duplicateButton, &QPushButton::clicked, this, &MainWindow::openDuplicateFinder);
+    connect(m_waveformStrip, &WaveformStrip::seekRequested, this, &MainWindow::onWaveformSeekRequested);
+    
+    // 元数据探测：滚动或列表变化停止后更新可见范围，结果到达后重绘列表
+    connect(m_playlistView->verticalScrollBar(), &QScrollBar::valueChanged, m_visibleRowsTimer, qOverload<>(&QTimer::start));
+    connect(m_playlistView->verticalScrollBar(), &QScrollBar::rangeChanged, m_visibleRowsTimer, qOverload<>(&QTimer::start));
+    connect(m_visibleRowsTimer, &QTimer::timeout, this, &MainWindow::updateVisibleProbes);
+    connect(m_metadataProber, &MetadataProber::probed, m_playlistView->viewport(), qOverload<>(&QWidget::update));
+    connect(m_thumbnailProvider, &ThumbnailProvider::thumbnailReady, m_playlistView->viewport(), qOverload<>(&QWidget::update));
+    connect(m_metadataProber, &MetadataProber::probed, this, [this](const QString &path, const MediaInfo &info) {
+        // 记录时长，供按时长排序；探测失败时保留导入列表中的时长
+        if (info.durationMs >= 0) {
+            m_playlistModel->setDuration(m_playlistModel->idOfPath(path), info.durationMs);
+        }
+    });
+    
+    // activated在重新选择同一项时也会发出，可用于再次排序
+    connect(m_sortComboBox, QOverload<int>::of(&QComboBox::activated), this, &MainWindow::sortPlaylist);
+    connect(m_sortOrderButton, &QPushButton::clicked, this, &MainWindow::toggleSortOrder);
     
     // 媒体播放器连接
     connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, &MainWindow::updatePosition);
     connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, &MainWindow::updateDuration);
     connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this, &MainWindow::mediaStatusChanged);
     connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, &MainWindow::playbackStateChanged);
+    connect(m_mediaPlayer, &QMediaPlayer::playbackRateChanged, this, &MainWindow::updateSlowMotion);
+    connect(m_mediaPlayer, &QMediaPlayer::hasVideoChanged, this, &MainWindow::updateSlowMotion);
+    
+    // 只有启用时间线记录或运行指标时才监听每一帧
+    if (Tracer::isEnabled()) {
+        connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, &MainWindow::traceVideoFrame);
+    }
+    if (Metrics::isEnabled()) {
+        connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, &MainWindow::measureVideoFrame);
+    }
     
     // 视频组件连接
     connect(m_videoWidget, &ClickableVideoWidget::doubleClicked, this, &MainWindow::onVideoWidgetDoubleClicked);
@@ -311,10 +548,10 @@ void MainWindow::setupConnections()
     connect(m_longPressTimer, &QTimer::timeout, this, &MainWindow::onLongPressTimer);
     connect(m_continuousSeekTimer, &QTimer::timeout, this, &MainWindow::onContinuousSeekTimer);
     
-    // 音频设备变化监听
-    // 注意：QMediaDevices在Qt 6中是静态类，需要创建一个实例来连接信号
-    QMediaDevices *mediaDevices = new QMediaDevices(this);
-    connect(mediaDevices, &QMediaDevices::audioOutputsChanged, this, &MainWindow::onAudioOutputsChanged);
+    // 界面刷新连接
+    connect(m_uiRefreshScheduler, &UiRefreshScheduler::refresh, this, &MainWindow::refreshPlaybackWidgets);
+    
+    // 音频设备变化监听在首次绘制后才建立，见runDeferredInit()
 }
 
 void MainWindow::openFileOrFolder()
@@ -355,44 +592,155 @@ void MainWindow::openFileOrFolder()
                 
                 // 如果添加了文件，自动播放第一个新添加的文件
                 if (!selectedFiles.isEmpty()) {
-                    QString firstFile = selectedFiles.first();
-                    // 找到该文件在列表中的位置并播放
-                    for (int i = 0; i < m_playlistWidget->count(); ++i) {
-                        QListWidgetItem *item = m_playlistWidget->item(i);
-                        if (item && item->data(Qt::UserRole).toString() == firstFile) {
-                            m_currentPlayingIndex = i;
-                            m_playlistWidget->setCurrentRow(i);
-                            playVideoFile(firstFile);
-                            break;
-                        }
-                    }
+                    playPlaylistPath(QFileInfo(selectedFiles.first()).absoluteFilePath());
                 }
             }
         }
     }
 }
 
+void MainWindow::openUrl()
+{
+    bool ok = false;
+    QString url = QInputDialog::getText(this, "打开网址", "视频地址（MP4或HLS播放列表）:",
+                                        QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || url.isEmpty()) {
+        return;
+    }
+    
+    if (!isStreamUrl(url)) {
+        QMessageBox::warning(this, "错误", "请输入有效的http或https地址");
+        return;
+    }
+    
+    addVideoFile(url);
+    playPlaylistPath(url);
+}
+
+void MainWindow::openPaths(const QStringList &paths)
+{
+    // 已有明确要打开的内容，不再恢复上次的文件夹
+    m_restoreLastFolder = false;
+    
+    QString firstToPlay;
+    for (const QString &path : paths) {
+        if (isStreamUrl(path)) {
+            addVideoFile(path);
+        } else if (QFileInfo(path).isDir()) {
+            m_currentFolder = path;
+            loadVideosFromFolder(path);
+            if (firstToPlay.isEmpty() && m_playlistModel->rowCount() > 0) {
+                firstToPlay = m_playlistModel->pathAt(0);
+            }
+            continue;
+        } else {
+            m_currentFolder = QFileInfo(path).absolutePath();
+            addVideoFile(path);
+        }
+        if (firstToPlay.isEmpty()) {
+            firstToPlay = path;
+        }
+    }
+    
+    if (!firstToPlay.isEmpty()) {
+        playPlaylistPath(firstToPlay);
+    }
+    
+    // 把窗口带到前台
+    if (isMinimized()) {
+        showNormal();
+    }
+    raise();
+    activateWindow();
+}
+
+void MainWindow::playPlaylistPath(const QString &filePath)
+{
+    // 找到该文件在列表中的位置并播放
+    PlaybackQueue::ItemId id = m_playlistModel->idOfPath(filePath);
+    if (id) {
+        playQueueItem(id);
+    }
+}
+
+void MainWindow::playQueueItem(PlaybackQueue::ItemId id)
+{
+    int row = m_playlistModel->rowOf(id);
+    if (row < 0) {
+        return;
+    }
+    m_playlistModel->setCurrent(id);
+    
+    // 高亮当前播放的项目
+    QModelIndex index = m_playlistModel->index(row);
+    m_playlistView->setCurrentIndex(index);
+    m_playlistView->scrollTo(index);
+    playVideoFile(m_playlistModel->queue().entry(id).path);
+}
+
+void MainWindow::selectPlaylistPath(const QString &filePath)
+{
+    // 只更新当前播放项和选中状态，由调用方负责播放
+    PlaybackQueue::ItemId id = m_playlistModel->idOfPath(filePath);
+    if (id) {
+        m_playlistModel->setCurrent(id);
+        m_playlistView->setCurrentIndex(m_playlistModel->index(m_playlistModel->rowOf(id)));
+    }
+}
+
 void MainWindow::loadVideosFromFolder(const QString &folderPath)
 {
-    m_playlistWidget->clear();
+    TraceScope scope("扫描文件夹");
+    m_playlistModel->clear();
+    m_metadataProber->clearQueue();
     
     QDir dir(folderPath);
     QStringList videoExtensions = {"*.mp4", "*.avi", "*.mkv", "*.mov", "*.wmv", "*.flv", "*.webm", "*.m4v", "*.3gp", "*.ts", "*.mts"};
     
-    QFileInfoList files = dir.entryInfoList(videoExtensions, QDir::Files | QDir::Readable, QDir::Name);
+    // 不让QDir逐对比较文件名排序，加入列表后按缓存的排序键统一排序
+    QFileInfoList files = dir.entryInfoList(videoExtensions, QDir::Files | QDir::Readable, QDir::NoSort);
     
+    QList<QueueEntry> entries;
+    entries.reserve(files.size());
     for (const QFileInfo &fileInfo : files) {
-        QListWidgetItem *item = new QListWidgetItem(fileInfo.fileName());
-        item->setData(Qt::UserRole, fileInfo.absoluteFilePath());
-        item->setToolTip(fileInfo.absoluteFilePath());
-        m_playlistWidget->addItem(item);
+        QueueEntry entry;
+        entry.path = fileInfo.absoluteFilePath();
+        entry.title = fileInfo.fileName();
+        entries.append(entry);
+    }
+    m_playlistModel->append(entries);
+    
+    // 先按名称排好，按时长排序时尚未探测到的视频仍保持名称顺序
+    PlaylistModel::SortKey sortKey = PlaylistModel::SortKey(m_sortComboBox->currentData().toInt());
+    Qt::SortOrder sortOrder = m_sortOrderButton->isChecked() ? Qt::DescendingOrder : Qt::AscendingOrder;
+    m_playlistModel->sortBy(PlaylistModel::SortByName, sortKey == PlaylistModel::SortByName ? sortOrder : Qt::AscendingOrder);
+    if (sortKey != PlaylistModel::SortByName) {
+        m_playlistModel->sortBy(sortKey, sortOrder);
     }
+    probePlaylistMetadata(m_playlistModel->paths());
     
     // 移除弹窗提示，静默加载视频列表
 }
 
 void MainWindow::playVideo()
 {
+    if (isLoopReplaying()) {
+        if (m_segmentView->isPaused()) {
+            m_segmentView->resume();
+        } else {
+            m_segmentView->pause();
+        }
+        updatePlayButton();
+        return;
+    }
+    if (isGridActive()) {
+        if (m_gridView->playbackState() == QMediaPlayer::PlayingState) {
+            m_gridView->pause();
+        } else {
+            m_gridView->play();
+        }
+        return;
+    }
     if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
         pauseVideo();
     } else {
@@ -402,12 +750,26 @@ void MainWindow::playVideo()
 
 void MainWindow::pauseVideo()
 {
+    if (isLoopReplaying()) {
+        m_segmentView->pause();
+        updatePlayButton();
+        return;
+    }
+    if (isGridActive()) {
+        m_gridView->pause();
+        return;
+    }
     m_mediaPlayer->pause();
 }
 
 void MainWindow::stopVideo()
 {
-    m_mediaPlayer->stop();
+    leaveLoopReplay(false);
+    if (isGridActive()) {
+        m_gridView->stop();
+    } else {
+        m_mediaPlayer->stop();
+    }
     m_positionSlider->setValue(0);
 }
 
@@ -415,53 +777,155 @@ void MainWindow::setPosition(int position)
 {
     if (m_duration > 0) {
         qint64 newPosition = (position * m_duration) / 100;
-        m_mediaPlayer->setPosition(newPosition);
+        leaveLoopReplay(true);
+        if (isGridActive()) {
+            m_gridView->setPosition(newPosition);
+        } else {
+            setPlayerPosition(fastSeekTarget(newPosition));
+        }
     }
 }
 
 void MainWindow::updatePosition(qint64 position)
+{
+    // 只记录位置，控件在下一帧统一刷新
+    m_lastPosition = position;
+    m_uiRefreshScheduler->requestRefresh();
+    
+    // 播放到B点：缓存可用时改为从内存重放，否则跳回A点
+    if (m_loopEnd > 0 && position >= m_loopEnd && !isLoopReplaying() && !isGridActive()) {
+        if (m_segmentCache->isCapturing()) {
+            m_segmentCache->finishCapture();
+        }
+        if (m_segmentCache->isReady()) {
+            startLoopReplay();
+            return;
+        }
+        if (!m_segmentCache->isFinishing()) {
+            startLoopCapture();
+        } else {
+            setPlayerPosition(m_loopStart);
+        }
+    }
+}
+
+void MainWindow::refreshPlaybackWidgets()
 {
     if (m_duration > 0 && !m_positionSliderPressed) {
-        int sliderPosition = (position * 100) / m_duration;
-        m_positionSlider->blockSignals(true);
-        m_positionSlider->setValue(sliderPosition);
-        m_positionSlider->blockSignals(false);
+        int sliderPosition = (m_lastPosition * 100) / m_duration;
+        if (sliderPosition != m_positionSlider->value()) {
+            m_positionSlider->blockSignals(true);
+            m_positionSlider->setValue(sliderPosition);
+            m_positionSlider->blockSignals(false);
+        }
+    }
+    
+    updateSubtitleText();
+    m_waveformStrip->setPosition(m_lastPosition);
+    
+    // 预读缓冲填充程度显示在时间标签的提示中
+    if (m_sourceDevice) {
+        int fillPercent = qRound(m_sourceDevice->fillLevel() * 100);
+        if (fillPercent != m_displayedFillPercent) {
+            m_displayedFillPercent = fillPercent;
+            m_timeLabel->setToolTip(QString("预读缓冲: %1%").arg(fillPercent));
+        }
+    } else if (m_displayedFillPercent != -1) {
+        m_displayedFillPercent = -1;
+        m_timeLabel->setToolTip(QString());
     }
     
-    // 更新时间显示
-    QString currentTime, totalTime;
-    formatTime(position, currentTime);
-    formatTime(m_duration, totalTime);
-    m_timeLabel->setText(currentTime + " / " + totalTime);
+    // 显示的秒数变化时才更新时间标签，避免重复布局和重绘
+    qint64 second = m_lastPosition / 1000;
+    qint64 durationSecond = m_duration / 1000;
+    if (second == m_displayedSecond && durationSecond == m_displayedDurationSecond) {
+        return;
+    }
+    m_displayedSecond = second;
+    m_displayedDurationSecond = durationSecond;
+    
+    QChar buffer[TimeTextCapacity];
+    int length = formatTimeTo(m_lastPosition, buffer);
+    buffer[length++] = QChar(' ');
+    buffer[length++] = QChar('/');
+    buffer[length++] = QChar(' ');
+    length += formatTimeTo(m_duration, buffer + length);
+    m_timeText.setUnicode(buffer, length);
+    m_timeLabel->setText(m_timeText);
 }
 
 void MainWindow::updateDuration(qint64 duration)
 {
     m_duration = duration;
     m_positionSlider->setRange(0, 100);
+    updateChapterMarkers();
+    updateLoopMarkers();
+    m_waveformStrip->setDuration(duration);
+    m_uiRefreshScheduler->refreshNow();
 }
 
-void MainWindow::onPlaylistItemDoubleClicked(QListWidgetItem *item)
+void MainWindow::onPlaylistItemDoubleClicked(const QModelIndex &index)
 {
-    if (item) {
-        QString filePath = item->data(Qt::UserRole).toString();
-        m_currentPlayingIndex = m_playlistWidget->row(item);
-        playVideoFile(filePath);
-        
-        // 高亮当前播放的项目
-        m_playlistWidget->setCurrentItem(item);
+    if (index.isValid()) {
+        playQueueItem(m_playlistModel->idAt(index.row()));
     }
 }
 
 void MainWindow::playVideoFile(const QString &filePath)
 {
-    if (QFileInfo::exists(filePath)) {
+    if (isStreamUrl(filePath) || QFileInfo::exists(filePath)) {
+        exitGridMode();
+        clearLoop();
+        
         // 保存之前视频的播放位置
         saveVideoPosition();
         
         // 设置新视频
-        m_mediaPlayer->setSource(QUrl::fromLocalFile(filePath));
+        if (Tracer::isEnabled()) {
+            if (m_traceOpenId) {
+                Tracer::asyncEnd("打开视频", m_traceOpenId);
+            }
+            m_traceOpenId = Tracer::nextId();
+            m_traceOpenLoaded = false;
+            Tracer::asyncBegin("打开视频", m_traceOpenId);
+        }
+        if (Metrics::isEnabled()) {
+            Metrics::increment(Metrics::FilesOpened);
+            m_metricsOpenTimer.start();
+            m_metricsOpenLoaded = false;
+            m_metricsSeekTimer.invalidate();
+            m_metricsLastFrameTime = -1;
+        }
+        m_pendingSeekPosition = -1;
+        setPlayerSource(filePath);
         m_currentVideoHash = getVideoHash(filePath);
+        m_currentVideoPath = filePath;
+        loadChapters();
+        loadSubtitles(filePath);
+        
+        // 波形在后台生成，已生成过的视频直接读取缓存
+        m_waveformStrip->clear();
+        if (!isStreamUrl(filePath)) {
+            if (!m_waveformGenerator) {
+                QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/waveforms";
+                m_waveformGenerator = new WaveformGenerator(cacheDirectory, this);
+                connect(m_waveformGenerator, &WaveformGenerator::ready, this, &MainWindow::onWaveformReady);
+            }
+            m_waveformGenerator->load(filePath, m_currentVideoHash);
+        } else if (m_waveformGenerator) {
+            m_waveformGenerator->cancel();
+        }
+        loadKeyframeIndex();
+        
+        // 本地文件且尚未分析过时，在媒体加载完成后开始后台镜头检测
+        m_chapterScanPath.clear();
+        if (m_sceneDetector && m_sceneDetector->videoHash() != m_currentVideoHash) {
+            m_sceneDetector->cancel();
+        }
+        if (!isStreamUrl(filePath)
+            && !m_settings->contains(QString("chapters_%1").arg(m_currentVideoHash))) {
+            m_chapterScanPath = filePath;
+        }
         setWindowTitle(QString("视频播放器 - %1").arg(QFileInfo(filePath).baseName()));
         
         // 开始播放
@@ -474,6 +938,146 @@ void MainWindow::playVideoFile(const QString &filePath)
     }
 }
 
+void MainWindow::setPlayerPosition(qint64 position)
+{
+    if (Tracer::isEnabled()) {
+        // 上一次跳转还没等到画面就被新的跳转取代
+        if (m_traceSeekId) {
+            Tracer::asyncStep("被新的跳转取代", m_traceSeekId);
+            Tracer::asyncEnd("跳转", m_traceSeekId);
+        }
+        m_traceSeekId = Tracer::nextId();
+        m_traceSeekTarget = position;
+        Tracer::asyncBegin("跳转", m_traceSeekId, position);
+    }
+    if (Metrics::isEnabled()) {
+        // 上一次跳转尚未完成时只统计最后一次
+        m_metricsSeekTimer.start();
+        m_metricsSeekTarget = position;
+    }
+    m_mediaPlayer->setPosition(position);
+}
+
+void MainWindow::traceVideoFrame(const QVideoFrame &frame)
+{
+    if (m_traceOpenId && m_traceOpenLoaded) {
+        Tracer::asyncEnd("打开视频", m_traceOpenId);
+        m_traceOpenId = 0;
+    }
+    
+    // 画面时间接近目标位置时认为跳转完成
+    if (m_traceSeekId && frame.startTime() >= 0
+        && qAbs(frame.startTime() / 1000 - m_traceSeekTarget) <= 1000) {
+        Tracer::asyncEnd("跳转", m_traceSeekId);
+        m_traceSeekId = 0;
+    }
+}
+
+void MainWindow::measureVideoFrame(const QVideoFrame &frame)
+{
+    if (m_metricsOpenLoaded) {
+        Metrics::observe(Metrics::OpenLatency, m_metricsOpenTimer.nsecsElapsed());
+        m_metricsOpenTimer.invalidate();
+        m_metricsOpenLoaded = false;
+    }
+    
+    qint64 frameTime = frame.startTime();
+    if (frameTime < 0) {
+        return;
+    }
+    
+    // 跳转期间画面时间不连续，不推算丢帧；目标超出范围等原因一直等不到画面时放弃统计
+    if (m_metricsSeekTimer.isValid()) {
+        if (qAbs(frameTime / 1000 - m_metricsSeekTarget) <= 1000) {
+            Metrics::observe(Metrics::SeekLatency, m_metricsSeekTimer.nsecsElapsed());
+            m_metricsSeekTimer.invalidate();
+        } else if (m_metricsSeekTimer.hasExpired(10000)) {
+            m_metricsSeekTimer.invalidate();
+        }
+        m_metricsLastFrameTime = frameTime;
+        return;
+    }
+    
+    // 正常播放时相邻画面相差一个帧间隔，相差更多说明中间的帧没有显示
+    if (m_metricsLastFrameTime >= 0 && m_metricsFrameInterval > 0
+        && m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        qint64 gap = frameTime - m_metricsLastFrameTime;
+        if (gap > m_metricsFrameInterval * 3 / 2 && gap < 1000000) {
+            qint64 skipped = (gap + m_metricsFrameInterval / 2) / m_metricsFrameInterval - 1;
+            Metrics::increment(Metrics::DroppedFrames, quint64(skipped));
+        }
+    }
+    m_metricsLastFrameTime = frameTime;
+}
+
+void MainWindow::dumpTrace()
+{
+    QString errorString;
+    if (Tracer::dump(&errorString)) {
+        qInfo().noquote() << QString("时间线已写入 %1").arg(Tracer::outputPath());
+    } else {
+        QMessageBox::warning(this, "错误", QString("无法写入时间线文件：%1").arg(errorString));
+    }
+}
+
+void MainWindow::setPlayerSource(const QString &filePath)
+{
+    // 连拍只属于当前视频
+    if (m_frameCapture) {
+        m_frameCapture->cancelBurst();
+    }
+    
+    // 中止旧数据源上阻塞的读取，避免切换时等待慢速存储
+    ReadAheadDevice *oldDevice = m_sourceDevice;
+    m_sourceDevice = nullptr;
+    if (oldDevice) {
+        oldDevice->abort();
+    }
+    
+    if (isStreamUrl(filePath)) {
+        // 网络视频经本地代理播放，代理不可用时直接交给播放器
+        if (ensureStreamProxy()) {
+            m_mediaPlayer->setSource(m_streamProxy->proxyUrl(QUrl(filePath)));
+        } else {
+            m_mediaPlayer->setSource(QUrl(filePath));
+        }
+    } else if (m_readAheadEnabled) {
+        ReadAheadDevice *device = new ReadAheadDevice(filePath, this);
+        if (device->open(QIODevice::ReadOnly)) {
+            m_sourceDevice = device;
+            m_mediaPlayer->setSourceDevice(device, QUrl::fromLocalFile(filePath));
+        } else {
+            delete device;
+        }
+    }
+    
+    if (!m_sourceDevice && !isStreamUrl(filePath)) {
+        m_mediaPlayer->setSource(QUrl::fromLocalFile(filePath));
+    }
+    
+    // 播放器已切换到新数据源，释放旧设备
+    if (oldDevice) {
+        oldDevice->deleteLater();
+    }
+    m_displayedFillPercent = -1;
+    
+    // 频谱不延续上一个视频的分析窗口
+    if (m_spectrumAnalyzer) {
+        m_spectrumAnalyzer->reset();
+        m_spectrumView->clear();
+    }
+}
+
+bool MainWindow::ensureStreamProxy()
+{
+    if (!m_streamProxy) {
+        QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/streams";
+        qint64 cacheMaxBytes = qint64(m_settings->value("streamCacheSizeMB", 2048).toLongLong()) * 1024 * 1024;
+        m_streamProxy = new StreamProxy(cacheDirectory, cacheMaxBytes, this);
+    }
+    return m_streamProxy->start();
+}
+
 void MainWindow::changePlaybackRate()
 {
     QString speedText = m_speedComboBox->currentText();
@@ -481,7 +1085,14 @@ void MainWindow::changePlaybackRate()
     bool ok;
     qreal speed = speedText.toDouble(&ok);
     if (ok) {
+        // 内存重放只支持原速
+        if (!qFuzzyCompare(speed, 1.0)) {
+            leaveLoopReplay(true);
+        }
         m_mediaPlayer->setPlaybackRate(speed);
+        if (isGridActive()) {
+            m_gridView->setPlaybackRate(speed);
+        }
     }
 }
 
@@ -497,14 +1108,37 @@ void MainWindow::mediaStatusChanged(QMediaPlayer::MediaStatus status)
     switch (status) {
     case QMediaPlayer::LoadedMedia:
         // 媒体加载完成
+        if (m_traceOpenId) {
+            Tracer::asyncStep("媒体加载完成", m_traceOpenId);
+            m_traceOpenLoaded = true;
+        }
+        if (Metrics::isEnabled()) {
+            m_metricsOpenLoaded = m_metricsOpenTimer.isValid();
+            qreal frameRate = m_mediaPlayer->metaData().value(QMediaMetaData::VideoFrameRate).toReal();
+            m_metricsFrameInterval = frameRate > 0 ? qRound64(1000000 / frameRate) : 0;
+        }
+        if (m_pendingSeekPosition >= 0) {
+            setPlayerPosition(m_pendingSeekPosition);
+            m_pendingSeekPosition = -1;
+        }
+        startChapterDetection();
+        break;
+    case QMediaPlayer::StalledMedia:
+        // 播放中缓冲耗尽
+        Metrics::increment(Metrics::Stalls);
         break;
     case QMediaPlayer::InvalidMedia:
+        Metrics::increment(Metrics::InvalidMedia);
+        m_metricsOpenTimer.invalidate();
+        m_metricsOpenLoaded = false;
         QMessageBox::warning(this, "错误", "无法播放该媒体文件");
         break;
-    case QMediaPlayer::EndOfMedia:
+    case QMediaPlayer::EndOfMedia: {
         // 视频播放完成，自动播放下一个
+        TraceScope scope("播放结束切换");
         playNextVideoAuto();
         break;
+    }
     default:
         break;
     }
@@ -512,12 +1146,24 @@ void MainWindow::mediaStatusChanged(QMediaPlayer::MediaStatus status)
 
 void MainWindow::playbackStateChanged(QMediaPlayer::PlaybackState state)
 {
+    // 暂停、停止或播放结束后不会再有新帧
+    if (m_frameCapture && state != QMediaPlayer::PlayingState) {
+        m_frameCapture->cancelBurst();
+    }
+    if (m_slowMotionView && m_slowMotionView->isActive()) {
+        m_slowMotionView->setPaused(m_mediaPlayer->playbackState() != QMediaPlayer::PlayingState);
+    }
     updatePlayButton();
 }
 
 void MainWindow::updatePlayButton()
 {
-    switch (m_mediaPlayer->playbackState()) {
+    QMediaPlayer::PlaybackState state = isGridActive() ? m_gridView->playbackState()
+                                                       : m_mediaPlayer->playbackState();
+    if (isLoopReplaying()) {
+        state = m_segmentView->isPaused() ? QMediaPlayer::PausedState : QMediaPlayer::PlayingState;
+    }
+    switch (state) {
     case QMediaPlayer::PlayingState:
         m_playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
         break;
@@ -530,23 +1176,9 @@ void MainWindow::updatePlayButton()
 
 void MainWindow::formatTime(qint64 timeInMs, QString &str)
 {
-    qint64 seconds = timeInMs / 1000;
-    qint64 minutes = seconds / 60;
-    qint64 hours = minutes / 60;
-    
-    seconds %= 60;
-    minutes %= 60;
-    
-    if (hours > 0) {
-        str = QString("%1:%2:%3")
-                .arg(hours, 2, 10, QChar('0'))
-                .arg(minutes, 2, 10, QChar('0'))
-                .arg(seconds, 2, 10, QChar('0'));
-    } else {
-        str = QString("%1:%2")
-                .arg(minutes, 2, 10, QChar('0'))
-                .arg(seconds, 2, 10, QChar('0'));
-    }
+    QChar buffer[TimeTextCapacity];
+    int length = formatTimeTo(timeInMs, buffer);
+    str.setUnicode(buffer, length);
 }
 
 void MainWindow::setVolume(int volume)
@@ -554,6 +1186,9 @@ void MainWindow::setVolume(int volume)
     if (m_audioOutput) {
         qreal linearVolume = QAudio::convertVolume(volume / 100.0, QAudio::LogarithmicVolumeScale, QAudio::LinearVolumeScale);
         m_audioOutput->setVolume(linearVolume);
+        if (m_segmentView) {
+            m_segmentView->setVolume(linearVolume);
+        }
     }
 }
 
@@ -561,6 +1196,7 @@ void MainWindow::setVolume(int volume)
 
 void MainWindow::saveSettings()
 {
+    TraceScope scope("保存设置");
     if (m_settings) {
         m_settings->setValue("lastFolder", m_currentFolder);
         m_settings->setValue("volume", m_volumeSlider->value());
@@ -572,13 +1208,11 @@ void MainWindow::saveSettings()
 
 void MainWindow::loadSettings()
 {
+    TraceScope scope("加载设置");
     if (m_settings) {
-        // 加载上次的文件夹
-        QString lastFolder = m_settings->value("lastFolder", "").toString();
-        if (!lastFolder.isEmpty() && QDir(lastFolder).exists()) {
-            m_currentFolder = lastFolder;
-            loadVideosFromFolder(lastFolder);
-        }
+        // 加载上次的文件夹（只记录路径，扫描推迟到首次绘制之后）
+        m_currentFolder = m_settings->value("lastFolder", "").toString();
+        m_restoreLastFolder = true;
         
         // 加载音量设置
         int volume = m_settings->value("volume", 70).toInt();
@@ -598,7 +1232,92 @@ void MainWindow::loadSettings()
         // 加载长按倍速设置
         m_leftKeySpeed = m_settings->value("leftKeySpeed", 2.0).toDouble();
         m_rightKeySpeed = m_settings->value("rightKeySpeed", 2.0).toDouble();
+        
+        // 加载慢速播放插帧设置
+        m_smoothSlowMotion = m_settings->value("smoothSlowMotion", false).toBool();
+        
+        // 加载快速跳转设置
+        m_fastSeek = m_settings->value("fastSeek", false).toBool();
+        
+        // 加载预读缓冲设置
+        m_readAheadEnabled = m_settings->value("readAheadEnabled", false).toBool();
+        
+        // 加载单实例设置（下次启动时生效）
+        m_singleInstanceEnabled = m_settings->value("singleInstance", true).toBool();
+        
+        // 加载A-B循环缓存上限
+        m_loopCacheMB = m_settings->value("loopCacheMB", 512).toInt();
+        
+        // 加载截图格式
+        m_snapshotFormat = m_settings->value("snapshotFormat", "png").toString();
+        
+        // 加载元数据探测同时打开的文件数
+        m_metadataProbeLimit = m_settings->value("metadataProbeLimit", MetadataProber::DefaultMaxOpenFiles).toInt();
+        m_metadataProber->setMaxOpenFiles(m_metadataProbeLimit);
+        
+        // 加载缩略图缓存上限
+        m_thumbnailCacheMB = m_settings->value("thumbnailCacheMB", 256).toInt();
+        m_thumbnailProvider->setCacheBytes(qint64(m_thumbnailCacheMB) * 1024 * 1024);
+        
+        // 加载随机播放和循环模式
+        m_playlistModel->setShuffled(m_settings->value("shuffle", false).toBool());
+        int repeatMode = m_settings->value("repeatMode", PlaybackQueue::RepeatOff).toInt();
+        m_playlistModel->setRepeatMode(PlaybackQueue::RepeatMode(qBound(int(PlaybackQueue::RepeatOff), repeatMode,
+                                                                        int(PlaybackQueue::RepeatOne))));
+        
+        // 加载播放列表排序方式
+        int sortIndex = m_sortComboBox->findData(m_settings->value("playlistSortKey", PlaylistModel::SortByName).toInt());
+        m_sortComboBox->setCurrentIndex(qMax(0, sortIndex));
+        m_sortOrderButton->setChecked(m_settings->value("playlistSortDescending", false).toBool());
+        
+        // 加载频谱显示
+        m_spectrumEnabled = m_settings->value("spectrumVisible", false).toBool();
+    }
+    updateSpectrumVisibility();
+    updateSortOrderButton();
+    updatePlaybackModeButtons();
+}
+
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    
+    // 首次绘制完成后再执行非必需的初始化，让窗口尽快显示出来
+    if (!m_deferredInitScheduled) {
+        m_deferredInitScheduled = true;
+        QTimer::singleShot(0, this, &MainWindow::runDeferredInit);
+    }
+}
+
+void MainWindow::runDeferredInit()
+{
+    StartupProfiler &profiler = StartupProfiler::instance();
+    profiler.mark("首次绘制");
+    
+    // 重新扫描上次的文件夹（网络路径或冷缓存时可能很慢）
+    if (m_restoreLastFolder && !m_currentFolder.isEmpty()) {
+        if (QDir(m_currentFolder).exists()) {
+            loadVideosFromFolder(m_currentFolder);
+        } else {
+            m_currentFolder.clear();
+        }
+    }
+    profiler.mark("扫描上次的文件夹");
+    
+    // 音频设备变化监听
+    // 注意：QMediaDevices在Qt 6中是静态类，需要创建一个实例来连接信号
+    m_mediaDevices = new QMediaDevices(this);
+    connect(m_mediaDevices, &QMediaDevices::audioOutputsChanged, this, &MainWindow::onAudioOutputsChanged);
+    profiler.mark("监听音频设备");
+    
+    // 预先创建并应用样式到设置对话框，避免首次打开时卡顿
+    if (!m_settingsDialog) {
+        m_settingsDialog = new SettingsDialog(this);
+        m_settingsDialog->ensurePolished();
     }
+    profiler.mark("创建设置对话框");
+    
+    profiler.report();
 }
 
 void MainWindow::setupProgressBarClickable()
@@ -609,28 +1328,23 @@ void MainWindow::setupProgressBarClickable()
 
 void MainWindow::playNextVideo()
 {
-    if (m_playlistWidget->count() == 0) {
+    const PlaybackQueue &queue = m_playlistModel->queue();
+    if (queue.isEmpty()) {
         return; // 没有视频列表
     }
     
-    int nextIndex;
-    if (m_currentPlayingIndex == -1 || m_currentPlayingIndex >= m_playlistWidget->count() - 1) {
-        // 如果没有当前播放项目或者是最后一个，播放第一个
-        nextIndex = 0;
-    } else {
-        // 播放下一个
-        nextIndex = m_currentPlayingIndex + 1;
+    // 按播放顺序（顺序或随机）取下一个，最后一个之后回到第一个；
+    // 跳过已不存在的条目（导入的列表不会预先检查文件）
+    PlaybackQueue::ItemId nextId = queue.next(queue.current(), true);
+    int attempts = 0;
+    while (nextId && attempts < queue.count() && !isPlayableEntry(nextId)) {
+        nextId = queue.next(nextId, true);
+        ++attempts;
     }
-    
-    QListWidgetItem *nextItem = m_playlistWidget->item(nextIndex);
-    if (nextItem) {
-        QString filePath = nextItem->data(Qt::UserRole).toString();
-        m_currentPlayingIndex = nextIndex;
-        playVideoFile(filePath);
-        
-        // 高亮当前播放的项目
-        m_playlistWidget->setCurrentItem(nextItem);
+    if (!nextId || attempts == queue.count()) {
+        return;
     }
+    playQueueItem(nextId);
 }
 
 void MainWindow::toggleMute()
@@ -686,6 +1400,41 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
             m_longPressTimer->start();
         }
         break;
+    case Qt::Key_PageUp:
+        jumpToChapter(false);
+        break;
+    case Qt::Key_PageDown:
+        jumpToChapter(true);
+        break;
+    case Qt::Key_BracketLeft:
+        setLoopPoint(true);
+        break;
+    case Qt::Key_BracketRight:
+        setLoopPoint(false);
+        break;
+    case Qt::Key_Backslash:
+        clearLoop();
+        break;
+    case Qt::Key_S:
+        captureFrames(event->modifiers() & Qt::ShiftModifier);
+        break;
+    case Qt::Key_A:
+        toggleSpectrum();
+        break;
+    case Qt::Key_F:
+        if (event->modifiers() & Qt::ControlModifier) {
+            openSubtitleSearch();
+        } else {
+            QMainWindow::keyPressEvent(event);
+        }
+        break;
+    case Qt::Key_T:
+        if (Tracer::isEnabled() && event->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier)) {
+            dumpTrace();
+        } else {
+            QMainWindow::keyPressEvent(event);
+        }
+        break;
     default:
         QMainWindow::keyPressEvent(event);
         break;
@@ -725,11 +1474,17 @@ void MainWindow::onLongPressTimer()
 
 void MainWindow::seekVideo(int seconds)
 {
+    leaveLoopReplay(true);
+    if (isGridActive()) {
+        qint64 newPos = qBound(0LL, m_gridView->position() + seconds * 1000, m_duration);
+        m_gridView->setPosition(newPos);
+        return;
+    }
     if (m_mediaPlayer && m_duration > 0) {
         qint64 currentPos = m_mediaPlayer->position();
         qint64 newPos = currentPos + (seconds * 1000); // 转换为毫秒
         newPos = qBound(0LL, newPos, m_duration);
-        m_mediaPlayer->setPosition(newPos);
+        setPlayerPosition(fastSeekTarget(newPos, currentPos));
     }
 }
 
@@ -752,7 +1507,7 @@ void MainWindow::onContinuousSeekTimer()
         qint64 newPos = currentPos + seekDistance;
         newPos = qBound(0LL, newPos, m_duration);
         
-        m_mediaPlayer->setPosition(newPos);
+        setPlayerPosition(fastSeekTarget(newPos, currentPos));
     }
 }
 
@@ -764,20 +1519,53 @@ void MainWindow::openSettings()
     
     m_settingsDialog->setLeftKeySpeed(m_leftKeySpeed);
     m_settingsDialog->setRightKeySpeed(m_rightKeySpeed);
+    m_settingsDialog->setSmoothSlowMotionEnabled(m_smoothSlowMotion);
+    m_settingsDialog->setFastSeekEnabled(m_fastSeek);
+    m_settingsDialog->setReadAheadEnabled(m_readAheadEnabled);
+    m_settingsDialog->setSingleInstanceEnabled(m_singleInstanceEnabled);
+    m_settingsDialog->setLoopCacheMB(m_loopCacheMB);
+    m_settingsDialog->setSnapshotFormat(m_snapshotFormat);
+    m_settingsDialog->setMetadataProbeLimit(m_metadataProbeLimit);
+    m_settingsDialog->setThumbnailCacheMB(m_thumbnailCacheMB);
     
     if (m_settingsDialog->exec() == QDialog::Accepted) {
         m_leftKeySpeed = m_settingsDialog->getLeftKeySpeed();
         m_rightKeySpeed = m_settingsDialog->getRightKeySpeed();
+        m_smoothSlowMotion = m_settingsDialog->getSmoothSlowMotionEnabled();
+        updateSlowMotion();
+        bool fastSeek = m_settingsDialog->getFastSeekEnabled();
+        if (fastSeek != m_fastSeek) {
+            m_fastSeek = fastSeek;
+            loadKeyframeIndex();
+        }
+        // 预读设置从下一个打开的视频开始生效
+        m_readAheadEnabled = m_settingsDialog->getReadAheadEnabled();
+        m_singleInstanceEnabled = m_settingsDialog->getSingleInstanceEnabled();
+        m_loopCacheMB = m_settingsDialog->getLoopCacheMB();
+        m_snapshotFormat = m_settingsDialog->getSnapshotFormat();
+        m_metadataProbeLimit = m_settingsDialog->getMetadataProbeLimit();
+        m_metadataProber->setMaxOpenFiles(m_metadataProbeLimit);
+        m_thumbnailCacheMB = m_settingsDialog->getThumbnailCacheMB();
+        m_thumbnailProvider->setCacheBytes(qint64(m_thumbnailCacheMB) * 1024 * 1024);
         // 保存设置
         if (m_settings) {
             m_settings->setValue("leftKeySpeed", m_leftKeySpeed);
             m_settings->setValue("rightKeySpeed", m_rightKeySpeed);
+            m_settings->setValue("smoothSlowMotion", m_smoothSlowMotion);
+            m_settings->setValue("fastSeek", m_fastSeek);
+            m_settings->setValue("readAheadEnabled", m_readAheadEnabled);
+            m_settings->setValue("singleInstance", m_singleInstanceEnabled);
+            m_settings->setValue("loopCacheMB", m_loopCacheMB);
+            m_settings->setValue("snapshotFormat", m_snapshotFormat);
+            m_settings->setValue("metadataProbeLimit", m_metadataProbeLimit);
+            m_settings->setValue("thumbnailCacheMB", m_thumbnailCacheMB);
         }
      }
 }
 
 void MainWindow::saveVideoPosition()
 {
+    TraceScope scope("保存播放位置");
     if (m_mediaPlayer && !m_currentVideoHash.isEmpty() && m_duration > 0) {
         qint64 currentPosition = m_mediaPlayer->position();
         // 只有播放超过30秒且不在最后30秒时才保存位置
@@ -819,7 +1607,7 @@ void MainWindow::onPositionDialogFinished()
 {
     if (m_positionDialog && m_positionDialog->shouldJumpToPosition() && m_pendingJumpPosition > 0) {
         // 用户选择跳转到历史位置
-        m_mediaPlayer->setPosition(m_pendingJumpPosition);
+        setPlayerPosition(m_pendingJumpPosition);
     }
     
     m_pendingJumpPosition = -1;
@@ -832,75 +1620,143 @@ void MainWindow::onPositionDialogFinished()
 
 QString MainWindow::getVideoHash(const QString &filePath)
 {
-    QFileInfo fileInfo(filePath);
-    QString hashSource = QString("%1_%2_%3")
-                           .arg(fileInfo.absoluteFilePath())
-                           .arg(fileInfo.size())
-                           .arg(fileInfo.lastModified().toString(Qt::ISODate));
+    return VideoHash::compute(filePath);
+}
+
+void MainWindow::loadChapters()
+{
+    m_chapters.clear();
+    const QVariantList stored = m_settings->value(QString("chapters_%1").arg(m_currentVideoHash)).toList();
+    for (const QVariant &value : stored) {
+        m_chapters.append(value.toLongLong());
+    }
+    updateChapterMarkers();
+}
+
+void MainWindow::startChapterDetection()
+{
+    if (m_chapterScanPath.isEmpty()) {
+        return;
+    }
+    QString filePath = m_chapterScanPath;
+    m_chapterScanPath.clear();
     
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    hash.addData(hashSource.toUtf8());
-    return hash.result().toHex();
+    if (m_sceneDetector && m_sceneDetector->videoHash() == m_currentVideoHash) {
+        return;
+    }
+    if (!m_sceneDetector) {
+        m_sceneDetector = new SceneDetector(this);
+        connect(m_sceneDetector, &SceneDetector::finished, this, &MainWindow::onChapterDetectionFinished);
+    }
+    m_sceneDetector->start(filePath, m_currentVideoHash);
 }
 
-void MainWindow::onVideoWidgetDoubleClicked()
+void MainWindow::onChapterDetectionFinished(const QString &videoHash, const QList<qint64> &cuts)
 {
-    // 双击视频播放区域时切换播放/暂停状态
-    playVideo();
+    // 没有切点也保存空列表，下次打开不再重复分析
+    QVariantList stored;
+    for (qint64 cut : cuts) {
+        stored.append(cut);
+    }
+    m_settings->setValue(QString("chapters_%1").arg(videoHash), stored);
+    
+    if (videoHash == m_currentVideoHash) {
+        m_chapters = cuts;
+        updateChapterMarkers();
+    }
 }
 
-void MainWindow::moveItemUp()
+void MainWindow::updateChapterMarkers()
 {
-    int currentRow = m_playlistWidget->currentRow();
-    if (currentRow > 0) {
-        // 保存当前播放的索引
-        bool wasCurrentPlaying = (currentRow == m_currentPlayingIndex);
-        bool wasAbovePlaying = (currentRow - 1 == m_currentPlayingIndex);
-        
-        // 移动项目
-        QListWidgetItem *item = m_playlistWidget->takeItem(currentRow);
-        m_playlistWidget->insertItem(currentRow - 1, item);
-        m_playlistWidget->setCurrentRow(currentRow - 1);
-        
-        // 更新当前播放索引
-        if (wasCurrentPlaying) {
-            m_currentPlayingIndex = currentRow - 1;
-        } else if (wasAbovePlaying) {
-            m_currentPlayingIndex = currentRow;
+    QList<qreal> markers;
+    if (m_duration > 0 && !isGridActive()) {
+        for (qint64 chapter : m_chapters) {
+            markers.append(qreal(chapter) / m_duration);
         }
     }
+    m_positionSlider->setChapterMarkers(markers);
 }
 
-void MainWindow::moveItemDown()
+void MainWindow::jumpToChapter(bool forward)
 {
-    int currentRow = m_playlistWidget->currentRow();
-    if (currentRow >= 0 && currentRow < m_playlistWidget->count() - 1) {
-        // 保存当前播放的索引
-        bool wasCurrentPlaying = (currentRow == m_currentPlayingIndex);
-        bool wasBelowPlaying = (currentRow + 1 == m_currentPlayingIndex);
-        
-        // 移动项目
-        QListWidgetItem *item = m_playlistWidget->takeItem(currentRow);
-        m_playlistWidget->insertItem(currentRow + 1, item);
-        m_playlistWidget->setCurrentRow(currentRow + 1);
-        
-        // 更新当前播放索引
-        if (wasCurrentPlaying) {
-            m_currentPlayingIndex = currentRow + 1;
-        } else if (wasBelowPlaying) {
-            m_currentPlayingIndex = currentRow;
+    if (!m_mediaPlayer || m_duration <= 0 || isGridActive()) {
+        return;
+    }
+    leaveLoopReplay(true);
+    
+    qint64 position = m_mediaPlayer->position();
+    if (forward) {
+        // 跳过紧挨当前位置的切点，避免刚跳转后重复落在同一章节
+        auto next = std::upper_bound(m_chapters.cbegin(), m_chapters.cend(), position + 500);
+        if (next != m_chapters.cend()) {
+            setPlayerPosition(*next);
         }
+    } else {
+        // 章节开头附近按上一章时跳到前一个章节，与常见播放器一致
+        auto current = std::lower_bound(m_chapters.cbegin(), m_chapters.cend(), position - 2000);
+        setPlayerPosition(current == m_chapters.cbegin() ? 0 : *(current - 1));
     }
 }
 
-void MainWindow::playNextVideoAuto()
+void MainWindow::onVideoWidgetDoubleClicked()
+{
+    // 双击视频播放区域时切换播放/暂停状态
+    playVideo();
+}
+
+void MainWindow::moveItemUp()
 {
-    if (m_playlistWidget->count() == 0) {
+    // 选中的各项分别上移一行，选中状态随模型移动保留
+    QModelIndexList selected = m_playlistView->selectionModel()->selectedRows();
+    std::sort(selected.begin(), selected.end());
+    if (selected.isEmpty() || selected.first().row() == 0) {
         return;
     }
-    
+    QList<int> rows;
+    for (const QModelIndex &index : selected) {
+        rows << index.row();
+    }
+    for (int row : rows) {
+        m_playlistModel->moveRows(QModelIndex(), row, 1, QModelIndex(), row - 1);
+    }
+    m_playlistView->scrollTo(m_playlistModel->index(rows.first() - 1));
+}
+
+void MainWindow::moveItemDown()
+{
+    QModelIndexList selected = m_playlistView->selectionModel()->selectedRows();
+    std::sort(selected.begin(), selected.end());
+    if (selected.isEmpty() || selected.last().row() >= m_playlistModel->rowCount() - 1) {
+        return;
+    }
+    QList<int> rows;
+    for (const QModelIndex &index : selected) {
+        rows << index.row();
+    }
+    // 从下往上移动，避免相邻的选中项互相交换
+    for (auto it = rows.crbegin(); it != rows.crend(); ++it) {
+        m_playlistModel->moveRows(QModelIndex(), *it, 1, QModelIndex(), *it + 2);
+    }
+    m_playlistView->scrollTo(m_playlistModel->index(rows.last() + 1));
+}
+
+void MainWindow::playNextVideoAuto()
+{
+    const PlaybackQueue &queue = m_playlistModel->queue();
+    if (queue.isEmpty()) {
+        return;
+    }
+    
+    // 按播放模式找到下一个可播放的视频，跳过已不存在的条目
+    PlaybackQueue::ItemId nextId = queue.next(queue.current(), false);
+    int attempts = 0;
+    while (nextId && attempts < queue.count() && !isPlayableEntry(nextId)) {
+        nextId = queue.next(nextId, false);
+        ++attempts;
+    }
+    
     // 检查当前播放的是否是最后一个视频
-    if (m_currentPlayingIndex >= m_playlistWidget->count() - 1) {
+    if (!nextId || attempts == queue.count()) {
         // 已经是最后一个视频，显示完成提示
         m_mediaPlayer->stop();
         
@@ -924,15 +1780,7 @@ void MainWindow::playNextVideoAuto()
     }
     
     // 还有下一个视频，自动播放
-    int nextIndex = m_currentPlayingIndex + 1;
-    m_currentPlayingIndex = nextIndex;
-    m_playlistWidget->setCurrentRow(nextIndex);
-    
-    QListWidgetItem *nextItem = m_playlistWidget->item(nextIndex);
-    if (nextItem) {
-        QString filePath = nextItem->data(Qt::UserRole).toString();
-        playVideoFile(filePath);
-    }
+    playQueueItem(nextId);
 }
 
 void MainWindow::onAudioOutputsChanged()
@@ -941,89 +1789,820 @@ void MainWindow::onAudioOutputsChanged()
         return;
     }
     
-    // 保存当前音量和静音状态
-    qreal currentVolume = m_audioOutput->volume();
-    bool wasMuted = m_audioOutput->isMuted();
+    // 插拔麦克风等变化也会触发此信号，只有默认输出设备真的变了才切换
+    QAudioDevice defaultDevice = QMediaDevices::defaultAudioOutput();
+    if (defaultDevice.id() == m_audioDeviceId) {
+        return;
+    }
     
-    // 创建新的音频输出对象（会自动使用系统默认音频设备）
-    QAudioOutput *newAudioOutput = new QAudioOutput(this);
+    // 在原有音频输出上切换设备，播放器不停止解码，音量和静音状态保持不变；
+    // 重新创建QAudioOutput会让后端重建整个音频管线，造成明显的断音
+    QElapsedTimer switchTimer;
+    switchTimer.start();
+    m_audioOutput->setDevice(defaultDevice);
+    m_audioDeviceId = defaultDevice.id();
+    Metrics::increment(Metrics::AudioDeviceChanges);
+    qInfo().noquote() << QString("音频输出切换到 %1，耗时 %2 ms")
+                         .arg(defaultDevice.isNull() ? QString("(无设备)") : defaultDevice.description())
+                         .arg(switchTimer.nsecsElapsed() / 1000000.0, 0, 'f', 2);
+}
+
+void MainWindow::addVideoFile(const QString &filePath)
+{
+    // 检查文件是否存在、是否是支持的视频格式
+    QueueEntry entry;
+    if (!queueEntryForPath(filePath, &entry)) {
+        return;
+    }
     
-    // 恢复音量和静音状态
-    newAudioOutput->setVolume(currentVolume);
-    newAudioOutput->setMuted(wasMuted);
+    // 检查文件是否已经在播放列表中，已存在则不重复添加
+    if (m_playlistModel->containsPath(entry.path)) {
+        return;
+    }
     
-    // 更新媒体播放器的音频输出
-    m_mediaPlayer->setAudioOutput(newAudioOutput);
+    // 添加到播放列表
+    m_playlistModel->append({entry});
+    probePlaylistMetadata({entry.path});
+}
+
+void MainWindow::removeSelectedVideo()
+{
+    QModelIndexList selected = m_playlistView->selectionModel()->selectedRows();
+    if (selected.isEmpty()) {
+        return;
+    }
+    std::sort(selected.begin(), selected.end());
+    QList<int> rows;
+    for (const QModelIndex &index : selected) {
+        rows << index.row();
+    }
     
-    // 删除旧的音频输出对象
-    m_audioOutput->deleteLater();
-    m_audioOutput = newAudioOutput;
+    // 从后往前按连续区间删除，当前播放项只记录编号，其余项无需修正
+    bool hadCurrent = m_playlistModel->queue().current() != 0;
+    for (int end = int(rows.size()) - 1; end >= 0;) {
+        int begin = end;
+        while (begin > 0 && rows.at(begin - 1) == rows.at(begin) - 1) {
+            --begin;
+        }
+        m_playlistModel->removeRows(rows.at(begin), end - begin + 1);
+        end = begin - 1;
+    }
     
-    // 更新音量图标（以防静音状态改变）
-    updateVolumeIcon();
+    // 如果删除了当前播放的视频，停止播放
+    if (hadCurrent && m_playlistModel->queue().current() == 0) {
+        m_mediaPlayer->stop();
+        setWindowTitle("视频播放器");
+    }
 }
 
-void MainWindow::addVideoFile(const QString &filePath)
+void MainWindow::importPlaylist()
 {
-    if (!QFileInfo::exists(filePath)) {
+    QString filePath = QFileDialog::getOpenFileName(this, "导入播放列表", m_currentFolder,
+                                                    "播放列表 (*.m3u *.m3u8);;所有文件 (*.*)");
+    if (filePath.isEmpty()) {
         return;
     }
     
-    QFileInfo fileInfo(filePath);
+    // 新的导入会取代尚未完成的导入
+    delete m_playlistReader;
+    m_playlistReader = new M3uReader(filePath);
+    if (!m_playlistReader->open()) {
+        QMessageBox::warning(this, "错误", QString("无法打开播放列表: %1").arg(m_playlistReader->errorString()));
+        delete m_playlistReader;
+        m_playlistReader = nullptr;
+        return;
+    }
+    
+    m_importButton->setEnabled(false);
+    importNextBatch();
+}
+
+void MainWindow::importNextBatch()
+{
+    if (!m_playlistReader) {
+        return;
+    }
     
-    // 检查是否是支持的视频格式
-    QStringList supportedExtensions = {"mp4", "avi", "mkv", "mov", "wmv", "flv", "webm", "m4v", "3gp", "ts", "mts"};
-    if (!supportedExtensions.contains(fileInfo.suffix().toLower())) {
+    // 每批插入一部分条目后回到事件循环，导入大列表时界面保持响应
+    const int batchSize = 500;
+    const QList<M3uEntry> entries = m_playlistReader->readBatch(batchSize);
+    QList<QueueEntry> queueEntries;
+    QStringList paths;
+    for (const M3uEntry &entry : entries) {
+        if (m_playlistModel->containsPath(entry.path)) {
+            continue;
+        }
+        
+        QueueEntry queueEntry;
+        queueEntry.path = entry.path;
+        queueEntry.title = entry.title;
+        if (queueEntry.title.isEmpty()) {
+            queueEntry.title = isStreamUrl(entry.path) ? QUrl(entry.path).fileName() : QFileInfo(entry.path).fileName();
+        }
+        queueEntry.durationMs = entry.durationMs;
+        queueEntries.append(queueEntry);
+        paths << entry.path;
+    }
+    // 同一批中重复的路径由模型去重
+    m_playlistModel->append(queueEntries);
+    probePlaylistMetadata(paths);
+    
+    if (m_playlistReader->atEnd()) {
+        delete m_playlistReader;
+        m_playlistReader = nullptr;
+        m_importButton->setEnabled(true);
+        return;
+    }
+    QTimer::singleShot(0, this, &MainWindow::importNextBatch);
+}
+
+void MainWindow::exportPlaylist()
+{
+    if (m_playlistModel->rowCount() == 0) {
+        return;
+    }
+    
+    QString filePath = QFileDialog::getSaveFileName(this, "导出播放列表", m_currentFolder + "/playlist.m3u8",
+                                                    "播放列表 (*.m3u8)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    
+    M3uWriter writer(filePath);
+    if (!writer.open()) {
+        QMessageBox::warning(this, "错误", QString("无法写入播放列表: %1").arg(writer.errorString()));
+        return;
+    }
+    
+    const PlaybackQueue &queue = m_playlistModel->queue();
+    const QList<PlaybackQueue::ItemId> ids = queue.ids();
+    for (PlaybackQueue::ItemId id : ids) {
+        const QueueEntry &queueEntry = queue.entry(id);
+        M3uEntry entry;
+        entry.path = queueEntry.path;
+        entry.title = queueEntry.title;
+        entry.durationMs = queueEntry.durationMs;
+        if (entry.durationMs < 0) {
+            const MediaInfo *info = m_metadataProber->info(entry.path);
+            entry.durationMs = info ? info->durationMs : -1;
+        }
+        writer.writeEntry(entry);
+    }
+    
+    if (!writer.close()) {
+        QMessageBox::warning(this, "错误", QString("写入播放列表失败: %1").arg(writer.errorString()));
+    }
+}
+
+void MainWindow::probePlaylistMetadata(const QStringList &paths)
+{
+    // 网络视频不探测，打开网络地址代价较高
+    QStringList localPaths;
+    localPaths.reserve(paths.size());
+    for (const QString &path : paths) {
+        if (!isStreamUrl(path)) {
+            localPaths << path;
+        }
+    }
+    m_metadataProber->enqueue(localPaths);
+    m_visibleRowsTimer->start();
+}
+
+void MainWindow::updateVisibleProbes()
+{
+    int rowCount = m_playlistModel->rowCount();
+    if (rowCount == 0) {
+        m_metadataProber->setVisible(QStringList());
+        m_thumbnailProvider->setVisible(QStringList());
+        return;
+    }
+    
+    // 可见范围上下各多取一些行，滚动一小段时也能立即显示
+    const int prefetchRows = 10;
+    QModelIndex first = m_playlistView->indexAt(QPoint(0, 0));
+    QModelIndex last = m_playlistView->indexAt(QPoint(0, m_playlistView->viewport()->height() - 1));
+    int firstRow = qMax(0, (first.isValid() ? first.row() : 0) - prefetchRows);
+    int lastRow = qMin(rowCount - 1, (last.isValid() ? last.row() : rowCount - 1) + prefetchRows);
+    
+    QStringList visiblePaths;
+    QStringList onScreenPaths;
+    int firstOnScreen = first.isValid() ? first.row() : 0;
+    int lastOnScreen = last.isValid() ? last.row() : rowCount - 1;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        QString filePath = m_playlistModel->pathAt(row);
+        if (!isStreamUrl(filePath)) {
+            visiblePaths << filePath;
+            if (row >= firstOnScreen && row <= lastOnScreen) {
+                onScreenPaths << filePath;
+            }
+        }
+    }
+    m_metadataProber->setVisible(visiblePaths);
+    
+    // 缩略图需要解码，只为屏幕上的行生成，内存中也只保留这些行的
+    m_thumbnailProvider->setVisible(onScreenPaths);
+}
+
+bool MainWindow::isPlayableEntry(PlaybackQueue::ItemId id)
+{
+    if (!m_playlistModel->queue().contains(id)) {
+        return false;
+    }
+    
+    QString filePath = m_playlistModel->queue().entry(id).path;
+    if (isStreamUrl(filePath) || QFileInfo::exists(filePath)) {
+        return true;
+    }
+    
+    // 标记为不存在（灰色显示），播放时不再尝试
+    m_playlistModel->setMissing(id);
+    return false;
+}
+
+void MainWindow::toggleShuffle()
+{
+    m_playlistModel->setShuffled(m_shuffleButton->isChecked());
+    if (m_settings) {
+        m_settings->setValue("shuffle", m_shuffleButton->isChecked());
+    }
+    updatePlaybackModeButtons();
+}
+
+void MainWindow::cycleRepeatMode()
+{
+    // 顺序播放 -> 列表循环 -> 单个循环 -> 顺序播放
+    PlaybackQueue::RepeatMode mode;
+    switch (m_playlistModel->queue().repeatMode()) {
+    case PlaybackQueue::RepeatOff:
+        mode = PlaybackQueue::RepeatAll;
+        break;
+    case PlaybackQueue::RepeatAll:
+        mode = PlaybackQueue::RepeatOne;
+        break;
+    default:
+        mode = PlaybackQueue::RepeatOff;
+        break;
+    }
+    m_playlistModel->setRepeatMode(mode);
+    if (m_settings) {
+        m_settings->setValue("repeatMode", int(mode));
+    }
+    updatePlaybackModeButtons();
+}
+
+void MainWindow::sortPlaylist()
+{
+    PlaylistModel::SortKey sortKey = PlaylistModel::SortKey(m_sortComboBox->currentData().toInt());
+    Qt::SortOrder sortOrder = m_sortOrderButton->isChecked() ? Qt::DescendingOrder : Qt::AscendingOrder;
+    if (m_settings) {
+        m_settings->setValue("playlistSortKey", int(sortKey));
+        m_settings->setValue("playlistSortDescending", sortOrder == Qt::DescendingOrder);
+    }
+    // 手动排序时重新读取文件信息，打开列表之后被修改过的文件也能排对
+    m_playlistModel->refreshFileStats();
+    m_playlistModel->sortBy(sortKey, sortOrder);
+    
+    QModelIndex current = m_playlistView->currentIndex();
+    if (current.isValid()) {
+        m_playlistView->scrollTo(current);
+    }
+}
+
+void MainWindow::toggleSortOrder()
+{
+    updateSortOrderButton();
+    sortPlaylist();
+}
+
+void MainWindow::updateSortOrderButton()
+{
+    bool descending = m_sortOrderButton->isChecked();
+    m_sortOrderButton->setText(descending ? "↓" : "↑");
+    m_sortOrderButton->setToolTip(descending ? "降序" : "升序");
+}
+
+void MainWindow::updatePlaybackModeButtons()
+{
+    const PlaybackQueue &queue = m_playlistModel->queue();
+    m_shuffleButton->setChecked(queue.isShuffled());
+    switch (queue.repeatMode()) {
+    case PlaybackQueue::RepeatAll:
+        m_repeatButton->setText("↻");
+        m_repeatButton->setToolTip("列表循环");
+        break;
+    case PlaybackQueue::RepeatOne:
+        m_repeatButton->setText("↻1");
+        m_repeatButton->setToolTip("单个循环");
+        break;
+    default:
+        m_repeatButton->setText("→");
+        m_repeatButton->setToolTip("顺序播放");
+        break;
+    }
+}
+
+void MainWindow::loadSubtitles(const QString &videoPath)
+{
+    m_subtitleTrack.clear();
+    m_activeSubtitleCues.clear();
+    m_videoWidget->videoSink()->setSubtitleText(QString());
+    
+    if (isStreamUrl(videoPath)) {
+        return;
+    }
+    QString subtitlePath = SubtitleTrack::findSidecar(videoPath);
+    if (!subtitlePath.isEmpty() && !m_subtitleTrack.load(subtitlePath)) {
+        qWarning() << "无法加载字幕" << subtitlePath << m_subtitleTrack.errorString();
+    }
+}
+
+void MainWindow::updateSubtitleText()
+{
+    if (m_subtitleTrack.isEmpty()) {
+        return;
+    }
+    
+    // 当前字幕集合未变化时不重新设置文本，避免视频输出重新排版
+    QList<int> active = m_subtitleTrack.activeCues(m_lastPosition);
+    if (active == m_activeSubtitleCues) {
+        return;
+    }
+    m_activeSubtitleCues = active;
+    
+    QStringList lines;
+    for (int index : std::as_const(active)) {
+        lines << m_subtitleTrack.cue(index).text;
+    }
+    m_videoWidget->videoSink()->setSubtitleText(lines.join('\n'));
+}
+
+bool MainWindow::isGridActive() const
+{
+    return m_gridView && m_videoStack->currentWidget() == m_gridView;
+}
+
+void MainWindow::toggleGridMode()
+{
+    if (isGridActive()) {
+        exitGridMode();
         return;
     }
     
-    // 检查文件是否已经在播放列表中
-    for (int i = 0; i < m_playlistWidget->count(); ++i) {
-        QListWidgetItem *existingItem = m_playlistWidget->item(i);
-        if (existingItem && existingItem->data(Qt::UserRole).toString() == filePath) {
-            // 文件已存在，不重复添加
+    bool ok;
+    int tileCount = QInputDialog::getInt(this, "宫格播放", "同时播放的视频数量:", 4,
+                                         GridPlaybackView::MinTiles, GridPlaybackView::MaxTiles, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    // 从选中的条目开始依次取本地视频，跳过网络地址和已不存在的文件
+    QStringList filePaths;
+    int startRow = qMax(0, m_playlistView->currentIndex().row());
+    for (int row = startRow; row < m_playlistModel->rowCount() && filePaths.size() < tileCount; ++row) {
+        QString filePath = m_playlistModel->pathAt(row);
+        if (!isStreamUrl(filePath) && isPlayableEntry(m_playlistModel->idAt(row))) {
+            filePaths << filePath;
+        }
+    }
+    if (filePaths.size() < GridPlaybackView::MinTiles) {
+        QMessageBox::information(this, "宫格播放", "从选中位置开始至少需要两个本地视频");
+        return;
+    }
+    
+    if (!m_gridView) {
+        m_gridView = new GridPlaybackView();
+        m_videoStack->addWidget(m_gridView);
+        connect(m_gridView, &GridPlaybackView::positionChanged, this, &MainWindow::updatePosition);
+        connect(m_gridView, &GridPlaybackView::durationChanged, this, &MainWindow::updateDuration);
+        connect(m_gridView, &GridPlaybackView::playbackStateChanged, this, &MainWindow::playbackStateChanged);
+        connect(m_gridView, &GridPlaybackView::tileActivated, this, &MainWindow::onGridTileActivated);
+    }
+    
+    clearLoop();
+    m_mediaPlayer->pause();
+    m_videoStack->setCurrentWidget(m_gridView);
+    updateSlowMotion();
+    m_waveformStrip->setVisible(false);
+    updateSpectrumVisibility();
+    m_gridView->setSources(filePaths);
+    m_gridView->setPlaybackRate(m_mediaPlayer->playbackRate());
+    m_gridView->play();
+    m_gridButton->setText("退出宫格");
+    updateChapterMarkers();
+}
+
+void MainWindow::exitGridMode()
+{
+    if (!isGridActive()) {
+        return;
+    }
+    m_gridView->clear();
+    m_videoStack->setCurrentWidget(m_videoWidget);
+    updateSlowMotion();
+    m_waveformStrip->setVisible(true);
+    updateSpectrumVisibility();
+    m_gridButton->setText("宫格播放");
+    
+    // 恢复单视频的进度显示
+    updateDuration(m_mediaPlayer->duration());
+    updatePosition(m_mediaPlayer->position());
+    updatePlayButton();
+}
+
+void MainWindow::onGridTileActivated(const QString &filePath)
+{
+    // 双击格子时退出宫格，单独播放该视频
+    selectPlaylistPath(filePath);
+    playVideoFile(filePath);
+}
+
+void MainWindow::openSubtitleSearch()
+{
+    if (!m_subtitleSearchDialog) {
+        QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/subtitle-index";
+        m_subtitleIndex = new SubtitleIndex(cacheDirectory, this);
+        m_subtitleSearchDialog = new SubtitleSearchDialog(this);
+        connect(m_subtitleSearchDialog, &SubtitleSearchDialog::searchRequested, this, [this](const QString &query) {
+            m_subtitleIndex->search(query);
+        });
+        connect(m_subtitleIndex, &SubtitleIndex::searchFinished, m_subtitleSearchDialog, &SubtitleSearchDialog::setResults);
+        connect(m_subtitleIndex, &SubtitleIndex::indexingProgress, m_subtitleSearchDialog, &SubtitleSearchDialog::setIndexingProgress);
+        connect(m_subtitleSearchDialog, &SubtitleSearchDialog::hitActivated, this, &MainWindow::onSubtitleHitActivated);
+    }
+    
+    // 每次打开时按当前播放列表增量更新索引，未修改的字幕直接使用缓存
+    QStringList videoPaths;
+    const QStringList playlistPaths = m_playlistModel->paths();
+    videoPaths.reserve(playlistPaths.size());
+    for (const QString &filePath : playlistPaths) {
+        if (!isStreamUrl(filePath)) {
+            videoPaths << filePath;
+        }
+    }
+    m_subtitleIndex->setVideos(videoPaths);
+    
+    m_subtitleSearchDialog->show();
+    m_subtitleSearchDialog->raise();
+    m_subtitleSearchDialog->activateWindow();
+}
+
+void MainWindow::onSubtitleHitActivated(const QString &videoPath, qint64 startMs)
+{
+    // 已在播放该视频时直接跳转
+    if (!isGridActive() && getVideoHash(videoPath) == m_currentVideoHash
+        && m_mediaPlayer->mediaStatus() != QMediaPlayer::LoadingMedia) {
+        setPlayerPosition(startMs);
+        return;
+    }
+    
+    selectPlaylistPath(videoPath);
+    playVideoFile(videoPath);
+    
+    // 跳转目标由搜索结果决定，不再询问是否恢复历史位置
+    if (m_positionDialog) {
+        m_positionDialog->disconnect(this);
+        m_positionDialog->close();
+        m_positionDialog->deleteLater();
+        m_positionDialog = nullptr;
+        m_pendingJumpPosition = -1;
+    }
+    m_pendingSeekPosition = startMs;
+}
+
+void MainWindow::openDuplicateFinder()
+{
+    if (!m_duplicateDialog) {
+        QString cacheFile = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/phash.dat";
+        m_duplicateFinder = new DuplicateFinder(cacheFile, this);
+        m_duplicateDialog = new DuplicateFinderDialog(this);
+        connect(m_duplicateDialog, &DuplicateFinderDialog::startRequested, this, [this]() {
+            // 只对比本地文件，网络视频无法快速定位抽帧
+            QStringList videoPaths;
+            const QStringList playlistPaths = m_playlistModel->paths();
+            videoPaths.reserve(playlistPaths.size());
+            for (const QString &filePath : playlistPaths) {
+                if (!isStreamUrl(filePath)) {
+                    videoPaths << filePath;
+                }
+            }
+            m_duplicateFinder->start(videoPaths);
+        });
+        connect(m_duplicateDialog, &DuplicateFinderDialog::cancelRequested, m_duplicateFinder, &DuplicateFinder::cancel);
+        connect(m_duplicateFinder, &DuplicateFinder::progress, m_duplicateDialog, &DuplicateFinderDialog::setProgress);
+        connect(m_duplicateFinder, &DuplicateFinder::finished, m_duplicateDialog, &DuplicateFinderDialog::setGroups);
+        connect(m_duplicateDialog, &DuplicateFinderDialog::fileActivated, this, &MainWindow::onGridTileActivated);
+    }
+    
+    m_duplicateDialog->show();
+    m_duplicateDialog->raise();
+    m_duplicateDialog->activateWindow();
+}
+
+void MainWindow::setLoopPoint(bool isStart)
+{
+    if (isGridActive() || m_duration <= 0) {
+        return;
+    }
+    leaveLoopReplay(true);
+    
+    qint64 position = m_mediaPlayer->position();
+    if (isStart) {
+        m_loopStart = position;
+        if (m_loopEnd <= m_loopStart) {
+            m_loopEnd = -1;
+        }
+    } else {
+        // 太短的区间没有意义
+        if (m_loopStart < 0 || position <= m_loopStart + 200) {
             return;
         }
+        m_loopEnd = position;
     }
     
-    // 添加到播放列表
-    QListWidgetItem *item = new QListWidgetItem(fileInfo.fileName());
-    item->setData(Qt::UserRole, fileInfo.absoluteFilePath());
-    item->setToolTip(fileInfo.absoluteFilePath());
-    m_playlistWidget->addItem(item);
+    if (m_loopStart >= 0 && m_loopEnd > 0) {
+        startLoopCapture();
+    }
+    updateLoopMarkers();
 }
 
-void MainWindow::removeSelectedVideo()
+void MainWindow::clearLoop()
+{
+    leaveLoopReplay(true);
+    m_loopStart = -1;
+    m_loopEnd = -1;
+    if (m_segmentCache) {
+        m_segmentCache->clear();
+    }
+    m_loopAudioTap = false;
+    updateAudioTap();
+    updateLoopMarkers();
+}
+
+void MainWindow::startLoopCapture()
+{
+    if (!m_segmentCache) {
+        m_segmentCache = new SegmentCache(this);
+        connect(m_segmentCache, &SegmentCache::ready, this, &MainWindow::onSegmentCacheReady);
+        connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame) {
+            if (m_segmentCache->isCapturing()) {
+                m_segmentCache->addFrame(frame);
+            }
+        });
+    }
+    // 只在原速播放且上次没有超出预算时收集，否则每圈跳回A点
+    bool wasOverBudget = m_segmentCache->isOverBudget()
+                         && m_segmentCache->startMs() == m_loopStart && m_segmentCache->endMs() == m_loopEnd;
+    if (wasOverBudget || !qFuzzyCompare(m_mediaPlayer->playbackRate(), 1.0)) {
+        m_loopAudioTap = false;
+    } else {
+        QSize frameSize = (QSizeF(m_videoWidget->size()) * m_videoWidget->devicePixelRatioF()).toSize();
+        m_segmentCache->begin(m_loopStart, m_loopEnd, qint64(m_loopCacheMB) * 1024 * 1024, frameSize);
+        m_loopAudioTap = true;
+    }
+    updateAudioTap();
+    setPlayerPosition(m_loopStart);
+}
+
+void MainWindow::updateLoopMarkers()
+{
+    if (m_duration > 0 && m_loopStart >= 0) {
+        qreal end = m_loopEnd > 0 ? qreal(m_loopEnd) / m_duration : -1;
+        m_positionSlider->setLoopRange(qreal(m_loopStart) / m_duration, end);
+    } else {
+        m_positionSlider->setLoopRange(-1, -1);
+    }
+}
+
+bool MainWindow::isLoopReplaying() const
+{
+    return m_segmentView && m_segmentView->isActive();
+}
+
+void MainWindow::onSegmentCacheReady()
+{
+    // 帧转换晚于到达B点完成时，播放器已经跳回A点附近，从这里切换到内存重放
+    if (m_loopEnd > 0 && !isLoopReplaying() && !isGridActive()
+        && m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState
+        && m_mediaPlayer->position() < m_loopStart + 500) {
+        startLoopReplay();
+    }
+}
+
+void MainWindow::startLoopReplay()
+{
+    if (!m_segmentView) {
+        m_segmentView = new SegmentPlaybackView();
+        m_videoStack->addWidget(m_segmentView);
+        connect(m_segmentView, &SegmentPlaybackView::positionChanged, this, [this](qint64 position) {
+            m_lastPosition = position;
+            m_uiRefreshScheduler->requestRefresh();
+        });
+    }
+    
+    // 解码器停在A点，重放期间不再读取和解码
+    m_loopAudioTap = false;
+    updateAudioTap();
+    m_mediaPlayer->pause();
+    setPlayerPosition(m_loopStart);
+    
+    qreal volume = m_audioOutput->isMuted() ? 0.0 : m_audioOutput->volume();
+    m_segmentView->start(m_segmentCache, volume);
+    m_videoStack->setCurrentWidget(m_segmentView);
+    updatePlayButton();
+}
+
+void MainWindow::leaveLoopReplay(bool resumePlayback)
 {
-    int currentRow = m_playlistWidget->currentRow();
-    if (currentRow < 0) {
+    if (!isLoopReplaying()) {
+        return;
+    }
+    bool wasPlaying = !m_segmentView->isPaused();
+    m_segmentView->stop();
+    m_videoStack->setCurrentWidget(m_videoWidget);
+    updateSlowMotion();
+    
+    // 从重放到达的位置继续用播放器播放，缓存保留给下一圈
+    setPlayerPosition(m_lastPosition);
+    if (resumePlayback && wasPlaying) {
+        m_mediaPlayer->play();
+    }
+    updatePlayButton();
+}
+
+void MainWindow::updateSlowMotion()
+{
+    // 宫格和A-B循环内存重放有各自的画面，不参与插帧
+    qreal rate = m_mediaPlayer->playbackRate();
+    bool active = m_smoothSlowMotion && rate < 1.0 && m_mediaPlayer->hasVideo()
+                  && !isGridActive() && !isLoopReplaying();
+    if (!active) {
+        if (m_slowMotionView && m_slowMotionView->isActive()) {
+            m_slowMotionView->stop();
+            if (m_videoStack->currentWidget() == m_slowMotionView) {
+                m_videoStack->setCurrentWidget(m_videoWidget);
+            }
+        }
         return;
     }
     
-    // 如果要删除的是当前播放的视频
-    bool wasCurrentPlaying = (currentRow == m_currentPlayingIndex);
+    if (!m_slowMotionView) {
+        m_slowMotionView = new SlowMotionView();
+        m_videoStack->addWidget(m_slowMotionView);
+        connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, m_slowMotionView, &SlowMotionView::addFrame);
+    }
+    if (m_slowMotionView->isActive()) {
+        m_slowMotionView->setPlaybackRate(rate);
+    } else {
+        m_videoStack->setCurrentWidget(m_slowMotionView);
+        m_slowMotionView->start(rate);
+    }
+    m_slowMotionView->setPaused(m_mediaPlayer->playbackState() != QMediaPlayer::PlayingState);
+}
+
+void MainWindow::updateAudioTap()
+{
+    // 两者都不需要时断开，解码时不再复制PCM
+    bool spectrumShown = m_spectrumView && !m_spectrumView->isHidden();
+    bool needed = m_loopAudioTap || spectrumShown;
+    if (needed && !m_audioBufferOutput) {
+        m_audioBufferOutput = new QAudioBufferOutput(this);
+        connect(m_audioBufferOutput, &QAudioBufferOutput::audioBufferReceived, this, [this](const QAudioBuffer &buffer) {
+            if (m_segmentCache && m_segmentCache->isCapturing()) {
+                m_segmentCache->addAudio(buffer);
+            }
+            if (m_spectrumView && !m_spectrumView->isHidden()) {
+                m_spectrumAnalyzer->addBuffer(buffer);
+            }
+        });
+    }
+    QAudioBufferOutput *output = needed ? m_audioBufferOutput : nullptr;
+    if (m_mediaPlayer->audioBufferOutput() != output) {
+        m_mediaPlayer->setAudioBufferOutput(output);
+    }
+}
+
+void MainWindow::toggleSpectrum()
+{
+    m_spectrumEnabled = !m_spectrumEnabled;
+    if (m_settings) {
+        m_settings->setValue("spectrumVisible", m_spectrumEnabled);
+    }
+    updateSpectrumVisibility();
+}
+
+void MainWindow::updateSpectrumVisibility()
+{
+    // 宫格播放时没有单一的音频来源，不显示频谱
+    bool visible = m_spectrumEnabled && !isGridActive();
+    if (visible && !m_spectrumView) {
+        m_spectrumAnalyzer = new SpectrumAnalyzer(this);
+        m_spectrumView = new SpectrumView(m_spectrumAnalyzer);
+        m_spectrumView->setVisible(false);
+        // 放在画面和控制栏之间
+        QVBoxLayout *videoLayout = qobject_cast<QVBoxLayout *>(m_videoContainer->layout());
+        videoLayout->insertWidget(videoLayout->indexOf(m_controlsWidget), m_spectrumView);
+    }
+    if (!m_spectrumView || visible == !m_spectrumView->isHidden()) {
+        updateAudioTap();
+        return;
+    }
+    if (visible) {
+        m_spectrumAnalyzer->reset();
+        m_spectrumView->clear();
+    }
+    m_spectrumView->setVisible(visible);
+    updateAudioTap();
+}
+
+void MainWindow::captureFrames(bool burst)
+{
+    if (isGridActive() || isLoopReplaying() || m_currentVideoHash.isEmpty()) {
+        return;
+    }
     
-    // 删除项目
-    QListWidgetItem *item = m_playlistWidget->takeItem(currentRow);
-    if (item) {
-        delete item;
+    if (!m_frameCapture) {
+        m_frameCapture = new FrameCapture(this);
+        m_frameCapture->setOutputDirectory(
+            QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) + "/VideoPlayer");
+        connect(m_frameCapture, &FrameCapture::saved, this, [this](const QString &filePath) {
+            if (!m_frameCapture->isBurstActive()) {
+                QToolTip::showText(m_videoWidget->mapToGlobal(QPoint(20, 20)),
+                                   QString("已保存截图: %1").arg(QFileInfo(filePath).fileName()),
+                                   m_videoWidget, QRect(), 2000);
+            }
+        });
+        connect(m_frameCapture, &FrameCapture::failed, this, [this](const QString &filePath) {
+            QToolTip::showText(m_videoWidget->mapToGlobal(QPoint(20, 20)),
+                               QString("截图保存失败: %1").arg(filePath), m_videoWidget, QRect(), 3000);
+        });
+        connect(m_frameCapture, &FrameCapture::burstFinished, this, [this](int savedCount, int frameCount) {
+            QToolTip::showText(m_videoWidget->mapToGlobal(QPoint(20, 20)),
+                               QString("连拍完成: %1/%2 张，保存在 %3").arg(savedCount).arg(frameCount)
+                                   .arg(QDir::toNativeSeparators(m_frameCapture->outputDirectory())),
+                               m_videoWidget, QRect(), 3000);
+        });
     }
+    m_frameCapture->setFormat(m_snapshotFormat);
     
-    // 更新当前播放索引
-    if (wasCurrentPlaying) {
-        // 如果删除的是当前播放的视频，停止播放
-        m_mediaPlayer->stop();
-        m_currentPlayingIndex = -1;
-        setWindowTitle("视频播放器");
-    } else if (m_currentPlayingIndex > currentRow) {
-        // 如果删除的视频在当前播放视频之前，索引需要减1
-        m_currentPlayingIndex--;
+    QString baseName = QFileInfo(m_currentVideoPath).completeBaseName();
+    if (baseName.isEmpty()) {
+        baseName = "snapshot";
     }
     
-    // 如果播放列表为空，重置状态
-    if (m_playlistWidget->count() == 0) {
-        m_currentPlayingIndex = -1;
-        m_mediaPlayer->stop();
-        setWindowTitle("视频播放器");
+    // 暂停时没有新帧，连拍退化为单张截图
+    if (burst && m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        m_frameCapture->startBurst(m_videoWidget->videoSink(), baseName);
+    } else {
+        m_frameCapture->snapshot(m_videoWidget->videoSink(), baseName);
+    }
+}
+
+void MainWindow::onWaveformReady(const QString &videoHash, const WaveformPeaks &peaks)
+{
+    if (videoHash == m_currentVideoHash) {
+        m_waveformStrip->setPeaks(peaks);
+    }
+}
+
+void MainWindow::onWaveformSeekRequested(qint64 position)
+{
+    if (isGridActive()) {
+        return;
+    }
+    leaveLoopReplay(true);
+    setPlayerPosition(fastSeekTarget(position));
+}
+
+void MainWindow::loadKeyframeIndex()
+{
+    // 索引只在开启快速跳转时建立，网络流无法随机读取文件
+    m_keyframes.clear();
+    if (!m_fastSeek || m_currentVideoPath.isEmpty() || isStreamUrl(m_currentVideoPath)) {
+        if (m_keyframeIndexer) {
+            m_keyframeIndexer->cancel();
+        }
+        return;
+    }
+    if (!m_keyframeIndexer) {
+        QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/keyframes";
+        m_keyframeIndexer = new KeyframeIndexer(cacheDirectory, this);
+        connect(m_keyframeIndexer, &KeyframeIndexer::ready, this, &MainWindow::onKeyframeIndexReady);
+    }
+    m_keyframeIndexer->load(m_currentVideoPath, m_currentVideoHash);
+}
+
+void MainWindow::onKeyframeIndexReady(const QString &videoHash, const QList<qint64> &keyframes)
+{
+    if (videoHash == m_currentVideoHash && m_fastSeek) {
+        m_keyframes = keyframes;
+    }
+}
+
+qint64 MainWindow::fastSeekTarget(qint64 position, qint64 from) const
+{
+    // 索引尚未建立或容器不支持时按原位置精确跳转
+    if (!m_fastSeek || m_keyframes.isEmpty()) {
+        return position;
     }
+    return qBound(0LL, KeyframeIndex::snap(m_keyframes, position, from), m_duration);
 }
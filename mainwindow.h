@@ -4,13 +4,14 @@
 #include <QMainWindow>
 #include <QMediaPlayer>
 #include <QVideoWidget>
+#include <QVideoFrame>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QSplitter>
 #include <QPushButton>
 #include <QSlider>
 #include <QLabel>
-#include <QListWidget>
+#include <QListView>
 #include <QComboBox>
 #include <QFileDialog>
 #include <QDir>
@@ -27,8 +28,41 @@
 #include <QCryptographicHash>
 #include <QAbstractItemView>
 #include <QMediaDevices>
+#include <QAudioDevice>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QDropEvent>
+#include <algorithm>
+#include <QPainter>
+#include <QStackedWidget>
+#include <QAudioBufferOutput>
 #include "settingsdialog.h"
 #include "positiondialog.h"
+#include "uirefreshscheduler.h"
+#include "readaheaddevice.h"
+#include "streamproxy.h"
+#include "playlistio.h"
+#include "playlistmodel.h"
+#include "scenedetector.h"
+#include "gridplaybackview.h"
+#include "subtitletrack.h"
+#include "subtitleindex.h"
+#include "subtitlesearchdialog.h"
+#include "segmentcache.h"
+#include "segmentplaybackview.h"
+#include "framecapture.h"
+#include "waveformgenerator.h"
+#include "waveformstrip.h"
+#include "duplicatefinder.h"
+#include "duplicatefinderdialog.h"
+#include "metadataprober.h"
+#include "playlistdelegate.h"
+#include "thumbnailprovider.h"
+#include "tracer.h"
+#include "spectrumanalyzer.h"
+#include "spectrumview.h"
+#include "slowmotionview.h"
+#include "keyframeindex.h"
 
 // 自定义进度条类，支持点击定位
 class ClickableSlider : public QSlider
@@ -38,7 +72,43 @@ public:
     explicit ClickableSlider(Qt::Orientation orientation, QWidget *parent = nullptr)
         : QSlider(orientation, parent) {}
 
+    // 设置章节标记（相对位置 0.0 - 1.0）
+    void setChapterMarkers(const QList<qreal> &markers)
+    {
+        m_chapterMarkers = markers;
+        update();
+    }
+
+    // 设置A-B循环区间（相对位置，start < 0 表示没有区间）
+    void setLoopRange(qreal start, qreal end)
+    {
+        m_loopStart = start;
+        m_loopEnd = end;
+        update();
+    }
+
 protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        QSlider::paintEvent(event);
+        if (m_chapterMarkers.isEmpty() && m_loopStart < 0) {
+            return;
+        }
+        // 标记位置与点击跳转使用相同的线性映射
+        QPainter painter(this);
+        if (m_loopStart >= 0) {
+            int startX = qRound(m_loopStart * width());
+            int endX = m_loopEnd > m_loopStart ? qRound(m_loopEnd * width()) : startX + 2;
+            painter.fillRect(QRect(startX, height() / 2 - 4, endX - startX, 8), QColor(0, 200, 83, 120));
+        }
+        painter.setPen(QPen(QColor("#ffa500"), 2));
+        int centerY = height() / 2;
+        for (qreal marker : m_chapterMarkers) {
+            int x = qRound(marker * width());
+            painter.drawLine(x, centerY - 6, x, centerY + 6);
+        }
+    }
+
     void mousePressEvent(QMouseEvent *event) override
     {
         if (event->button() == Qt::LeftButton) {
@@ -50,6 +120,11 @@ protected:
         }
         QSlider::mousePressEvent(event);
     }
+
+private:
+    QList<qreal> m_chapterMarkers;
+    qreal m_loopStart = -1;
+    qreal m_loopEnd = -1;
 };
 
 // 自定义视频播放组件，支持双击暂停/播放
@@ -73,6 +148,51 @@ protected:
     }
 };
 
+// 播放列表视图，拖拽移动（可多选）直接交给模型完成
+class PlaylistView : public QListView
+{
+    Q_OBJECT
+public:
+    explicit PlaylistView(QWidget *parent = nullptr)
+        : QListView(parent) {}
+
+protected:
+    void dropEvent(QDropEvent *event) override
+    {
+        PlaylistModel *playlistModel = qobject_cast<PlaylistModel *>(model());
+        if (event->source() != this || !playlistModel) {
+            QListView::dropEvent(event);
+            return;
+        }
+        
+        // 放在条目下半部分时插到该条目之后
+        QModelIndex target = indexAt(event->position().toPoint());
+        int row = playlistModel->rowCount();
+        if (target.isValid()) {
+            row = target.row();
+            if (event->position().y() > visualRect(target).center().y()) {
+                ++row;
+            }
+        }
+        
+        QModelIndexList selected = selectionModel()->selectedRows();
+        std::sort(selected.begin(), selected.end());
+        QList<PlaylistModel::ItemId> ids;
+        ids.reserve(selected.size());
+        for (const QModelIndex &index : selected) {
+            ids.append(playlistModel->idAt(index.row()));
+        }
+        playlistModel->moveItems(ids, row);
+        
+        // 模型中已经完成移动，按复制结束拖拽，避免视图再删除源行
+        event->setDropAction(Qt::CopyAction);
+        event->accept();
+        stopAutoScroll();
+        setState(NoState);
+        viewport()->update();
+    }
+};
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -81,6 +201,10 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+public slots:
+    // 打开命令行或其他实例转发来的文件、文件夹和网址
+    void openPaths(const QStringList &paths);
+
 private slots:
     void playVideo();
     void pauseVideo();
@@ -88,7 +212,7 @@ private slots:
     void setPosition(int position);
     void updatePosition(qint64 position);
     void updateDuration(qint64 duration);
-    void onPlaylistItemDoubleClicked(QListWidgetItem *item);
+    void onPlaylistItemDoubleClicked(const QModelIndex &index);
     void changePlaybackRate();
     void togglePlaylist();
     void mediaStatusChanged(QMediaPlayer::MediaStatus status);
@@ -112,14 +236,70 @@ private slots:
     void playNextVideoAuto();
     void onAudioOutputsChanged();
     void openFileOrFolder();
+    void openUrl();
     void addVideoFile(const QString &filePath);
     void removeSelectedVideo();
+    void importPlaylist();
+    void exportPlaylist();
+    void importNextBatch();
+    void runDeferredInit();
+    void refreshPlaybackWidgets();
+    void onChapterDetectionFinished(const QString &videoHash, const QList<qint64> &cuts);
+    void toggleGridMode();
+    void onGridTileActivated(const QString &filePath);
+    void openSubtitleSearch();
+    void onSubtitleHitActivated(const QString &videoPath, qint64 startMs);
+    void openDuplicateFinder();
+    void updateVisibleProbes();
+    void toggleShuffle();
+    void cycleRepeatMode();
+    void sortPlaylist();
+    void toggleSortOrder();
+    void onSegmentCacheReady();
+    void onWaveformReady(const QString &videoHash, const WaveformPeaks &peaks);
+    void onWaveformSeekRequested(qint64 position);
+    void onKeyframeIndexReady(const QString &videoHash, const QList<qint64> &keyframes);
 
 private:
     void setupUI();
     void setupConnections();
     void loadVideosFromFolder(const QString &folderPath);
     void playVideoFile(const QString &filePath);
+    void setPlayerSource(const QString &filePath);
+    void setPlayerPosition(qint64 position);
+    void traceVideoFrame(const QVideoFrame &frame);
+    void measureVideoFrame(const QVideoFrame &frame);
+    void dumpTrace();
+    bool ensureStreamProxy();
+    void playPlaylistPath(const QString &filePath);
+    bool isPlayableEntry(PlaybackQueue::ItemId id);
+    void selectPlaylistPath(const QString &filePath);
+    void playQueueItem(PlaybackQueue::ItemId id);
+    void updatePlaybackModeButtons();
+    void updateSortOrderButton();
+    void probePlaylistMetadata(const QStringList &paths);
+    void loadChapters();
+    void startChapterDetection();
+    void updateChapterMarkers();
+    void jumpToChapter(bool forward);
+    bool isGridActive() const;
+    void loadSubtitles(const QString &videoPath);
+    void updateSubtitleText();
+    void setLoopPoint(bool isStart);
+    void clearLoop();
+    void startLoopCapture();
+    void updateLoopMarkers();
+    bool isLoopReplaying() const;
+    void startLoopReplay();
+    void leaveLoopReplay(bool resumePlayback);
+    void updateSlowMotion();
+    void loadKeyframeIndex();
+    qint64 fastSeekTarget(qint64 position, qint64 from = -1) const;
+    void updateAudioTap();
+    void toggleSpectrum();
+    void updateSpectrumVisibility();
+    void captureFrames(bool burst);
+    void exitGridMode();
     void updatePlayButton();
     void formatTime(qint64 timeInMs, QString &str);
     void saveSettings();
@@ -129,6 +309,7 @@ private:
 protected:
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
     
     // UI组件
     QWidget *m_centralWidget;
@@ -136,22 +317,34 @@ protected:
     QWidget *m_videoContainer;
     QWidget *m_playlistContainer;
     ClickableVideoWidget *m_videoWidget;
-    QListWidget *m_playlistWidget;
+    PlaylistView *m_playlistView;
+    PlaylistModel *m_playlistModel;
     
     // 控制组件
     QWidget *m_controlsWidget;
     QPushButton *m_playButton;
     QPushButton *m_stopButton;
     QPushButton *m_openFolderButton;
+    QPushButton *m_openUrlButton;
     QPushButton *m_togglePlaylistButton;
     ClickableSlider *m_positionSlider;
+    WaveformStrip *m_waveformStrip;
     QSlider *m_volumeSlider;
     QPushButton *m_nextButton;
+    QPushButton *m_shuffleButton;
+    QPushButton *m_repeatButton;
     QPushButton *m_settingsButton;
     QPushButton *m_moveUpButton;
     QPushButton *m_moveDownButton;
     QPushButton *m_removeButton;
+    QPushButton *m_importButton;
+    QPushButton *m_exportButton;
+    QPushButton *m_gridButton;
+    QPushButton *m_subtitleSearchButton;
+    QPushButton *m_duplicateButton;
     QComboBox *m_speedComboBox;
+    QComboBox *m_sortComboBox;
+    QPushButton *m_sortOrderButton;
     QLabel *m_timeLabel;
     QPushButton *m_volumeButton;
     
@@ -165,7 +358,6 @@ protected:
     QString m_currentFolder;
     QSettings *m_settings;
     bool m_positionSliderPressed;
-    int m_currentPlayingIndex;
     bool m_isMuted;
     int m_previousVolume;
     
@@ -176,10 +368,111 @@ protected:
     bool m_longPressForward;
     double m_leftKeySpeed;
     double m_rightKeySpeed;
+    bool m_smoothSlowMotion;
+    bool m_fastSeek;
     SettingsDialog *m_settingsDialog;
     PositionDialog *m_positionDialog;
     QString m_currentVideoHash;
+    QString m_currentVideoPath;
     qint64 m_pendingJumpPosition;
+    
+    // 延迟初始化（首次绘制之后执行）
+    bool m_deferredInitScheduled;
+    bool m_restoreLastFolder;
+    QMediaDevices *m_mediaDevices;
+    QByteArray m_audioDeviceId;   // 当前音频输出使用的设备，用于判断默认设备是否真的变了
+    
+    // 播放相关界面的刷新（按帧合并，值变化时才更新控件）
+    UiRefreshScheduler *m_uiRefreshScheduler;
+    qint64 m_lastPosition;
+    qint64 m_displayedSecond;
+    qint64 m_displayedDurationSecond;
+    QString m_timeText;
+    
+    // 预读缓冲播放源
+    bool m_readAheadEnabled;
+    bool m_singleInstanceEnabled;
+    ReadAheadDevice *m_sourceDevice;
+    int m_displayedFillPercent;
+    
+    // 网络视频代理（首次播放网络地址时启动）
+    StreamProxy *m_streamProxy;
+    
+    // 播放列表元数据（可见行优先探测，滚动停止后更新可见范围）
+    MetadataProber *m_metadataProber;
+    QTimer *m_visibleRowsTimer;
+    int m_metadataProbeLimit;
+    // 播放列表缩略图（只为可见行生成，磁盘缓存按大小上限淘汰）
+    ThumbnailProvider *m_thumbnailProvider;
+    int m_thumbnailCacheMB;
+    // 正在分批导入的播放列表
+    M3uReader *m_playlistReader;
+    
+    // 自动章节（镜头切换点，毫秒）
+    SceneDetector *m_sceneDetector;
+    QList<qint64> m_chapters;
+    QString m_chapterScanPath;
+    
+    // 宫格播放（首次进入时创建）
+    QStackedWidget *m_videoStack;
+    GridPlaybackView *m_gridView;
+    
+    // 外挂字幕，文本交给视频输出绘制，显示的字幕变化时才更新
+    SubtitleTrack m_subtitleTrack;
+    QList<int> m_activeSubtitleCues;
+    
+    // 字幕全文搜索（首次打开搜索面板时创建）
+    SubtitleIndex *m_subtitleIndex;
+    SubtitleSearchDialog *m_subtitleSearchDialog;
+    qint64 m_pendingSeekPosition;
+    
+    // A-B循环：片段在预算内时第一遍播放收集到内存，之后从内存重放
+    qint64 m_loopStart;
+    qint64 m_loopEnd;
+    int m_loopCacheMB;
+    SegmentCache *m_segmentCache;
+    SegmentPlaybackView *m_segmentView;
+    bool m_loopAudioTap;
+    
+    // 解码出的音频PCM，A-B循环收集和频谱显示共用，需要时才接到播放器上
+    QAudioBufferOutput *m_audioBufferOutput;
+    
+    // 音频频谱（首次显示时创建）
+    SpectrumAnalyzer *m_spectrumAnalyzer;
+    SpectrumView *m_spectrumView;
+    bool m_spectrumEnabled;
+    
+    // 慢速播放插帧（首次以慢速播放时创建）
+    SlowMotionView *m_slowMotionView;
+    
+    // 截图和连拍（首次截图时创建）
+    FrameCapture *m_frameCapture;
+    QString m_snapshotFormat;
+    
+    // 音频波形（首次打开本地视频时创建生成器）
+    WaveformGenerator *m_waveformGenerator;
+    
+    // 快速跳转用的关键帧索引（首次需要时创建索引器）
+    KeyframeIndexer *m_keyframeIndexer;
+    QList<qint64> m_keyframes;
+    
+    // 重复视频查找（首次打开查找面板时创建）
+    DuplicateFinder *m_duplicateFinder;
+    DuplicateFinderDialog *m_duplicateDialog;
+    
+    // 时间线记录（--trace）：打开视频到第一帧、跳转到画面更新的异步区间
+    quint64 m_traceOpenId;
+    bool m_traceOpenLoaded;
+    quint64 m_traceSeekId;
+    qint64 m_traceSeekTarget;
+    
+    // 运行指标（--metrics-port）：打开和跳转的耗时，按相邻画面的时间间隔推算丢帧
+    QElapsedTimer m_metricsOpenTimer;
+    bool m_metricsOpenLoaded;
+    QElapsedTimer m_metricsSeekTimer;
+    qint64 m_metricsSeekTarget;
+    qint64 m_metricsFrameInterval;   // 微秒，来自媒体元数据中的帧率
+    qint64 m_metricsLastFrameTime;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,37 @@
+#include "mediapath.h"
+#include <QFileInfo>
+#include <QStringList>
+#include <QUrl>
+
+namespace {
+
+// 可以加入播放列表的视频格式
+const QStringList SupportedExtensions = {"mp4", "avi", "mkv", "mov", "wmv", "flv", "webm", "m4v", "3gp", "ts", "mts"};
+
+}
+
+bool isStreamUrl(const QString &text)
+{
+    QUrl url(text);
+    QString scheme = url.scheme().toLower();
+    return url.isValid() && !url.host().isEmpty() && (scheme == "http" || scheme == "https");
+}
+
+bool queueEntryForPath(const QString &filePath, QueueEntry *entry)
+{
+    // 网络地址不做本地文件检查
+    if (isStreamUrl(filePath)) {
+        QUrl url(filePath);
+        entry->path = filePath;
+        entry->title = url.fileName().isEmpty() ? url.host() : url.fileName();
+        return true;
+    }
+    
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists() || !SupportedExtensions.contains(fileInfo.suffix().toLower())) {
+        return false;
+    }
+    entry->path = fileInfo.absoluteFilePath();
+    entry->title = fileInfo.fileName();
+    return true;
+}
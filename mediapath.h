@@ -0,0 +1,17 @@
+#ifndef MEDIAPATH_H
+#define MEDIAPATH_H
+
+#include <QString>
+#include "playbackqueue.h"
+
+// 媒体路径的辅助函数
+// 只依赖QtCore，播放列表、哈希和基准测试可以直接使用，不必引入网络代理或界面
+
+// 判断文本是否是支持的网络视频地址（http/https）
+bool isStreamUrl(const QString &text);
+
+// 把要加入播放列表的本地文件或网络地址转换为列表项（绝对路径和显示名称）
+// 本地文件不存在或不是支持的视频格式时返回false
+bool queueEntryForPath(const QString &filePath, QueueEntry *entry);
+
+#endif // MEDIAPATH_H
@@ -0,0 +1,213 @@
+#include "metadataprober.h"
+#include <QMediaMetaData>
+#include <QMediaFormat>
+#include <QFileInfo>
+#include <QTimer>
+#include <QUrl>
+
+MetadataProber::MetadataProber(QObject *parent)
+    : QObject(parent)
+    , m_maxOpenFiles(DefaultMaxOpenFiles)
+{
+}
+
+MetadataProber::~MetadataProber()
+{
+    qDeleteAll(m_slots);
+}
+
+void MetadataProber::setMaxOpenFiles(int count)
+{
+    // 超出新上限的播放器不再接新任务，正在进行的探测照常完成
+    m_maxOpenFiles = qBound(1, count, 16);
+    schedule();
+}
+
+void MetadataProber::enqueue(const QStringList &paths)
+{
+    for (const QString &path : paths) {
+        if (m_results.contains(path) || m_queued.contains(path) || m_inFlight.contains(path)) {
+            continue;
+        }
+        m_queue.append(path);
+        m_queued.insert(path);
+    }
+    schedule();
+}
+
+void MetadataProber::setVisible(const QStringList &paths)
+{
+    m_visible = paths;
+    m_visibleSet = QSet<QString>(paths.cbegin(), paths.cend());
+    schedule();
+}
+
+void MetadataProber::clearQueue()
+{
+    m_queue.clear();
+    m_queued.clear();
+    m_visible.clear();
+    m_visibleSet.clear();
+    for (ProbeSlot *probe : std::as_const(m_slots)) {
+        if (!probe->path.isEmpty()) {
+            releaseSlot(probe);
+        }
+    }
+}
+
+const MediaInfo *MetadataProber::info(const QString &path) const
+{
+    auto it = m_results.constFind(path);
+    return it != m_results.constEnd() ? &it.value() : nullptr;
+}
+
+void MetadataProber::schedule()
+{
+    // 可见行在等待时，抢占正在探测已滚出视野的行的播放器
+    int waitingVisible = 0;
+    for (const QString &path : std::as_const(m_visible)) {
+        if (!m_results.contains(path) && !m_inFlight.contains(path)) {
+            ++waitingVisible;
+        }
+    }
+    // 空闲的槽位（包括尚未创建的）直接留给可见行，不足时才抢占
+    int freeSlots = m_maxOpenFiles;
+    for (int i = 0; i < qMin(m_maxOpenFiles, int(m_slots.size())); ++i) {
+        if (!m_slots.at(i)->path.isEmpty()) {
+            --freeSlots;
+        }
+    }
+    waitingVisible = qMax(0, waitingVisible - freeSlots);
+    for (ProbeSlot *probe : std::as_const(m_slots)) {
+        if (waitingVisible == 0) {
+            break;
+        }
+        if (!probe->path.isEmpty() && !m_visibleSet.contains(probe->path)) {
+            QString path = probe->path;
+            releaseSlot(probe);
+            m_queue.prepend(path);
+            m_queued.insert(path);
+            --waitingVisible;
+        }
+    }
+    
+    for (int i = 0; i < m_maxOpenFiles; ++i) {
+        if (i == m_slots.size()) {
+            ProbeSlot *probe = new ProbeSlot;
+            probe->player = new QMediaPlayer(this);
+            probe->timeoutTimer = new QTimer(this);
+            probe->timeoutTimer->setSingleShot(true);
+            connect(probe->player, &QMediaPlayer::mediaStatusChanged, this, [this, probe](QMediaPlayer::MediaStatus status) {
+                onMediaStatusChanged(probe, status);
+            });
+            connect(probe->timeoutTimer, &QTimer::timeout, this, [this, probe]() {
+                if (!probe->path.isEmpty()) {
+                    finishProbe(probe, MediaInfo());
+                }
+            });
+            m_slots.append(probe);
+        }
+        
+        ProbeSlot *probe = m_slots.at(i);
+        if (!probe->path.isEmpty()) {
+            continue;
+        }
+        QString path = takeNextPath();
+        if (path.isEmpty()) {
+            break;
+        }
+        startProbe(probe, path);
+    }
+}
+
+QString MetadataProber::takeNextPath()
+{
+    for (const QString &path : std::as_const(m_visible)) {
+        if (!m_results.contains(path) && !m_inFlight.contains(path)) {
+            return path;
+        }
+    }
+    
+    while (!m_queue.isEmpty()) {
+        QString path = m_queue.takeFirst();
+        m_queued.remove(path);
+        if (!m_results.contains(path) && !m_inFlight.contains(path)) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+void MetadataProber::startProbe(ProbeSlot *probe, const QString &path)
+{
+    probe->path = path;
+    m_inFlight.insert(path);
+    // 只加载不播放，后端读取容器和流信息后即进入LoadedMedia
+    probe->player->setSource(QUrl::fromLocalFile(path));
+    probe->timeoutTimer->start(ProbeTimeoutMs);
+}
+
+void MetadataProber::onMediaStatusChanged(ProbeSlot *probe, QMediaPlayer::MediaStatus status)
+{
+    if (probe->path.isEmpty()) {
+        return;
+    }
+    
+    if (status == QMediaPlayer::InvalidMedia) {
+        finishProbe(probe, MediaInfo());
+        return;
+    }
+    if (status != QMediaPlayer::LoadedMedia) {
+        return;
+    }
+    
+    QMediaPlayer *player = probe->player;
+    const QMediaMetaData metaData = player->metaData();
+    MediaInfo info;
+    info.durationMs = player->duration() > 0 ? player->duration() : -1;
+    
+    info.resolution = metaData.value(QMediaMetaData::Resolution).toSize();
+    const QList<QMediaMetaData> videoTracks = player->videoTracks();
+    if (!info.resolution.isValid() && !videoTracks.isEmpty()) {
+        int track = qBound(0, player->activeVideoTrack(), int(videoTracks.size()) - 1);
+        info.resolution = videoTracks.at(track).value(QMediaMetaData::Resolution).toSize();
+    }
+    
+    QVariant videoCodec = metaData.value(QMediaMetaData::VideoCodec);
+    if (videoCodec.isValid() && videoCodec.value<QMediaFormat::VideoCodec>() != QMediaFormat::VideoCodec::Unspecified) {
+        info.videoCodec = QMediaFormat::videoCodecName(videoCodec.value<QMediaFormat::VideoCodec>());
+    }
+    QVariant audioCodec = metaData.value(QMediaMetaData::AudioCodec);
+    if (audioCodec.isValid() && audioCodec.value<QMediaFormat::AudioCodec>() != QMediaFormat::AudioCodec::Unspecified) {
+        info.audioCodec = QMediaFormat::audioCodecName(audioCodec.value<QMediaFormat::AudioCodec>());
+    }
+    
+    // 容器没有记录码率时按文件大小和时长估算
+    info.fileSize = QFileInfo(probe->path).size();
+    info.bitRate = metaData.value(QMediaMetaData::VideoBitRate).toLongLong()
+                   + metaData.value(QMediaMetaData::AudioBitRate).toLongLong();
+    if (info.bitRate <= 0 && info.durationMs > 0 && info.fileSize > 0) {
+        info.bitRate = info.fileSize * 8000 / info.durationMs;
+    }
+    
+    finishProbe(probe, info);
+}
+
+void MetadataProber::finishProbe(ProbeSlot *probe, const MediaInfo &info)
+{
+    // 失败的文件也记录结果，不再重复尝试
+    QString path = probe->path;
+    m_results.insert(path, info);
+    releaseSlot(probe);
+    emit probed(path, info);
+    schedule();
+}
+
+void MetadataProber::releaseSlot(ProbeSlot *probe)
+{
+    m_inFlight.remove(probe->path);
+    probe->path.clear();
+    probe->timeoutTimer->stop();
+    // 清空播放源，立即释放文件句柄
+    probe->player->setSource(QUrl());
+}
@@ -0,0 +1,81 @@
+#ifndef METADATAPROBER_H
+#define METADATAPROBER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QStringList>
+#include <QMediaPlayer>
+
+class QTimer;
+
+// 探测得到的媒体信息，未知的字段保持默认值
+struct MediaInfo
+{
+    qint64 durationMs = -1;
+    QSize resolution;
+    QString videoCodec;
+    QString audioCodec;
+    qint64 bitRate = 0;     // 总码率（bps）
+    qint64 fileSize = -1;
+};
+
+// 播放列表元数据探测
+// 用少量不播放的播放器依次打开文件读取元数据，同时打开的文件数不超过上限，
+// 避免大目录或网络共享被同时大量访问。可见的行优先探测；可见行有等待时，
+// 已滚出视野的行的探测会被取消并放回队列。结果按路径缓存。
+class MetadataProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetadataProber(QObject *parent = nullptr);
+    ~MetadataProber() override;
+    
+    void setMaxOpenFiles(int count);
+    int maxOpenFiles() const { return m_maxOpenFiles; }
+    
+    // 加入后台队列（按加入顺序探测），已探测或已在队列中的路径会被忽略
+    void enqueue(const QStringList &paths);
+    // 设置当前可见的路径（按显示顺序），优先于后台队列
+    void setVisible(const QStringList &paths);
+    // 清空队列并取消正在进行的探测，已有结果保留
+    void clearQueue();
+    
+    // 已探测的信息，未探测时返回nullptr
+    const MediaInfo *info(const QString &path) const;
+    
+    static constexpr int DefaultMaxOpenFiles = 4;
+    static constexpr int ProbeTimeoutMs = 10000;
+
+signals:
+    void probed(const QString &path, const MediaInfo &info);
+
+private:
+    struct ProbeSlot
+    {
+        QMediaPlayer *player = nullptr;
+        QTimer *timeoutTimer = nullptr;
+        QString path;
+    };
+    
+    void schedule();
+    QString takeNextPath();
+    void startProbe(ProbeSlot *probe, const QString &path);
+    void onMediaStatusChanged(ProbeSlot *probe, QMediaPlayer::MediaStatus status);
+    void finishProbe(ProbeSlot *probe, const MediaInfo &info);
+    void releaseSlot(ProbeSlot *probe);
+    
+    QList<ProbeSlot *> m_slots;
+    int m_maxOpenFiles;
+    QStringList m_queue;
+    QSet<QString> m_queued;
+    QStringList m_visible;
+    QSet<QString> m_visibleSet;
+    QSet<QString> m_inFlight;
+    QHash<QString, MediaInfo> m_results;
+};
+
+#endif // METADATAPROBER_H
@@ -0,0 +1,243 @@
+#include "metrics.h"
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QFile>
+#include <QList>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+namespace {
+
+// 直方图桶的上界（秒），覆盖本地文件的几十毫秒到网络视频的数秒
+constexpr double BucketBounds[] = {0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+constexpr int BoundCount = int(sizeof(BucketBounds) / sizeof(BucketBounds[0]));
+
+struct CounterInfo
+{
+    const char *name;
+    const char *help;
+};
+
+const CounterInfo CounterInfos[Metrics::CounterCount] = {
+    {"videoplayer_files_opened_total", "Videos opened."},
+    {"videoplayer_invalid_media_total", "Media that could not be played."},
+    {"videoplayer_stalls_total", "Playback stalls caused by buffer underruns."},
+    {"videoplayer_dropped_frames_total", "Frames skipped during playback, inferred from presentation time gaps."},
+    {"videoplayer_audio_device_changes_total", "Switches to a new default audio output device."},
+};
+
+const CounterInfo HistogramInfos[Metrics::HistogramCount] = {
+    {"videoplayer_open_latency_seconds", "Time from opening a video to its first displayed frame."},
+    {"videoplayer_seek_latency_seconds", "Time from a seek request to the first frame near the target."},
+};
+
+// 桶内计数不累加，输出时再求前缀和；最后一个桶是+Inf
+struct HistogramData
+{
+    std::atomic<quint64> buckets[BoundCount + 1];
+    std::atomic<quint64> sumNs;
+};
+
+std::atomic<quint64> g_counters[Metrics::CounterCount];
+HistogramData g_histograms[Metrics::HistogramCount];
+
+QThread *g_thread = nullptr;
+QTcpServer *g_server = nullptr;
+
+// 进程常驻内存，无法获取时返回-1
+qint64 residentBytes()
+{
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/statm");
+    if (file.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = file.readLine().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return qint64(info.resident_size);
+    }
+#endif
+    return -1;
+}
+
+void appendHeader(QByteArray &out, const char *name, const char *help, const char *type)
+{
+    out += QByteArray("# HELP ") + name + " " + help + "\n";
+    out += QByteArray("# TYPE ") + name + " " + type + "\n";
+}
+
+// 每个连接只处理一个请求，响应后关闭
+void serveConnection(QTcpSocket *socket)
+{
+    QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+        if (socket->property("handled").toBool()) {
+            socket->readAll();
+            return;
+        }
+        QByteArray request = socket->peek(8 * 1024);
+        int lineEnd = request.indexOf("\r\n");
+        if (lineEnd < 0 || request.indexOf("\r\n\r\n") < 0) {
+            if (request.size() >= 8 * 1024) {
+                socket->abort();
+            }
+            return;
+        }
+        socket->setProperty("handled", true);
+        socket->readAll();
+
+        QList<QByteArray> requestLine = request.left(lineEnd).split(' ');
+        QByteArray method = requestLine.value(0);
+        QByteArray path = requestLine.value(1);
+        int query = path.indexOf('?');
+        if (query >= 0) {
+            path.truncate(query);
+        }
+
+        QByteArray status = "200 OK";
+        QByteArray body;
+        QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+        if (method != "GET" && method != "HEAD") {
+            status = "405 Method Not Allowed";
+        } else if (path != "/metrics") {
+            status = "404 Not Found";
+        } else {
+            body = Metrics::render();
+        }
+
+        QByteArray response = "HTTP/1.1 " + status + "\r\n";
+        response += "Content-Type: " + contentType + "\r\n";
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        if (method != "HEAD") {
+            response += body;
+        }
+        socket->write(response);
+        socket->disconnectFromHost();
+    });
+}
+
+}
+
+std::atomic<bool> Metrics::s_enabled{false};
+
+bool Metrics::start(quint16 port)
+{
+    if (g_thread) {
+        return true;
+    }
+
+    g_thread = new QThread();
+    g_thread->setObjectName("指标服务");
+    g_server = new QTcpServer();
+    g_server->moveToThread(g_thread);
+    g_thread->start(QThread::LowPriority);
+
+    // 监听套接字要在服务线程中创建
+    QTcpServer *server = g_server;
+    bool listening = false;
+    QMetaObject::invokeMethod(server, [server, port]() {
+        QObject::connect(server, &QTcpServer::newConnection, server, [server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection()) {
+                serveConnection(socket);
+            }
+        });
+        return server->listen(QHostAddress::LocalHost, port);
+    }, Qt::BlockingQueuedConnection, &listening);
+
+    if (!listening) {
+        stop();
+        return false;
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Metrics::stop()
+{
+    if (!g_thread) {
+        return;
+    }
+
+    s_enabled.store(false, std::memory_order_relaxed);
+    // 线程结束时会处理deleteLater，监听套接字和连接在服务线程中析构
+    g_server->deleteLater();
+    g_server = nullptr;
+    g_thread->quit();
+    g_thread->wait();
+    delete g_thread;
+    g_thread = nullptr;
+}
+
+void Metrics::increment(Counter counter, quint64 amount)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    g_counters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void Metrics::observe(Histogram histogram, qint64 nanoseconds)
+{
+    if (!isEnabled() || nanoseconds < 0) {
+        return;
+    }
+    HistogramData &data = g_histograms[histogram];
+    double seconds = nanoseconds / 1e9;
+    int bucket = 0;
+    while (bucket < BoundCount && seconds > BucketBounds[bucket]) {
+        ++bucket;
+    }
+    data.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    data.sumNs.fetch_add(quint64(nanoseconds), std::memory_order_relaxed);
+}
+
+QByteArray Metrics::render()
+{
+    QByteArray out;
+    for (int i = 0; i < CounterCount; ++i) {
+        appendHeader(out, CounterInfos[i].name, CounterInfos[i].help, "counter");
+        out += QByteArray(CounterInfos[i].name) + " "
+               + QByteArray::number(g_counters[i].load(std::memory_order_relaxed)) + "\n";
+    }
+
+    // 各桶分别读取，抓取期间的新样本可能只计入部分桶，下次抓取时即一致
+    for (int i = 0; i < HistogramCount; ++i) {
+        const QByteArray name = HistogramInfos[i].name;
+        const HistogramData &data = g_histograms[i];
+        appendHeader(out, HistogramInfos[i].name, HistogramInfos[i].help, "histogram");
+        quint64 cumulative = 0;
+        for (int bucket = 0; bucket <= BoundCount; ++bucket) {
+            cumulative += data.buckets[bucket].load(std::memory_order_relaxed);
+            QByteArray bound = bucket < BoundCount ? QByteArray::number(BucketBounds[bucket], 'g', 6) : "+Inf";
+            out += name + "_bucket{le=\"" + bound + "\"} " + QByteArray::number(cumulative) + "\n";
+        }
+        out += name + "_sum " + QByteArray::number(data.sumNs.load(std::memory_order_relaxed) / 1e9, 'f', 6) + "\n";
+        out += name + "_count " + QByteArray::number(cumulative) + "\n";
+    }
+
+    qint64 resident = residentBytes();
+    if (resident >= 0) {
+        appendHeader(out, "process_resident_memory_bytes", "Resident memory size in bytes.", "gauge");
+        out += "process_resident_memory_bytes " + QByteArray::number(resident) + "\n";
+    }
+    return out;
+}
@@ -0,0 +1,44 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <atomic>
+
+// 运行指标，供监控系统抓取
+// 通过 --metrics-port 参数启用，在127.0.0.1的指定端口以Prometheus文本格式提供 /metrics。
+// 计数器和直方图都是原子变量，记录时不加锁；未启用时每个记录点只读一次原子标志。
+// HTTP服务运行在独立线程中，抓取不会占用界面线程。
+class Metrics
+{
+public:
+    enum Counter {
+        FilesOpened,          // 打开的视频数
+        InvalidMedia,         // 无法播放的媒体
+        Stalls,               // 播放中缓冲不足而卡住
+        DroppedFrames,        // 播放中未显示的帧（按画面时间间隔推算）
+        AudioDeviceChanges,   // 默认音频输出设备切换
+        CounterCount
+    };
+
+    enum Histogram {
+        OpenLatency,   // 打开视频到显示第一帧
+        SeekLatency,   // 发出跳转到显示目标位置附近的画面
+        HistogramCount
+    };
+
+    // 开始监听，返回是否成功
+    static bool start(quint16 port);
+    static void stop();
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static void increment(Counter counter, quint64 amount = 1);
+    static void observe(Histogram histogram, qint64 nanoseconds);
+
+    // 当前所有指标的Prometheus文本
+    static QByteArray render();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,342 @@
+#include "motioninterpolator.h"
+#include "simdkernels.h"
+#include "videoframeutils.h"
+#include "tracer.h"
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr int BlockSize = 16;                    // 合成时的块大小（输出像素）
+constexpr int LumaBlockSize = BlockSize / 2;     // 运动估计在半分辨率亮度上进行
+constexpr int SearchRange = 16;                  // 亮度像素，相当于输出画面中每帧±32像素
+constexpr qint64 MaxGapMs = 250;                 // 间隔更大（跳转、丢帧）时不插帧
+constexpr int MaxSlots = 4;                      // 每个帧间隔最多分成4份
+constexpr qreal SceneCutSad = 24.0;              // 平均每像素差超过此值视为镜头切换，不插帧
+constexpr qreal BudgetFraction = 0.7;            // 处理时间占帧间隔（实际时间）的上限
+constexpr qint64 RetryAfterMs = 5000;
+
+struct MotionVector
+{
+    int dx = 0;
+    int dy = 0;
+};
+
+// 每个块的运动矢量：next中的块 ≈ previous中偏移(dx, dy)处的块
+struct MotionField
+{
+    int columns = 0;
+    int rows = 0;
+    std::vector<MotionVector> vectors;
+    qreal meanSad = 0.0;
+};
+
+// 预测矢量（零矢量和左、上、右上块的结果）中取最好的作为起点，再逐步缩小步长搜索
+void estimateMotion(const quint8 *previous, const quint8 *next, int width, int height, MotionField &field)
+{
+    field.columns = (width + LumaBlockSize - 1) / LumaBlockSize;
+    field.rows = (height + LumaBlockSize - 1) / LumaBlockSize;
+    field.vectors.assign(size_t(field.columns) * field.rows, MotionVector());
+    quint64 totalSad = 0;
+    
+    for (int row = 0; row < field.rows; ++row) {
+        for (int column = 0; column < field.columns; ++column) {
+            const int x = column * LumaBlockSize;
+            const int y = row * LumaBlockSize;
+            const int blockWidth = qMin(LumaBlockSize, width - x);
+            const int blockHeight = qMin(LumaBlockSize, height - y);
+            const quint8 *block = next + qsizetype(y) * width + x;
+            // 非零矢量需要明显更好才采用，平坦区域不会因噪声产生随机矢量
+            const quint64 penalty = quint64(blockWidth * blockHeight) / 2;
+            
+            auto cost = [&](int dx, int dy) {
+                int px = x + dx;
+                int py = y + dy;
+                if (px < 0 || py < 0 || px + blockWidth > width || py + blockHeight > height
+                    || qAbs(dx) > SearchRange || qAbs(dy) > SearchRange) {
+                    return std::numeric_limits<quint64>::max();
+                }
+                quint64 sad = SimdKernels::sumAbsDiffBlockU8(block, width, previous + qsizetype(py) * width + px,
+                                                             width, blockWidth, blockHeight);
+                return (dx || dy) ? sad + penalty : sad;
+            };
+            
+            MotionVector best;
+            quint64 bestCost = cost(0, 0);
+            auto tryVector = [&](int dx, int dy) {
+                quint64 c = cost(dx, dy);
+                if (c < bestCost) {
+                    bestCost = c;
+                    best = {dx, dy};
+                }
+            };
+            
+            auto vectorAt = [&](int c, int r) { return field.vectors[size_t(r) * field.columns + c]; };
+            if (column > 0) {
+                MotionVector left = vectorAt(column - 1, row);
+                tryVector(left.dx, left.dy);
+            }
+            if (row > 0) {
+                MotionVector top = vectorAt(column, row - 1);
+                tryVector(top.dx, top.dy);
+                if (column + 1 < field.columns) {
+                    MotionVector topRight = vectorAt(column + 1, row - 1);
+                    tryVector(topRight.dx, topRight.dy);
+                }
+            }
+            
+            for (int step = SearchRange / 2; step >= 1; step /= 2) {
+                MotionVector center = best;
+                for (int sy = -1; sy <= 1; ++sy) {
+                    for (int sx = -1; sx <= 1; ++sx) {
+                        if (sx || sy) {
+                            tryVector(center.dx + sx * step, center.dy + sy * step);
+                        }
+                    }
+                }
+            }
+            
+            field.vectors[size_t(row) * field.columns + column] = best;
+            totalSad += (best.dx || best.dy) ? bestCost - penalty : bestCost;
+        }
+    }
+    field.meanSad = qreal(totalSad) / (qreal(width) * height);
+}
+
+// 输出中每个块沿矢量从前后两帧取块：previous(r + t·v) 与 next(r - (1 - t)·v) 按t混合
+void synthesize(const QImage &previous, const QImage &next, const MotionField &field, qreal t, QImage &out)
+{
+    const int width = out.width();
+    const int height = out.height();
+    const int weight = qRound(t * 128);
+    
+    for (int y = 0; y < height; y += BlockSize) {
+        for (int x = 0; x < width; x += BlockSize) {
+            const int blockWidth = qMin(BlockSize, width - x);
+            const int blockHeight = qMin(BlockSize, height - y);
+            const int column = qMin(x / BlockSize, field.columns - 1);
+            const int row = qMin(y / BlockSize, field.rows - 1);
+            const MotionVector vector = field.vectors[size_t(row) * field.columns + column];
+            
+            // 亮度是半分辨率，矢量放大到输出像素
+            const int vx = vector.dx * 2;
+            const int vy = vector.dy * 2;
+            const int offsetX = qRound(t * vx);
+            const int offsetY = qRound(t * vy);
+            const int previousX = qBound(0, x + offsetX, width - blockWidth);
+            const int previousY = qBound(0, y + offsetY, height - blockHeight);
+            const int nextX = qBound(0, x + offsetX - vx, width - blockWidth);
+            const int nextY = qBound(0, y + offsetY - vy, height - blockHeight);
+            
+            for (int line = 0; line < blockHeight; ++line) {
+                SimdKernels::blendU8(previous.constScanLine(previousY + line) + previousX * 4,
+                                     next.constScanLine(nextY + line) + nextX * 4,
+                                     out.scanLine(y + line) + x * 4,
+                                     blockWidth * 4, weight);
+            }
+        }
+    }
+}
+
+}
+
+// 运行在工作线程中，只在工作线程中访问
+class InterpolationWorker : public QObject
+{
+public:
+    explicit InterpolationWorker(MotionInterpolator *owner)
+        : m_owner(owner)
+    {
+    }
+    
+    void reset(quint64 session)
+    {
+        m_session = session;
+        m_previous = QImage();
+        m_previousLuma.clear();
+    }
+    
+    void process(quint64 session, const QVideoFrame &frame, qint64 timeMs, const QSize &outputSize,
+                 qreal rate, int displayIntervalMs)
+    {
+        if (session != m_session) {
+            return;
+        }
+        TraceScope scope("插帧");
+        QElapsedTimer timer;
+        timer.start();
+        
+        QImage image = frame.toImage();
+        if (image.isNull()) {
+            return;
+        }
+        QSize size = image.size();
+        if (size.width() > outputSize.width() || size.height() > outputSize.height()) {
+            size = size.scaled(outputSize, Qt::KeepAspectRatio);
+        }
+        if (image.size() != size) {
+            image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        image = image.convertToFormat(QImage::Format_RGB32);
+        
+        const int lumaWidth = (size.width() + 1) / 2;
+        const int lumaHeight = (size.height() + 1) / 2;
+        std::vector<quint8> luma(size_t(lumaWidth) * lumaHeight);
+        if (!VideoFrameUtils::downscaleLuma(frame, luma.data(), lumaWidth, lumaHeight)) {
+            luma.clear();
+        }
+        
+        // 暂停插帧一段时间后重新尝试
+        if (!m_interpolating && m_fallbackClock.elapsed() >= RetryAfterMs) {
+            m_interpolating = true;
+            m_averageMs = 0.0;
+        }
+        if (m_owner->m_overloaded.exchange(false)) {
+            fallBack();
+        }
+        
+        QList<InterpolatedFrame> frames;
+        const qint64 interval = timeMs - m_previousTime;
+        const bool canInterpolate = m_interpolating && !m_previous.isNull() && m_previous.size() == size
+                                    && !luma.empty() && m_previousLuma.size() == luma.size()
+                                    && interval > 0 && interval <= MaxGapMs;
+        if (canInterpolate) {
+            // 按慢放后的帧间隔和显示刷新间隔决定插几帧
+            int slots = qBound(1, qRound(interval / rate / displayIntervalMs), MaxSlots);
+            if (slots > 1) {
+                estimateMotion(m_previousLuma.data(), luma.data(), lumaWidth, lumaHeight, m_field);
+                if (m_field.meanSad < SceneCutSad) {
+                    for (int slot = 1; slot < slots; ++slot) {
+                        qreal t = qreal(slot) / slots;
+                        InterpolatedFrame synthesized;
+                        synthesized.timeMs = m_previousTime + qRound64(interval * t);
+                        synthesized.image = QImage(size, QImage::Format_RGB32);
+                        synthesized.synthesized = true;
+                        synthesize(m_previous, image, m_field, t, synthesized.image);
+                        frames.append(synthesized);
+                    }
+                }
+            }
+            
+            // 超出预算时改为重复原始帧
+            qreal elapsedMs = timer.nsecsElapsed() / 1e6;
+            m_averageMs = m_averageMs > 0.0 ? m_averageMs * 0.9 + elapsedMs * 0.1 : elapsedMs;
+            if (m_averageMs > interval / rate * BudgetFraction) {
+                fallBack();
+            }
+        }
+        
+        InterpolatedFrame original;
+        original.timeMs = timeMs;
+        original.image = image;
+        frames.append(original);
+        
+        m_previous = image;
+        m_previousLuma.swap(luma);
+        m_previousTime = timeMs;
+        
+        MotionInterpolator *owner = m_owner;
+        bool interpolating = m_interpolating;
+        QMetaObject::invokeMethod(owner, [owner, session, frames, interpolating]() {
+            owner->deliver(session, frames, interpolating);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    void fallBack()
+    {
+        m_interpolating = false;
+        m_fallbackClock.start();
+    }
+    
+    MotionInterpolator *m_owner;
+    quint64 m_session = 0;
+    QImage m_previous;
+    std::vector<quint8> m_previousLuma;
+    qint64 m_previousTime = 0;
+    MotionField m_field;
+    bool m_interpolating = true;
+    qreal m_averageMs = 0.0;
+    QElapsedTimer m_fallbackClock;
+};
+
+MotionInterpolator::MotionInterpolator(QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+    , m_session(0)
+    , m_outputSize(MaxOutputWidth, MaxOutputHeight)
+    , m_rate(1.0)
+    , m_displayIntervalMs(16)
+    , m_interpolating(true)
+    , m_pendingFrames(0)
+    , m_overloaded(false)
+{
+    m_worker = new InterpolationWorker(this);
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("插帧");
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start();
+}
+
+MotionInterpolator::~MotionInterpolator()
+{
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void MotionInterpolator::setOutputSize(const QSize &size)
+{
+    m_outputSize = size.boundedTo(QSize(MaxOutputWidth, MaxOutputHeight)).expandedTo(QSize(BlockSize, BlockSize));
+}
+
+void MotionInterpolator::addFrame(const QVideoFrame &frame)
+{
+    if (!frame.isValid() || frame.startTime() < 0) {
+        return;
+    }
+    // 工作线程跟不上时丢帧，并通知工作线程停止插帧
+    if (m_pendingFrames.fetch_add(1, std::memory_order_relaxed) >= MaxPendingFrames) {
+        m_pendingFrames.fetch_sub(1, std::memory_order_relaxed);
+        m_overloaded.store(true);
+        return;
+    }
+    
+    InterpolationWorker *worker = m_worker;
+    quint64 session = m_session;
+    qint64 timeMs = frame.startTime() / 1000;
+    QSize outputSize = m_outputSize;
+    qreal rate = m_rate;
+    int displayIntervalMs = m_displayIntervalMs;
+    QMetaObject::invokeMethod(m_worker, [this, worker, session, frame, timeMs, outputSize, rate, displayIntervalMs]() {
+        m_pendingFrames.fetch_sub(1, std::memory_order_relaxed);
+        worker->process(session, frame, timeMs, outputSize, rate, displayIntervalMs);
+    }, Qt::QueuedConnection);
+}
+
+void MotionInterpolator::reset()
+{
+    // 递增会话号，工作线程中尚未处理的帧和已发出的结果都会被丢弃
+    InterpolationWorker *worker = m_worker;
+    quint64 session = ++m_session;
+    QMetaObject::invokeMethod(m_worker, [worker, session]() {
+        worker->reset(session);
+    }, Qt::QueuedConnection);
+}
+
+void MotionInterpolator::deliver(quint64 session, const QList<InterpolatedFrame> &frames, bool interpolating)
+{
+    if (session != m_session) {
+        return;
+    }
+    if (interpolating != m_interpolating) {
+        m_interpolating = interpolating;
+        qInfo().noquote() << (interpolating ? "恢复慢放插帧" : "处理跟不上，慢放改为重复帧");
+        emit interpolatingChanged(interpolating);
+    }
+    emit framesReady(frames);
+}
@@ -0,0 +1,70 @@
+#ifndef MOTIONINTERPOLATOR_H
+#define MOTIONINTERPOLATOR_H
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QVideoFrame>
+#include <atomic>
+
+class QThread;
+class InterpolationWorker;
+
+// 一帧输出画面，timeMs为原视频中的时间
+struct InterpolatedFrame
+{
+    qint64 timeMs = 0;
+    QImage image;
+    bool synthesized = false;   // 插出的中间帧
+};
+
+// 慢速播放的运动补偿插帧
+// 解码出的帧在工作线程中缩小到显示尺寸；相邻两帧在半分辨率亮度上逐块搜索运动矢量
+// （块匹配，绝对差之和最小），再沿矢量从前后两帧取块混合出中间帧。
+// 每帧处理时间超过帧间隔的预算或积压丢帧时，改为只输出原始帧（画面重复显示），
+// 几秒后再尝试插帧。
+class MotionInterpolator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MotionInterpolator(QObject *parent = nullptr);
+    ~MotionInterpolator() override;
+    
+    // 输出尺寸上限（设备像素），超过MaxOutputWidth x MaxOutputHeight时按此上限
+    void setOutputSize(const QSize &size);
+    void setPlaybackRate(qreal rate) { m_rate = rate; }
+    void setDisplayInterval(int intervalMs) { m_displayIntervalMs = intervalMs; }
+    
+    void addFrame(const QVideoFrame &frame);
+    // 丢弃尚未处理的帧，下一帧不与之前的帧插值（跳转、切换视频时）
+    void reset();
+    
+    bool isInterpolating() const { return m_interpolating; }
+    
+    static constexpr int MaxOutputWidth = 1280;
+    static constexpr int MaxOutputHeight = 720;
+    static constexpr int MaxPendingFrames = 2;
+
+signals:
+    // 按时间顺序：本帧之前插出的中间帧，最后是原始帧
+    void framesReady(const QList<InterpolatedFrame> &frames);
+    void interpolatingChanged(bool interpolating);
+
+private:
+    friend class InterpolationWorker;
+    void deliver(quint64 session, const QList<InterpolatedFrame> &frames, bool interpolating);
+    
+    QThread *m_workerThread;
+    InterpolationWorker *m_worker;
+    quint64 m_session;
+    QSize m_outputSize;
+    qreal m_rate;
+    int m_displayIntervalMs;
+    bool m_interpolating;
+    std::atomic<int> m_pendingFrames;
+    std::atomic<bool> m_overloaded;
+};
+
+#endif // MOTIONINTERPOLATOR_H
@@ -0,0 +1,77 @@
+#include "perceptualhash.h"
+#include "simdkernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+constexpr int N = PerceptualHash::InputSize;
+constexpr int K = 8;   // 保留的低频系数边长
+constexpr double Pi = 3.14159265358979323846;
+
+// DCT-II基函数表 basis[u][x] = cos((2x + 1) u π / 2N)
+struct DctBasis
+{
+    float values[K][N];
+    
+    DctBasis()
+    {
+        for (int u = 0; u < K; ++u) {
+            for (int x = 0; x < N; ++x) {
+                values[u][x] = float(std::cos((2 * x + 1) * u * Pi / (2.0 * N)));
+            }
+        }
+    }
+};
+
+const DctBasis &basis()
+{
+    static const DctBasis table;
+    return table;
+}
+
+}
+
+namespace PerceptualHash {
+
+quint64 compute(const quint8 *luma)
+{
+    const DctBasis &dct = basis();
+    
+    // 行变换：每行只计算前K个系数；结果按列存放，便于列变换时连续访问
+    float pixels[N];
+    float rows[K][N];
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            pixels[x] = luma[y * N + x];
+        }
+        for (int u = 0; u < K; ++u) {
+            rows[u][y] = SimdKernels::dotF32(pixels, dct.values[u], N);
+        }
+    }
+    
+    // 列变换得到左上角K x K系数
+    std::array<float, K * K> coefficients;
+    for (int u = 0; u < K; ++u) {
+        for (int v = 0; v < K; ++v) {
+            coefficients[v * K + u] = SimdKernels::dotF32(rows[u], dct.values[v], N);
+        }
+    }
+    
+    // 直流分量只反映整体亮度，不参与中位数
+    std::array<float, K * K - 1> sorted;
+    std::copy(coefficients.begin() + 1, coefficients.end(), sorted.begin());
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    const float median = sorted[sorted.size() / 2];
+    
+    quint64 hash = 0;
+    for (int i = 0; i < K * K; ++i) {
+        if (coefficients[i] > median) {
+            hash |= quint64(1) << i;
+        }
+    }
+    return hash;
+}
+
+}
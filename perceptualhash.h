@@ -0,0 +1,23 @@
+#ifndef PERCEPTUALHASH_H
+#define PERCEPTUALHASH_H
+
+#include <QtGlobal>
+
+// 基于DCT的感知哈希（pHash）
+// 输入为32x32的亮度图，取二维DCT左上角8x8低频系数，与中位数比较得到64位哈希。
+// 重新编码、缩放、轻微调色后的画面哈希距离很小。
+namespace PerceptualHash {
+
+constexpr int InputSize = 32;
+
+quint64 compute(const quint8 *luma);
+
+// 汉明距离（0 - 64）
+inline int distance(quint64 a, quint64 b)
+{
+    return qPopulationCount(a ^ b);
+}
+
+}
+
+#endif // PERCEPTUALHASH_H
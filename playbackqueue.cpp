@@ -0,0 +1,376 @@
+#include "playbackqueue.h"
+#include <QRandomGenerator>
+#include <algorithm>
+
+// 按子树大小索引的随机平衡树（隐式树堆）
+// 合并时按两棵树的大小比例随机选择根，无需保存优先级；
+// 每个节点记录父节点，可以从编号直接求出位置。
+class SequenceTree
+{
+public:
+    using ItemId = PlaybackQueue::ItemId;
+    
+    SequenceTree() = default;
+    SequenceTree(const SequenceTree &) = delete;
+    SequenceTree &operator=(const SequenceTree &) = delete;
+    ~SequenceTree() { clear(); }
+    
+    int size() const { return sizeOf(m_root); }
+    
+    ItemId at(int index) const
+    {
+        Node *node = m_root;
+        while (node) {
+            int leftSize = sizeOf(node->left);
+            if (index < leftSize) {
+                node = node->left;
+            } else if (index == leftSize) {
+                return node->id;
+            } else {
+                index -= leftSize + 1;
+                node = node->right;
+            }
+        }
+        return 0;
+    }
+    
+    int indexOf(ItemId id) const
+    {
+        Node *node = m_nodes.value(id);
+        if (!node) {
+            return -1;
+        }
+        int index = sizeOf(node->left);
+        for (; node->parent; node = node->parent) {
+            if (node == node->parent->right) {
+                index += sizeOf(node->parent->left) + 1;
+            }
+        }
+        return index;
+    }
+    
+    QList<ItemId> toList() const
+    {
+        QList<ItemId> ids;
+        ids.reserve(size());
+        collect(m_root, ids);
+        return ids;
+    }
+    
+    void insert(int index, const QList<ItemId> &ids)
+    {
+        // 新项先建成一棵完全平衡的子树，再整体拼接
+        Node *block = build(ids, 0, int(ids.size()));
+        Node *left = nullptr;
+        Node *right = nullptr;
+        split(m_root, index, left, right);
+        setRoot(merge(merge(left, block), right));
+    }
+    
+    QList<ItemId> take(int index, int count)
+    {
+        Node *left = nullptr;
+        Node *rest = nullptr;
+        Node *middle = nullptr;
+        Node *right = nullptr;
+        split(m_root, index, left, rest);
+        split(rest, count, middle, right);
+        setRoot(merge(left, right));
+        
+        QList<ItemId> ids;
+        ids.reserve(sizeOf(middle));
+        collect(middle, ids);
+        for (ItemId id : std::as_const(ids)) {
+            delete m_nodes.take(id);
+        }
+        return ids;
+    }
+    
+    void move(int from, int count, int to)
+    {
+        Node *left = nullptr;
+        Node *rest = nullptr;
+        Node *middle = nullptr;
+        Node *right = nullptr;
+        split(m_root, from, left, rest);
+        split(rest, count, middle, right);
+        split(merge(left, right), to, left, right);
+        setRoot(merge(merge(left, middle), right));
+    }
+    
+    void clear()
+    {
+        qDeleteAll(m_nodes);
+        m_nodes.clear();
+        m_root = nullptr;
+    }
+
+private:
+    struct Node
+    {
+        ItemId id = 0;
+        int size = 1;
+        Node *left = nullptr;
+        Node *right = nullptr;
+        Node *parent = nullptr;
+    };
+    
+    static int sizeOf(const Node *node) { return node ? node->size : 0; }
+    
+    static void update(Node *node)
+    {
+        node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+        if (node->left) {
+            node->left->parent = node;
+        }
+        if (node->right) {
+            node->right->parent = node;
+        }
+    }
+    
+    void setRoot(Node *root)
+    {
+        m_root = root;
+        if (m_root) {
+            m_root->parent = nullptr;
+        }
+    }
+    
+    Node *build(const QList<ItemId> &ids, int begin, int end)
+    {
+        if (begin >= end) {
+            return nullptr;
+        }
+        int middle = begin + (end - begin) / 2;
+        Node *node = new Node;
+        node->id = ids.at(middle);
+        m_nodes.insert(node->id, node);
+        node->left = build(ids, begin, middle);
+        node->right = build(ids, middle + 1, end);
+        update(node);
+        return node;
+    }
+    
+    // 拆成前count项和其余部分
+    static void split(Node *node, int count, Node *&left, Node *&right)
+    {
+        if (!node) {
+            left = right = nullptr;
+            return;
+        }
+        if (sizeOf(node->left) < count) {
+            split(node->right, count - sizeOf(node->left) - 1, node->right, right);
+            left = node;
+        } else {
+            split(node->left, count, left, node->left);
+            right = node;
+        }
+        update(node);
+        if (left) {
+            left->parent = nullptr;
+        }
+        if (right) {
+            right->parent = nullptr;
+        }
+    }
+    
+    static Node *merge(Node *left, Node *right)
+    {
+        if (!left) {
+            return right;
+        }
+        if (!right) {
+            return left;
+        }
+        quint32 total = quint32(left->size + right->size);
+        if (QRandomGenerator::global()->bounded(total) < quint32(left->size)) {
+            left->right = merge(left->right, right);
+            update(left);
+            return left;
+        }
+        right->left = merge(left, right->left);
+        update(right);
+        return right;
+    }
+    
+    static void collect(const Node *node, QList<ItemId> &ids)
+    {
+        // 中序遍历，用显式栈避免退化时递归过深
+        QList<const Node *> stack;
+        while (node || !stack.isEmpty()) {
+            while (node) {
+                stack.append(node);
+                node = node->left;
+            }
+            node = stack.takeLast();
+            ids.append(node->id);
+            node = node->right;
+        }
+    }
+    
+    Node *m_root = nullptr;
+    QHash<ItemId, Node *> m_nodes;
+};
+
+PlaybackQueue::PlaybackQueue()
+    : m_order(new SequenceTree)
+    , m_shuffleOrder(new SequenceTree)
+    , m_nextId(1)
+    , m_current(0)
+    , m_shuffled(false)
+    , m_repeatMode(RepeatOff)
+{
+}
+
+PlaybackQueue::~PlaybackQueue()
+{
+    delete m_order;
+    delete m_shuffleOrder;
+}
+
+int PlaybackQueue::count() const
+{
+    return m_order->size();
+}
+
+PlaybackQueue::ItemId PlaybackQueue::idAt(int index) const
+{
+    return m_order->at(index);
+}
+
+int PlaybackQueue::indexOf(ItemId id) const
+{
+    return m_order->indexOf(id);
+}
+
+const QueueEntry &PlaybackQueue::entry(ItemId id) const
+{
+    static const QueueEntry empty;
+    auto it = m_entries.constFind(id);
+    return it != m_entries.constEnd() ? it.value() : empty;
+}
+
+QList<PlaybackQueue::ItemId> PlaybackQueue::ids() const
+{
+    return m_order->toList();
+}
+
+QList<PlaybackQueue::ItemId> PlaybackQueue::insert(int index, const QList<QueueEntry> &entries)
+{
+    QList<ItemId> ids;
+    ids.reserve(entries.size());
+    for (const QueueEntry &entry : entries) {
+        ItemId id = m_nextId++;
+        m_entries.insert(id, entry);
+        ids.append(id);
+    }
+    m_order->insert(qBound(0, index, count()), ids);
+    
+    // 随机顺序中插到当前项之后，本轮还能播放到
+    if (m_shuffled) {
+        int first = m_current ? m_shuffleOrder->indexOf(m_current) + 1 : 0;
+        for (ItemId id : std::as_const(ids)) {
+            int position = int(QRandomGenerator::global()->bounded(first, m_shuffleOrder->size() + 1));
+            m_shuffleOrder->insert(position, {id});
+        }
+    }
+    return ids;
+}
+
+QList<PlaybackQueue::ItemId> PlaybackQueue::remove(int index, int count)
+{
+    QList<ItemId> ids = m_order->take(index, count);
+    for (ItemId id : std::as_const(ids)) {
+        m_entries.remove(id);
+        if (m_shuffled) {
+            m_shuffleOrder->take(m_shuffleOrder->indexOf(id), 1);
+        }
+        if (id == m_current) {
+            m_current = 0;
+        }
+    }
+    return ids;
+}
+
+void PlaybackQueue::move(int from, int count, int to)
+{
+    m_order->move(from, count, to);
+}
+
+void PlaybackQueue::reorder(const QList<ItemId> &ids)
+{
+    Q_ASSERT(ids.size() == count());
+    // 直接重建为平衡树，比逐项移动快得多；随机顺序不受影响
+    m_order->clear();
+    m_order->insert(0, ids);
+}
+
+void PlaybackQueue::clear()
+{
+    m_order->clear();
+    m_shuffleOrder->clear();
+    m_entries.clear();
+    m_current = 0;
+}
+
+void PlaybackQueue::setMissing(ItemId id, bool missing)
+{
+    auto it = m_entries.find(id);
+    if (it != m_entries.end()) {
+        it->missing = missing;
+    }
+}
+
+void PlaybackQueue::setDuration(ItemId id, qint64 durationMs)
+{
+    auto it = m_entries.find(id);
+    if (it != m_entries.end()) {
+        it->durationMs = durationMs;
+    }
+}
+
+void PlaybackQueue::setCurrent(ItemId id)
+{
+    m_current = m_entries.contains(id) ? id : 0;
+}
+
+void PlaybackQueue::setShuffled(bool shuffled)
+{
+    if (shuffled == m_shuffled) {
+        return;
+    }
+    m_shuffled = shuffled;
+    m_shuffleOrder->clear();
+    if (!shuffled) {
+        return;
+    }
+    
+    // 当前项放在最前，之后依次播放其余各项
+    QList<ItemId> ids = m_order->toList();
+    std::shuffle(ids.begin(), ids.end(), *QRandomGenerator::global());
+    if (m_current) {
+        auto it = std::find(ids.begin(), ids.end(), m_current);
+        std::iter_swap(ids.begin(), it);
+    }
+    m_shuffleOrder->insert(0, ids);
+}
+
+PlaybackQueue::ItemId PlaybackQueue::next(ItemId from, bool userRequested) const
+{
+    if (isEmpty()) {
+        return 0;
+    }
+    if (!userRequested && m_repeatMode == RepeatOne && contains(from)) {
+        return from;
+    }
+    
+    const SequenceTree *sequence = m_shuffled ? m_shuffleOrder : m_order;
+    if (!contains(from)) {
+        return sequence->at(0);
+    }
+    int index = sequence->indexOf(from) + 1;
+    if (index < sequence->size()) {
+        return sequence->at(index);
+    }
+    return (userRequested || m_repeatMode == RepeatAll) ? sequence->at(0) : 0;
+}
@@ -0,0 +1,83 @@
+#ifndef PLAYBACKQUEUE_H
+#define PLAYBACKQUEUE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+
+// 播放队列中的一项
+struct QueueEntry
+{
+    QString path;            // 绝对路径或网络地址
+    QString title;           // 显示名称
+    qint64 durationMs = -1;  // 已知的时长（如来自导入的列表），未知时为-1
+    bool missing = false;    // 文件已不存在
+};
+
+class SequenceTree;
+
+// 播放队列
+// 顺序保存在按子树大小索引的平衡树中，按位置插入、删除、移动单项或连续区间都是O(log n)；
+// 每一项有固定的编号，"正在播放"只记录编号，队列变化时无需修正。
+// 随机播放使用第二棵同样的树保存打乱后的顺序，新加入的项随机插入到当前项之后。
+class PlaybackQueue
+{
+public:
+    using ItemId = quint64;   // 0 表示无效
+    
+    enum RepeatMode {
+        RepeatOff,   // 播放到最后一项后停止
+        RepeatAll,   // 列表循环
+        RepeatOne    // 单个循环
+    };
+    
+    PlaybackQueue();
+    ~PlaybackQueue();
+    PlaybackQueue(const PlaybackQueue &) = delete;
+    PlaybackQueue &operator=(const PlaybackQueue &) = delete;
+    
+    int count() const;
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    bool contains(ItemId id) const { return m_entries.contains(id); }
+    
+    ItemId idAt(int index) const;
+    int indexOf(ItemId id) const;   // 不存在时返回-1
+    const QueueEntry &entry(ItemId id) const;
+    QList<ItemId> ids() const;      // 按队列顺序
+    
+    // 在index处插入，返回新项的编号
+    QList<ItemId> insert(int index, const QList<QueueEntry> &entries);
+    // 删除[index, index + count)，返回被删除项的编号
+    QList<ItemId> remove(int index, int count);
+    // 把[from, from + count)移动到删除后序列中的to位置
+    void move(int from, int count, int to);
+    // 按ids重新排列整个队列，ids必须恰好是队列中的全部编号，O(n)
+    void reorder(const QList<ItemId> &ids);
+    void clear();
+    
+    void setMissing(ItemId id, bool missing);
+    void setDuration(ItemId id, qint64 durationMs);
+    
+    ItemId current() const { return m_current; }
+    void setCurrent(ItemId id);
+    
+    bool isShuffled() const { return m_shuffled; }
+    void setShuffled(bool shuffled);
+    RepeatMode repeatMode() const { return m_repeatMode; }
+    void setRepeatMode(RepeatMode mode) { m_repeatMode = mode; }
+    
+    // from之后要播放的项，没有时返回0
+    // userRequested为true表示用户点击"下一个"：忽略单个循环，到末尾时总是回到开头
+    ItemId next(ItemId from, bool userRequested) const;
+
+private:
+    SequenceTree *m_order;
+    SequenceTree *m_shuffleOrder;
+    QHash<ItemId, QueueEntry> m_entries;
+    ItemId m_nextId;
+    ItemId m_current;
+    bool m_shuffled;
+    RepeatMode m_repeatMode;
+};
+
+#endif // PLAYBACKQUEUE_H
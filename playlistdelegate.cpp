@@ -0,0 +1,114 @@
+#include "playlistdelegate.h"
+#include "metadataprober.h"
+#include "thumbnailprovider.h"
+#include "timeformat.h"
+#include <QPainter>
+#include <QLocale>
+#include <QApplication>
+
+namespace {
+
+constexpr int HorizontalPadding = 8;   // 与播放列表样式表中条目的padding一致
+constexpr int DetailBottomMargin = 6;
+
+}
+
+PlaylistDelegate::PlaylistDelegate(MetadataProber *prober, ThumbnailProvider *thumbnails, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_prober(prober)
+    , m_thumbnails(thumbnails)
+{
+}
+
+void PlaylistDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
+{
+    QStyledItemDelegate::initStyleOption(option, index);
+    
+    // 缩略图作为条目图标绘制，未准备好时也保留位置，文字不会随之移动
+    option->features |= QStyleOptionViewItem::HasDecoration;
+    option->decorationSize = QSize(ThumbnailProvider::ImageWidth / 2, ThumbnailProvider::ImageHeight / 2);
+    option->decorationAlignment = Qt::AlignLeft | Qt::AlignVCenter;
+    QPixmap pixmap = m_thumbnails->thumbnail(index.data(Qt::UserRole).toString());
+    option->icon = pixmap.isNull() ? QIcon() : QIcon(pixmap);
+}
+
+QFont PlaylistDelegate::detailFont(const QFont &base) const
+{
+    QFont font = base;
+    if (base.pointSizeF() > 0) {
+        font.setPointSizeF(base.pointSizeF() * 0.85);
+    } else {
+        font.setPixelSize(qMax(1, qRound(base.pixelSize() * 0.85)));
+    }
+    return font;
+}
+
+QSize PlaylistDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+    // 缩略图跨越文件名和元数据两行，行高只由文字决定
+    opt.decorationSize.setHeight(0);
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+    QSize size = style->sizeFromContents(QStyle::CT_ItemViewItem, &opt, QSize(), opt.widget);
+    size.rheight() += QFontMetrics(detailFont(option.font)).height();
+    return size;
+}
+
+void PlaylistDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // 文件名靠上绘制，下方留出元数据行
+    QStyleOptionViewItem nameOption(option);
+    nameOption.displayAlignment = Qt::AlignLeft | Qt::AlignTop;
+    QStyledItemDelegate::paint(painter, nameOption, index);
+    
+    const MediaInfo *info = m_prober->info(index.data(Qt::UserRole).toString());
+    if (!info) {
+        return;
+    }
+    QString text = summary(*info);
+    if (text.isEmpty()) {
+        return;
+    }
+    
+    // 与文件名左对齐（缩略图右侧）
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+    int textLeft = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, opt.widget).left();
+    
+    QFont font = detailFont(option.font);
+    QRect textRect = option.rect.adjusted(HorizontalPadding, 0, -HorizontalPadding, -DetailBottomMargin);
+    textRect.setLeft(qMax(textRect.left(), textLeft));
+    text = QFontMetrics(font).elidedText(text, Qt::ElideRight, textRect.width());
+    
+    painter->save();
+    painter->setFont(font);
+    painter->setPen((option.state & QStyle::State_Selected) ? QColor(255, 255, 255, 200) : QColor("#888"));
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignBottom, text);
+    painter->restore();
+}
+
+QString PlaylistDelegate::summary(const MediaInfo &info)
+{
+    QStringList parts;
+    if (info.durationMs > 0) {
+        QChar buffer[TimeTextCapacity];
+        int length = formatTimeTo(info.durationMs, buffer);
+        parts << QString(buffer, length);
+    }
+    if (info.resolution.isValid()) {
+        parts << QString("%1×%2").arg(info.resolution.width()).arg(info.resolution.height());
+    }
+    if (!info.videoCodec.isEmpty()) {
+        parts << info.videoCodec;
+    }
+    if (info.bitRate > 0) {
+        parts << (info.bitRate >= 1000000 ? QString("%1 Mbps").arg(info.bitRate / 1e6, 0, 'f', 1)
+                                          : QString("%1 kbps").arg(info.bitRate / 1000));
+    }
+    if (info.fileSize >= 0) {
+        parts << QLocale().formattedDataSize(info.fileSize);
+    }
+    return parts.join(" · ");
+}
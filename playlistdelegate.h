@@ -0,0 +1,34 @@
+#ifndef PLAYLISTDELEGATE_H
+#define PLAYLISTDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+class MetadataProber;
+class ThumbnailProvider;
+struct MediaInfo;
+
+// 播放列表条目绘制：左侧为缩略图，文件名下方显示一行元数据（时长、分辨率、编码、码率、大小）
+// 所有行高度一致（未探测的行保留空行，缩略图未准备好时留出位置），列表可以继续使用统一行高。
+class PlaylistDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    PlaylistDelegate(MetadataProber *prober, ThumbnailProvider *thumbnails, QObject *parent = nullptr);
+    
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    
+    static QString summary(const MediaInfo &info);
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override;
+
+private:
+    QFont detailFont(const QFont &base) const;
+    
+    MetadataProber *m_prober;
+    ThumbnailProvider *m_thumbnails;
+};
+
+#endif // PLAYLISTDELEGATE_H
@@ -0,0 +1,127 @@
+#include "playlistio.h"
+#include "mediapath.h"
+#include <QFileInfo>
+#include <QUrl>
+
+M3uReader::M3uReader(const QString &filePath)
+    : m_file(filePath)
+    , m_baseDir(QFileInfo(filePath).absoluteDir())
+    , m_pendingDuration(-1)
+{
+}
+
+bool M3uReader::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    
+    // M3U8规定使用UTF-8，带BOM的文件按BOM识别
+    m_stream.setDevice(&m_file);
+    m_stream.setEncoding(QStringConverter::Utf8);
+    m_stream.setAutoDetectUnicode(true);
+    return true;
+}
+
+QList<M3uEntry> M3uReader::readBatch(int maxEntries)
+{
+    QList<M3uEntry> entries;
+    entries.reserve(maxEntries);
+    
+    QString line;
+    while (entries.size() < maxEntries && m_stream.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        
+        if (line.startsWith('#')) {
+            // #EXTINF:时长 [属性],标题
+            if (line.startsWith("#EXTINF:", Qt::CaseInsensitive)) {
+                // 属性值中可能含有逗号，跳过引号内的内容寻找标题分隔符
+                int comma = -1;
+                bool inQuotes = false;
+                for (int i = 8; i < line.size(); ++i) {
+                    if (line.at(i) == '"') {
+                        inQuotes = !inQuotes;
+                    } else if (line.at(i) == ',' && !inQuotes) {
+                        comma = i;
+                        break;
+                    }
+                }
+                QString info = (comma >= 0) ? line.mid(8, comma - 8) : line.mid(8);
+                bool ok = false;
+                double seconds = info.section(' ', 0, 0).toDouble(&ok);
+                m_pendingDuration = (ok && seconds >= 0) ? qint64(seconds * 1000) : -1;
+                m_pendingTitle = (comma >= 0) ? line.mid(comma + 1).trimmed() : QString();
+            }
+            continue;
+        }
+        
+        M3uEntry entry;
+        entry.path = resolvePath(line);
+        entry.title = m_pendingTitle;
+        entry.durationMs = m_pendingDuration;
+        entries.append(entry);
+        
+        m_pendingTitle.clear();
+        m_pendingDuration = -1;
+    }
+    return entries;
+}
+
+QString M3uReader::resolvePath(const QString &reference) const
+{
+    if (isStreamUrl(reference)) {
+        return reference;
+    }
+    if (reference.startsWith("file:", Qt::CaseInsensitive)) {
+        return QUrl(reference).toLocalFile();
+    }
+    
+    // 兼容Windows生成的列表中的反斜杠
+    QString path = reference;
+    path.replace('\\', '/');
+    return QDir::cleanPath(m_baseDir.absoluteFilePath(path));
+}
+
+M3uWriter::M3uWriter(const QString &filePath)
+    : m_file(filePath)
+    , m_baseDir(QFileInfo(filePath).absoluteDir())
+{
+}
+
+bool M3uWriter::open()
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    
+    m_stream.setDevice(&m_file);
+    m_stream.setEncoding(QStringConverter::Utf8);
+    m_stream << "#EXTM3U\n";
+    return true;
+}
+
+void M3uWriter::writeEntry(const M3uEntry &entry)
+{
+    // 播放列表所在目录下的文件写成相对路径，便于整体移动
+    QString path = entry.path;
+    if (!isStreamUrl(path)) {
+        QString relative = m_baseDir.relativeFilePath(path);
+        if (!relative.startsWith("..")) {
+            path = relative;
+        }
+    }
+    
+    qint64 seconds = entry.durationMs >= 0 ? entry.durationMs / 1000 : -1;
+    m_stream << "#EXTINF:" << seconds << ',' << entry.title << '\n' << path << '\n';
+}
+
+bool M3uWriter::close()
+{
+    m_stream.flush();
+    bool ok = m_stream.status() == QTextStream::Ok;
+    m_file.close();
+    return ok && m_file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,59 @@
+#ifndef PLAYLISTIO_H
+#define PLAYLISTIO_H
+
+#include <QFile>
+#include <QTextStream>
+#include <QDir>
+#include <QList>
+
+// M3U/M3U8播放列表中的一条记录
+struct M3uEntry
+{
+    QString path;        // 绝对路径或网络地址
+    QString title;       // #EXTINF中的标题，可能为空
+    qint64 durationMs;   // #EXTINF中的时长，未知时为-1
+};
+
+// 流式M3U/M3U8读取器
+// 按批读取条目，不会一次性把整个文件读入内存；相对路径按播放列表所在目录解析。
+// 读取时不检查文件是否存在，由调用方在播放时再处理。
+class M3uReader
+{
+public:
+    explicit M3uReader(const QString &filePath);
+    
+    bool open();
+    QString errorString() const { return m_file.errorString(); }
+    
+    // 读取最多maxEntries条记录
+    QList<M3uEntry> readBatch(int maxEntries);
+    bool atEnd() const { return m_stream.atEnd(); }
+
+private:
+    QString resolvePath(const QString &reference) const;
+    
+    QFile m_file;
+    QTextStream m_stream;
+    QDir m_baseDir;
+    QString m_pendingTitle;
+    qint64 m_pendingDuration;
+};
+
+// 流式M3U8写入器，逐条写出（UTF-8编码）
+class M3uWriter
+{
+public:
+    explicit M3uWriter(const QString &filePath);
+    
+    bool open();
+    QString errorString() const { return m_file.errorString(); }
+    void writeEntry(const M3uEntry &entry);
+    bool close();
+
+private:
+    QFile m_file;
+    QTextStream m_stream;
+    QDir m_baseDir;
+};
+
+#endif // PLAYLISTIO_H
@@ -0,0 +1,375 @@
+#include "playlistmodel.h"
+#include <QColor>
+#include <QFont>
+#include <QSet>
+#include <QFileInfo>
+#include <QDateTime>
+#include <numeric>
+#include <algorithm>
+
+namespace {
+
+// 只把ASCII数字当作数字，其他文字的数字字符按普通字符排序
+bool isAsciiDigit(QChar c)
+{
+    return c >= QLatin1Char('0') && c <= QLatin1Char('9');
+}
+
+// 把每段数字去掉前导零，前面加上两位的位数，逐字符比较即等于按数值比较
+// （位数少的数值小，位数相同时逐位比较），这样"第2集"排在"第10集"之前，
+// 且不依赖排序规则后端是否支持数字模式；每段只多出两个字符
+QString naturalText(const QString &text)
+{
+    QString result;
+    result.reserve(text.size() + 8);
+    int i = 0;
+    while (i < text.size()) {
+        if (!isAsciiDigit(text.at(i))) {
+            result.append(text.at(i++));
+            continue;
+        }
+        int start = i;
+        while (i < text.size() && isAsciiDigit(text.at(i))) {
+            ++i;
+        }
+        int firstNonZero = start;
+        while (firstNonZero < i - 1 && text.at(firstNonZero) == QLatin1Char('0')) {
+            ++firstNonZero;
+        }
+        int length = i - firstNonZero;
+        int prefix = qMin(length, 99);
+        result.append(QLatin1Char(char('0' + prefix / 10)));
+        result.append(QLatin1Char(char('0' + prefix % 10)));
+        result.append(QStringView(text).mid(firstNonZero, length));
+    }
+    return result;
+}
+
+}
+
+PlaylistModel::PlaylistModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+}
+
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_queue.count();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_queue.count()) {
+        return QVariant();
+    }
+    
+    ItemId id = m_queue.idAt(index.row());
+    const QueueEntry &entry = m_queue.entry(id);
+    switch (role) {
+    case Qt::DisplayRole:
+        return entry.title;
+    case Qt::ToolTipRole:
+        return entry.missing ? entry.path + "\n(文件不存在)" : entry.path;
+    case Qt::UserRole:
+        return entry.path;
+    case Qt::ForegroundRole:
+        return entry.missing ? QVariant(QColor(Qt::gray)) : QVariant();
+    case Qt::FontRole:
+        if (id == m_queue.current()) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        return QVariant();
+    case PlaylistDurationRole:
+        return entry.durationMs >= 0 ? QVariant(entry.durationMs) : QVariant();
+    case PlaylistMissingRole:
+        return entry.missing;
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex &index) const
+{
+    // 只允许放在条目之间，不能放到条目上
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions PlaylistModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+bool PlaylistModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > m_queue.count()) {
+        return false;
+    }
+    
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    QStringList removedPaths;
+    removedPaths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        removedPaths.append(pathAt(row + i));
+    }
+    const QList<ItemId> removedIds = m_queue.remove(row, count);
+    for (const QString &path : std::as_const(removedPaths)) {
+        m_pathIds.remove(path);
+    }
+    for (ItemId id : removedIds) {
+        forgetSortKeys(id);
+    }
+    endRemoveRows();
+    return true;
+}
+
+bool PlaylistModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                             const QModelIndex &destinationParent, int destinationChild)
+{
+    if (sourceParent.isValid() || destinationParent.isValid() || count <= 0
+        || sourceRow < 0 || sourceRow + count > m_queue.count()
+        || destinationChild < 0 || destinationChild > m_queue.count()
+        || (destinationChild >= sourceRow && destinationChild <= sourceRow + count)) {
+        return false;
+    }
+    
+    // destinationChild是移动前的位置，队列使用移除后的位置
+    beginMoveRows(QModelIndex(), sourceRow, sourceRow + count - 1, QModelIndex(), destinationChild);
+    int to = destinationChild > sourceRow ? destinationChild - count : destinationChild;
+    m_queue.move(sourceRow, count, to);
+    endMoveRows();
+    return true;
+}
+
+void PlaylistModel::append(const QList<QueueEntry> &entries)
+{
+    QList<QueueEntry> newEntries;
+    newEntries.reserve(entries.size());
+    for (const QueueEntry &entry : entries) {
+        if (!m_pathIds.contains(entry.path)) {
+            m_pathIds.insert(entry.path, 0);
+            newEntries.append(entry);
+        }
+    }
+    if (newEntries.isEmpty()) {
+        return;
+    }
+    
+    int first = m_queue.count();
+    beginInsertRows(QModelIndex(), first, first + int(newEntries.size()) - 1);
+    const QList<ItemId> ids = m_queue.insert(first, newEntries);
+    for (int i = 0; i < ids.size(); ++i) {
+        m_pathIds.insert(newEntries.at(i).path, ids.at(i));
+    }
+    endInsertRows();
+}
+
+void PlaylistModel::clear()
+{
+    beginResetModel();
+    m_queue.clear();
+    m_pathIds.clear();
+    m_nameKeys.clear();
+    m_fileStats.clear();
+    endResetModel();
+}
+
+void PlaylistModel::moveItems(const QList<ItemId> &ids, int row)
+{
+    // 以放置位置之后第一个不移动的项为锚点，依次把各项移到锚点之前
+    QSet<ItemId> moving(ids.cbegin(), ids.cend());
+    ItemId anchor = 0;
+    for (int i = qMax(0, row); i < m_queue.count(); ++i) {
+        ItemId id = m_queue.idAt(i);
+        if (!moving.contains(id)) {
+            anchor = id;
+            break;
+        }
+    }
+    
+    // 按给定顺序相邻、在队列中也相邻的项合成一段，每段只移动一次，
+    // 视图只需为每段重新布局一次；移动其他段不会拆开一段
+    QList<QPair<ItemId, int>> runs;   // 每段的第一项和长度
+    int lastIndex = -2;
+    for (ItemId id : ids) {
+        int index = m_queue.indexOf(id);
+        if (index < 0) {
+            continue;
+        }
+        if (!runs.isEmpty() && index == lastIndex + 1) {
+            ++runs.last().second;
+        } else {
+            runs.append({id, 1});
+        }
+        lastIndex = index;
+    }
+    
+    for (const QPair<ItemId, int> &run : std::as_const(runs)) {
+        int from = m_queue.indexOf(run.first);
+        int target = anchor ? m_queue.indexOf(anchor) : m_queue.count();
+        if (from + run.second == target) {
+            continue;
+        }
+        moveRows(QModelIndex(), from, run.second, QModelIndex(), target);
+    }
+}
+
+QStringList PlaylistModel::paths() const
+{
+    const QList<ItemId> ids = m_queue.ids();
+    QStringList result;
+    result.reserve(ids.size());
+    for (ItemId id : ids) {
+        result.append(m_queue.entry(id).path);
+    }
+    return result;
+}
+
+void PlaylistModel::setCurrent(ItemId id)
+{
+    ItemId previous = m_queue.current();
+    m_queue.setCurrent(id);
+    if (previous != m_queue.current()) {
+        emitRowChanged(previous);
+        emitRowChanged(m_queue.current());
+    }
+}
+
+void PlaylistModel::setMissing(ItemId id)
+{
+    if (m_queue.contains(id) && !m_queue.entry(id).missing) {
+        m_queue.setMissing(id, true);
+        m_fileStats.remove(id);
+        emitRowChanged(id);
+    }
+}
+
+void PlaylistModel::emitRowChanged(ItemId id)
+{
+    int row = id ? m_queue.indexOf(id) : -1;
+    if (row >= 0) {
+        QModelIndex changed = index(row);
+        emit dataChanged(changed, changed);
+    }
+}
+
+void PlaylistModel::setDuration(ItemId id, qint64 durationMs)
+{
+    if (m_queue.contains(id) && m_queue.entry(id).durationMs != durationMs) {
+        m_queue.setDuration(id, durationMs);
+        emitRowChanged(id);
+    }
+}
+
+void PlaylistModel::sortBy(SortKey key, Qt::SortOrder order)
+{
+    const QList<ItemId> ids = m_queue.ids();
+    if (ids.size() < 2) {
+        return;
+    }
+    
+    // 先取出每一项的键，排序时只比较数组中的值
+    QList<int> positions(ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    bool descending = order == Qt::DescendingOrder;
+    if (key == SortByName) {
+        // 排序键是隐式共享的，复制只增加引用计数
+        QList<QCollatorSortKey> keys;
+        keys.reserve(ids.size());
+        for (ItemId id : ids) {
+            keys.append(nameKey(id));
+        }
+        std::stable_sort(positions.begin(), positions.end(), [&keys, descending](int a, int b) {
+            int result = keys.at(a).compare(keys.at(b));
+            return descending ? result > 0 : result < 0;
+        });
+    } else {
+        QList<qint64> values;
+        values.reserve(ids.size());
+        for (ItemId id : ids) {
+            switch (key) {
+            case SortByModified:
+                values.append(fileStat(id).modified);
+                break;
+            case SortBySize:
+                values.append(fileStat(id).size);
+                break;
+            default:
+                values.append(m_queue.entry(id).durationMs);
+                break;
+            }
+        }
+        // 未知的值（-1）无论升序降序都排在最后
+        std::stable_sort(positions.begin(), positions.end(), [&values, descending](int a, int b) {
+            qint64 left = values.at(a);
+            qint64 right = values.at(b);
+            if (left < 0 || right < 0) {
+                return left >= 0 && right < 0;
+            }
+            return descending ? left > right : left < right;
+        });
+    }
+    
+    QList<ItemId> sortedIds;
+    sortedIds.reserve(ids.size());
+    for (int position : std::as_const(positions)) {
+        sortedIds.append(ids.at(position));
+    }
+    
+    // 持久索引（选中项、当前项）按编号找回新位置
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QList<ItemId> persistentIds;
+    persistentIds.reserve(oldIndexes.size());
+    for (const QModelIndex &oldIndex : oldIndexes) {
+        persistentIds.append(m_queue.idAt(oldIndex.row()));
+    }
+    m_queue.reorder(sortedIds);
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (ItemId id : std::as_const(persistentIds)) {
+        newIndexes.append(index(m_queue.indexOf(id)));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+QCollatorSortKey PlaylistModel::nameKey(ItemId id)
+{
+    auto it = m_nameKeys.constFind(id);
+    if (it == m_nameKeys.constEnd()) {
+        it = m_nameKeys.insert(id, m_collator.sortKey(naturalText(m_queue.entry(id).title)));
+    }
+    return it.value();
+}
+
+PlaylistModel::FileStat PlaylistModel::fileStat(ItemId id)
+{
+    auto it = m_fileStats.constFind(id);
+    if (it == m_fileStats.constEnd()) {
+        FileStat stat;
+        QFileInfo fileInfo(m_queue.entry(id).path);
+        if (fileInfo.exists()) {
+            stat.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+            stat.size = fileInfo.size();
+        }
+        it = m_fileStats.insert(id, stat);
+    }
+    return it.value();
+}
+
+void PlaylistModel::refreshFileStats()
+{
+    m_fileStats.clear();
+}
+
+void PlaylistModel::forgetSortKeys(ItemId id)
+{
+    m_nameKeys.remove(id);
+    m_fileStats.remove(id);
+}
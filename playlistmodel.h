@@ -0,0 +1,87 @@
+#ifndef PLAYLISTMODEL_H
+#define PLAYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QHash>
+#include "playbackqueue.h"
+
+// 播放列表项的数据角色（Qt::UserRole保存文件路径）
+enum PlaylistItemRole {
+    PlaylistDurationRole = Qt::UserRole + 1,  // 时长（毫秒），未知时为空
+    PlaylistMissingRole                        // 文件已不存在
+};
+
+// 播放列表模型，数据保存在PlaybackQueue中
+// 当前播放项以粗体显示；拖拽移动由视图调用moveItems完成。
+class PlaylistModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    using ItemId = PlaybackQueue::ItemId;
+    
+    enum SortKey {
+        SortByName,       // 文件名，数字按数值比较
+        SortByModified,   // 修改时间
+        SortBySize,       // 文件大小
+        SortByDuration    // 时长，未知的排在最后
+    };
+    
+    explicit PlaylistModel(QObject *parent = nullptr);
+    
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    Qt::DropActions supportedDropActions() const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override;
+    
+    const PlaybackQueue &queue() const { return m_queue; }
+    
+    void append(const QList<QueueEntry> &entries);
+    void clear();
+    // 把ids（按给定顺序）移动到row之前，row为移动前的位置
+    void moveItems(const QList<ItemId> &ids, int row);
+    
+    bool containsPath(const QString &path) const { return m_pathIds.contains(path); }
+    ItemId idOfPath(const QString &path) const { return m_pathIds.value(path); }
+    ItemId idAt(int row) const { return m_queue.idAt(row); }
+    int rowOf(ItemId id) const { return m_queue.indexOf(id); }
+    QString pathAt(int row) const { return m_queue.entry(m_queue.idAt(row)).path; }
+    QStringList paths() const;
+    
+    void setCurrent(ItemId id);
+    void setMissing(ItemId id);
+    void setDuration(ItemId id, qint64 durationMs);
+    
+    // 重新排列整个列表，相同的项保持原有先后；选中状态和当前项随之移动
+    // 排序键按项缓存，第一次排序时计算，之后的排序只比较缓存的键
+    void sortBy(SortKey key, Qt::SortOrder order = Qt::AscendingOrder);
+    // 文件可能已被修改，丢弃缓存的修改时间和大小，下次排序时重新读取
+    void refreshFileStats();
+    void setShuffled(bool shuffled) { m_queue.setShuffled(shuffled); }
+    void setRepeatMode(PlaybackQueue::RepeatMode mode) { m_queue.setRepeatMode(mode); }
+
+private:
+    struct FileStat
+    {
+        qint64 modified = -1;   // 毫秒时间戳，网络地址为-1
+        qint64 size = -1;
+    };
+    
+    void emitRowChanged(ItemId id);
+    QCollatorSortKey nameKey(ItemId id);
+    FileStat fileStat(ItemId id);
+    void forgetSortKeys(ItemId id);
+    
+    PlaybackQueue m_queue;
+    QHash<QString, ItemId> m_pathIds;   // 用于去重和按路径查找
+    QCollator m_collator;
+    QHash<ItemId, QCollatorSortKey> m_nameKeys;
+    QHash<ItemId, FileStat> m_fileStats;
+};
+
+#endif // PLAYLISTMODEL_H
@@ -0,0 +1,358 @@
+#include "readaheaddevice.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QStorageInfo>
+#include <QDir>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+const qint64 PageSize = 4096;
+
+// 文件是否位于本地文件系统（网络共享上不使用内存映射）
+bool isLocalFileSystem(const QString &filePath)
+{
+    QString nativePath = QDir::toNativeSeparators(filePath);
+    if (nativePath.startsWith("\\\\") || filePath.startsWith("//")) {
+        return false;
+    }
+    QStorageInfo storage(filePath);
+    if (!storage.isValid()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    QString root = QDir::toNativeSeparators(storage.rootPath());
+    if (GetDriveTypeW(reinterpret_cast<LPCWSTR>(root.utf16())) == DRIVE_REMOTE) {
+        return false;
+    }
+#endif
+    static const QList<QByteArray> NetworkTypes = {
+        "nfs", "nfs4", "cifs", "smbfs", "smb2", "smb3", "afs", "9p", "ceph",
+        "glusterfs", "davfs", "webdav", "fuse.sshfs", "fuse.rclone", "lustre", "gpfs"
+    };
+    QByteArray type = storage.fileSystemType().toLower();
+    return !NetworkTypes.contains(type);
+}
+}
+
+ReadAheadDevice::ReadAheadDevice(const QString &filePath, QObject *parent, qint64 bufferSize)
+    : QIODevice(parent)
+    , m_filePath(filePath)
+    , m_mapFile(filePath)
+    , m_map(nullptr)
+    , m_ioThread(nullptr)
+    , m_capacity(qMax(bufferSize, 4 * ChunkSize))
+    , m_keepBehind(m_capacity / 4)
+    , m_fileSize(0)
+    , m_readPos(0)
+    , m_windowStart(0)
+    , m_windowEnd(0)
+    , m_generation(0)
+    , m_mappedReads(0)
+    , m_stopping(false)
+    , m_ioError(false)
+{
+}
+
+ReadAheadDevice::~ReadAheadDevice()
+{
+    close();
+}
+
+bool ReadAheadDevice::open(OpenMode mode)
+{
+    if (isOpen() || (mode & WriteOnly)) {
+        return false;
+    }
+    
+    if (!m_mapFile.open(QIODevice::ReadOnly)) {
+        setErrorString(m_mapFile.errorString());
+        return false;
+    }
+    m_fileSize = m_mapFile.size();
+    
+    // 本地文件优先使用内存映射，网络共享或映射失败时退回环形缓冲区
+    if (isLocalFileSystem(m_filePath)) {
+        m_map = m_mapFile.map(0, m_fileSize);
+    }
+    if (!m_map) {
+        m_mapFile.close();
+        m_ring.resize(m_capacity);
+    }
+    
+    m_readPos = 0;
+    m_windowStart = 0;
+    m_windowEnd = 0;
+    m_stopping = false;
+    m_ioError = false;
+    
+    // 自行缓冲，关闭QIODevice内部的缓冲
+    QIODevice::open(mode | Unbuffered);
+    
+    m_ioThread = QThread::create([this]() { ioLoop(); });
+    m_ioThread->start(QThread::LowPriority);
+    return true;
+}
+
+void ReadAheadDevice::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    
+    abort();
+    if (m_ioThread) {
+        m_ioThread->wait();
+        delete m_ioThread;
+        m_ioThread = nullptr;
+    }
+    {
+        // 等待不持锁的映射内存拷贝结束后再解除映射
+        QMutexLocker locker(&m_mutex);
+        while (m_mappedReads > 0) {
+            m_dataReady.wait(&m_mutex);
+        }
+    }
+    
+    if (m_map) {
+        m_mapFile.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_mapFile.close();
+    m_ring.clear();
+    
+    QIODevice::close();
+}
+
+void ReadAheadDevice::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_dataWanted.wakeAll();
+    m_dataReady.wakeAll();
+}
+
+qint64 ReadAheadDevice::size() const
+{
+    return m_fileSize;
+}
+
+bool ReadAheadDevice::seek(qint64 pos)
+{
+    if (pos < 0 || pos > m_fileSize || !QIODevice::seek(pos)) {
+        return false;
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    m_readPos = pos;
+    // 目标位置在缓冲区内时只移动读取位置，不产生I/O
+    if (pos < m_windowStart || pos > m_windowEnd) {
+        resetWindow(pos);
+    }
+    m_dataWanted.wakeOne();
+    return true;
+}
+
+qint64 ReadAheadDevice::bufferedBytes() const
+{
+    // 不加锁，两个位置可能分属前后两次更新，结果只用于显示
+    qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    return qMax<qint64>(0, m_windowEnd.load(std::memory_order_relaxed) - readPos);
+}
+
+qreal ReadAheadDevice::fillLevel() const
+{
+    qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    qint64 wanted = qMin(m_capacity - m_keepBehind, m_fileSize - readPos);
+    if (wanted <= 0) {
+        return 1.0;
+    }
+    return qBound<qreal>(0.0, qreal(m_windowEnd.load(std::memory_order_relaxed) - readPos) / wanted, 1.0);
+}
+
+qint64 ReadAheadDevice::readData(char *data, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    if (m_readPos >= m_fileSize) {
+        return 0;
+    }
+    
+    if (m_map) {
+        // 内存映射：直接拷贝，预读线程只负责提前调入页面
+        // 拷贝时可能缺页阻塞，不持有锁，界面线程和预读线程不受影响
+        if (m_stopping) {
+            return -1;
+        }
+        qint64 pos = m_readPos;
+        qint64 count = qMin(maxSize, m_fileSize - pos);
+        ++m_mappedReads;
+        locker.unlock();
+        std::memcpy(data, m_map + pos, size_t(count));
+        locker.relock();
+        --m_mappedReads;
+        if (m_mappedReads == 0) {
+            m_dataReady.wakeAll();
+        }
+        // 拷贝期间发生跳转时保留跳转后的位置
+        if (m_readPos == pos) {
+            m_readPos = pos + count;
+            if (m_readPos > m_windowEnd) {
+                m_windowEnd = m_readPos.load();
+            }
+        }
+        m_dataWanted.wakeOne();
+        return count;
+    }
+    
+    // 等待预读线程把读取位置的数据放入缓冲区
+    while (m_readPos < m_windowStart || m_readPos >= m_windowEnd) {
+        if (m_stopping || m_ioError) {
+            return -1;
+        }
+        if (m_readPos < m_windowStart || m_readPos > m_windowEnd) {
+            resetWindow(m_readPos);
+        }
+        m_dataWanted.wakeOne();
+        m_dataReady.wait(&m_mutex);
+    }
+    
+    qint64 count = qMin(maxSize, m_windowEnd - m_readPos);
+    qint64 offset = m_readPos % m_capacity;
+    qint64 firstPart = qMin(count, m_capacity - offset);
+    std::memcpy(data, m_ring.constData() + offset, size_t(firstPart));
+    if (firstPart < count) {
+        std::memcpy(data + firstPart, m_ring.constData(), size_t(count - firstPart));
+    }
+    m_readPos += count;
+    
+    // 读走数据后腾出了空间，通知预读线程继续
+    m_dataWanted.wakeOne();
+    return count;
+}
+
+qint64 ReadAheadDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+void ReadAheadDevice::resetWindow(qint64 pos)
+{
+    // 调用方需持有m_mutex
+    m_windowStart = pos;
+    m_windowEnd = pos;
+    ++m_generation;
+}
+
+qint64 ReadAheadDevice::readAheadLimit() const
+{
+    // 调用方需持有m_mutex
+    // 保留读取位置之前的一部分数据，向后的小幅跳转同样无需I/O
+    return qMin(m_fileSize, m_readPos + m_capacity - m_keepBehind);
+}
+
+void ReadAheadDevice::ioLoop()
+{
+    if (m_map) {
+        prefetchMapped();
+        return;
+    }
+    
+    // 预读线程使用自己的文件句柄
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMutexLocker locker(&m_mutex);
+        m_ioError = true;
+        m_dataReady.wakeAll();
+        return;
+    }
+    
+    QByteArray chunk(ChunkSize, Qt::Uninitialized);
+    fillRing(file, chunk);
+}
+
+void ReadAheadDevice::fillRing(QFile &file, QByteArray &chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        qint64 target = m_windowEnd;
+        qint64 limit = readAheadLimit();
+        if (target >= limit) {
+            m_dataWanted.wait(&m_mutex);
+            continue;
+        }
+        
+        qint64 length = qMin(ChunkSize, limit - target);
+        quint64 generation = m_generation;
+        
+        // 读文件时不持有锁，读取方可以继续消费缓冲区中的数据
+        locker.unlock();
+        qint64 count = -1;
+        if (file.seek(target)) {
+            count = file.read(chunk.data(), length);
+        }
+        locker.relock();
+        
+        if (generation != m_generation) {
+            // 读取期间发生了跳出缓冲区的跳转，丢弃这块数据
+            continue;
+        }
+        if (count <= 0) {
+            m_ioError = true;
+            m_dataReady.wakeAll();
+            return;
+        }
+        
+        qint64 offset = target % m_capacity;
+        qint64 firstPart = qMin(count, m_capacity - offset);
+        std::memcpy(m_ring.data() + offset, chunk.constData(), size_t(firstPart));
+        if (firstPart < count) {
+            std::memcpy(m_ring.data(), chunk.constData() + firstPart, size_t(count - firstPart));
+        }
+        m_windowEnd += count;
+        m_windowStart = qMax(m_windowStart, m_windowEnd - m_capacity);
+        m_dataReady.wakeAll();
+    }
+}
+
+void ReadAheadDevice::prefetchMapped()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        qint64 target = qMax(m_windowEnd.load(), m_readPos.load());
+        qint64 limit = readAheadLimit();
+        if (target >= limit) {
+            m_dataWanted.wait(&m_mutex);
+            continue;
+        }
+        
+        qint64 length = qMin(ChunkSize, limit - target);
+        quint64 generation = m_generation;
+        locker.unlock();
+        
+#ifdef Q_OS_UNIX
+        // 提示内核提前读入，再逐页访问确保页面已调入内存
+        qint64 alignedStart = target - target % PageSize;
+        posix_madvise(m_map + alignedStart, size_t(target + length - alignedStart), POSIX_MADV_WILLNEED);
+#endif
+        volatile uchar sink = 0;
+        for (qint64 offset = target; offset < target + length; offset += PageSize) {
+            sink = sink + m_map[offset];
+        }
+        Q_UNUSED(sink);
+        
+        locker.relock();
+        if (generation == m_generation) {
+            m_windowEnd = qMax(m_windowEnd.load(), target + length);
+            m_windowStart = qMax(m_windowStart, m_windowEnd - m_capacity);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef READAHEADDEVICE_H
+#define READAHEADDEVICE_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <atomic>
+
+class QThread;
+
+// 预读缓冲设备，作为QMediaPlayer::setSourceDevice()的数据源
+// 独立的I/O线程按大块顺序预读到环形缓冲区，适用于网络共享和慢速磁盘；
+// 本地文件系统上改用内存映射，I/O线程负责提前把后续页面读入内存；
+// 网络文件系统上缺页可能长时间阻塞，映射失效时还会触发SIGBUS，因此只用环形缓冲区。
+// 落在缓冲区内的跳转直接从内存读取，不产生I/O。
+class ReadAheadDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit ReadAheadDevice(const QString &filePath, QObject *parent = nullptr,
+                             qint64 bufferSize = DefaultBufferSize);
+    ~ReadAheadDevice() override;
+    
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override;
+    bool seek(qint64 pos) override;
+    
+    // 中止所有阻塞中的读取（切换媒体源前调用）
+    void abort();
+    
+    // 读取位置之后已缓冲的字节数和缓冲区填充程度（0.0 - 1.0）
+    qint64 bufferedBytes() const;
+    qreal fillLevel() const;
+    bool isMemoryMapped() const { return m_map != nullptr; }
+    
+    static constexpr qint64 DefaultBufferSize = 64 * 1024 * 1024;
+    static constexpr qint64 ChunkSize = 1024 * 1024;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    void ioLoop();
+    void fillRing(QFile &file, QByteArray &chunk);
+    void prefetchMapped();
+    void resetWindow(qint64 pos);
+    qint64 readAheadLimit() const;
+    
+    QString m_filePath;
+    QFile m_mapFile;
+    uchar *m_map;
+    QThread *m_ioThread;
+    
+    mutable QMutex m_mutex;
+    QWaitCondition m_dataReady;   // I/O线程 -> 读取方：有新数据
+    QWaitCondition m_dataWanted;  // 读取方 -> I/O线程：需要继续预读
+    
+    // 以下成员受m_mutex保护
+    // m_readPos和m_windowEnd只在持锁时修改，但用原子变量保存，
+    // 界面线程查询填充程度时不加锁，不会被阻塞中的读取拖住
+    QByteArray m_ring;
+    qint64 m_capacity;
+    qint64 m_keepBehind;
+    qint64 m_fileSize;
+    std::atomic<qint64> m_readPos;
+    qint64 m_windowStart;         // 缓冲区中最早字节的文件偏移
+    std::atomic<qint64> m_windowEnd;   // 缓冲区中最后字节之后的文件偏移
+    quint64 m_generation;         // 跳转出缓冲区时递增，丢弃过期的读取结果
+    int m_mappedReads;            // 不持锁拷贝映射内存的读取数，关闭时等待其结束
+    bool m_stopping;
+    bool m_ioError;
+};
+
+#endif // READAHEADDEVICE_H
@@ -0,0 +1,214 @@
+#include "scenedetector.h"
+#include "simdkernels.h"
+#include "videoframeutils.h"
+#include "tracer.h"
+#include <QVideoSink>
+#include <QThread>
+#include <QUrl>
+#include <cstring>
+
+namespace {
+
+constexpr int SamplePixels = SceneDetector::SampleWidth * SceneDetector::SampleHeight;
+constexpr int HistogramBins = 32;
+constexpr qint64 MinSampleIntervalMs = 40;   // 高帧率视频只取每40ms一帧
+constexpr qint64 MinSampleWallMs = 25;       // 高倍速下按实际时间再限制，每秒最多约40帧
+constexpr int MaxFramesInFlight = 2;         // 工作线程跟不上时直接丢帧，不堆积解码后的帧
+constexpr qint64 MinChapterLengthMs = 2000;  // 闪光、快速剪辑不单独成章
+constexpr qreal MinCutScore = 0.30;
+constexpr qreal AdaptiveFactor = 3.0;        // 切换得分需显著高于近期平均变化
+
+}
+
+// 运行在工作线程中的分析器，只在工作线程中访问
+class SceneAnalyzer : public QObject
+{
+public:
+    void reset(quint64 session)
+    {
+        m_session = session;
+        m_hasPrevious = false;
+        m_averageScore = 0.0;
+        m_lastCut = 0;
+        m_cuts.clear();
+    }
+    
+    void processFrame(quint64 session, const QVideoFrame &frame, qint64 timestampMs)
+    {
+        if (session != m_session) {
+            return;
+        }
+        TraceScope scope("镜头检测");
+        
+        // 映射（GPU帧需要下载）和缩小采样都在工作线程中完成
+        quint8 pixels[SamplePixels];
+        if (!VideoFrameUtils::downscaleLuma(frame, pixels, SceneDetector::SampleWidth, SceneDetector::SampleHeight)) {
+            return;
+        }
+        quint32 histogram[HistogramBins] = {};
+        SimdKernels::histogramU8(pixels, SamplePixels, histogram, HistogramBins);
+        
+        if (m_hasPrevious) {
+            // 直方图差对运动不敏感，逐像素差对亮度分布相近的切换敏感，两者取平均
+            qreal histogramDiff = qreal(SimdKernels::sumAbsDiffU32(histogram, m_previousHistogram, HistogramBins))
+                                  / (2.0 * SamplePixels);
+            qreal pixelDiff = qreal(SimdKernels::sumAbsDiffU8(pixels, m_previousLuma, SamplePixels))
+                              / (255.0 * SamplePixels);
+            qreal score = (histogramDiff + pixelDiff) / 2.0;
+            
+            bool isCut = score > MinCutScore
+                         && score > m_averageScore * AdaptiveFactor
+                         && timestampMs - m_lastCut >= MinChapterLengthMs;
+            if (isCut) {
+                m_cuts.append(timestampMs);
+                m_lastCut = timestampMs;
+            } else {
+                // 切点不计入平均值，避免一次切换抬高后续阈值
+                m_averageScore = m_averageScore * 0.9 + score * 0.1;
+            }
+        }
+        
+        memcpy(m_previousLuma, pixels, SamplePixels);
+        memcpy(m_previousHistogram, histogram, sizeof(histogram));
+        m_hasPrevious = true;
+    }
+    
+    QList<qint64> cuts() const { return m_cuts; }
+    quint64 session() const { return m_session; }
+
+private:
+    quint64 m_session = 0;
+    bool m_hasPrevious = false;
+    qreal m_averageScore = 0.0;
+    qint64 m_lastCut = 0;
+    quint8 m_previousLuma[SamplePixels];
+    quint32 m_previousHistogram[HistogramBins];
+    QList<qint64> m_cuts;
+};
+
+SceneDetector::SceneDetector(QObject *parent)
+    : QObject(parent)
+    , m_player(nullptr)
+    , m_videoSink(nullptr)
+    , m_workerThread(nullptr)
+    , m_analyzer(nullptr)
+    , m_session(0)
+    , m_lastSampleTime(-1)
+    , m_framesInFlight(0)
+{
+    m_player = new QMediaPlayer(this);
+    m_videoSink = new QVideoSink(this);
+    m_player->setVideoSink(m_videoSink);
+    
+    m_analyzer = new SceneAnalyzer;
+    m_workerThread = new QThread(this);
+    m_analyzer->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_analyzer, &QObject::deleteLater);
+    m_workerThread->start(QThread::LowestPriority);
+    
+    connect(m_videoSink, &QVideoSink::videoFrameChanged, this, &SceneDetector::onVideoFrameChanged);
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &SceneDetector::onMediaStatusChanged);
+}
+
+SceneDetector::~SceneDetector()
+{
+    cancel();
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void SceneDetector::start(const QString &filePath, const QString &videoHash)
+{
+    cancel();
+    
+    m_videoHash = videoHash;
+    m_lastSampleTime = -1;
+    m_sampleClock.invalidate();
+    quint64 session = ++m_session;
+    SceneAnalyzer *analyzer = m_analyzer;
+    QMetaObject::invokeMethod(m_analyzer, [analyzer, session]() {
+        analyzer->reset(session);
+    }, Qt::QueuedConnection);
+    
+    // 没有音频输出，解码出的音频直接丢弃；高倍速下后端会跳过部分帧，足够检测切换
+    m_player->setSource(QUrl::fromLocalFile(filePath));
+    m_player->setPlaybackRate(AnalysisPlaybackRate);
+    m_player->play();
+}
+
+void SceneDetector::cancel()
+{
+    if (m_videoHash.isEmpty()) {
+        return;
+    }
+    // 递增会话号，工作线程中尚未处理的帧和结果都会被丢弃
+    ++m_session;
+    m_videoHash.clear();
+    m_player->stop();
+    m_player->setSource(QUrl());
+}
+
+void SceneDetector::onVideoFrameChanged(const QVideoFrame &frame)
+{
+    if (m_videoHash.isEmpty() || !frame.isValid()) {
+        return;
+    }
+    
+    // 按画面时间和实际时间双重限流，工作线程仍有未处理的帧时丢弃
+    qint64 timestamp = frame.startTime() >= 0 ? frame.startTime() / 1000 : m_player->position();
+    if (m_lastSampleTime >= 0 && timestamp - m_lastSampleTime < MinSampleIntervalMs) {
+        return;
+    }
+    if (m_sampleClock.isValid() && m_sampleClock.elapsed() < MinSampleWallMs) {
+        return;
+    }
+    if (m_framesInFlight.load(std::memory_order_relaxed) >= MaxFramesInFlight) {
+        return;
+    }
+    m_lastSampleTime = timestamp;
+    m_sampleClock.start();
+    m_framesInFlight.fetch_add(1, std::memory_order_relaxed);
+    
+    // GUI线程只转交帧的引用，不映射也不缩小
+    SceneAnalyzer *analyzer = m_analyzer;
+    quint64 session = m_session;
+    QMetaObject::invokeMethod(m_analyzer, [this, analyzer, session, frame, timestamp]() {
+        analyzer->processFrame(session, frame, timestamp);
+        m_framesInFlight.fetch_sub(1, std::memory_order_relaxed);
+    }, Qt::QueuedConnection);
+}
+
+void SceneDetector::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (m_videoHash.isEmpty()) {
+        return;
+    }
+    
+    if (status == QMediaPlayer::EndOfMedia) {
+        // 排在所有帧之后执行，此时分析器已处理完全部帧
+        SceneAnalyzer *analyzer = m_analyzer;
+        quint64 session = m_session;
+        QMetaObject::invokeMethod(m_analyzer, [this, analyzer, session]() {
+            if (analyzer->session() != session) {
+                return;
+            }
+            QList<qint64> cuts = analyzer->cuts();
+            QMetaObject::invokeMethod(this, [this, session, cuts]() {
+                deliverResult(session, cuts);
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    } else if (status == QMediaPlayer::InvalidMedia) {
+        cancel();
+    }
+}
+
+void SceneDetector::deliverResult(quint64 session, const QList<qint64> &cuts)
+{
+    if (session != m_session || m_videoHash.isEmpty()) {
+        return;
+    }
+    QString videoHash = m_videoHash;
+    m_videoHash.clear();
+    m_player->setSource(QUrl());
+    emit finished(videoHash, cuts);
+}
@@ -0,0 +1,59 @@
+#ifndef SCENEDETECTOR_H
+#define SCENEDETECTOR_H
+
+#include <QObject>
+#include <QList>
+#include <QMediaPlayer>
+#include <QVideoFrame>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QVideoSink;
+class QThread;
+class SceneAnalyzer;
+
+// 后台镜头切换检测，生成自动章节标记
+// 用一个独立的静音播放器快速解码视频，GUI线程只按时间间隔挑帧转交（帧是隐式共享的），
+// 映射、缩小为亮度缩略图和按亮度直方图差、逐像素差判断镜头切换都在低优先级工作线程中完成，
+// 结束后发出全部切点。
+class SceneDetector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SceneDetector(QObject *parent = nullptr);
+    ~SceneDetector() override;
+    
+    // 开始分析（会取消正在进行的分析）
+    void start(const QString &filePath, const QString &videoHash);
+    void cancel();
+    bool isRunning() const { return !m_videoHash.isEmpty(); }
+    QString videoHash() const { return m_videoHash; }
+    
+    static constexpr int SampleWidth = 64;
+    static constexpr int SampleHeight = 36;
+    static constexpr qreal AnalysisPlaybackRate = 8.0;
+
+signals:
+    // 分析完成，cuts为切点时间（毫秒，升序）
+    void finished(const QString &videoHash, const QList<qint64> &cuts);
+
+private slots:
+    void onVideoFrameChanged(const QVideoFrame &frame);
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+
+private:
+    void deliverResult(quint64 session, const QList<qint64> &cuts);
+    
+    QMediaPlayer *m_player;
+    QVideoSink *m_videoSink;
+    QThread *m_workerThread;
+    SceneAnalyzer *m_analyzer;
+    QString m_videoHash;
+    quint64 m_session;
+    qint64 m_lastSampleTime;
+    QElapsedTimer m_sampleClock;          // 距上次转交的实际时间
+    std::atomic<int> m_framesInFlight;   // 已转交、工作线程尚未处理完的帧数
+};
+
+#endif // SCENEDETECTOR_H
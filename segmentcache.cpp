@@ -0,0 +1,185 @@
+#include "segmentcache.h"
+#include "gridplaybackview.h"
+#include <QThreadPool>
+#include <QPointer>
+#include <QCoreApplication>
+#include <algorithm>
+
+namespace {
+
+constexpr qint64 EdgeToleranceMs = 200;   // 片段起点附近允许的误差（跳转落点不一定正好在A点）
+
+}
+
+SegmentCache::SegmentCache(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+    , m_startMs(-1)
+    , m_endMs(-1)
+    , m_budgetBytes(0)
+    , m_capturing(false)
+    , m_finished(false)
+    , m_ready(false)
+    , m_overBudget(false)
+    , m_pendingConversions(0)
+    , m_memoryUsage(0)
+{
+}
+
+void SegmentCache::begin(qint64 startMs, qint64 endMs, qint64 budgetBytes, const QSize &maxFrameSize)
+{
+    clear();
+    m_startMs = startMs;
+    m_endMs = endMs;
+    m_budgetBytes = budgetBytes;
+    m_maxFrameSize = maxFrameSize;
+    m_capturing = true;
+}
+
+void SegmentCache::clear()
+{
+    // 递增代数，尚在转换中的帧返回后直接丢弃
+    ++m_generation;
+    m_capturing = false;
+    m_finished = false;
+    m_ready = false;
+    m_overBudget = false;
+    m_pendingConversions = 0;
+    m_memoryUsage = 0;
+    m_frames.clear();
+    m_frameOffsets.clear();
+    m_frameImages.clear();
+    m_audioFormat = QAudioFormat();
+    m_audioData.clear();
+}
+
+void SegmentCache::addFrame(const QVideoFrame &frame)
+{
+    if (!m_capturing || !frame.isValid()) {
+        return;
+    }
+    qint64 timestamp = frame.startTime() / 1000;
+    if (frame.startTime() < 0 || timestamp < m_startMs - EdgeToleranceMs || timestamp > m_endMs) {
+        return;
+    }
+    
+    // 按缩小后的尺寸估算内存，超出预算立即放弃，不再转换
+    QSize scaledSize = frame.size();
+    if (m_maxFrameSize.isValid() && (scaledSize.width() > m_maxFrameSize.width()
+                                     || scaledSize.height() > m_maxFrameSize.height())) {
+        scaledSize = scaledSize.scaled(m_maxFrameSize, Qt::KeepAspectRatio);
+    }
+    m_memoryUsage += qint64(scaledSize.width()) * scaledSize.height() * 4;
+    if (m_memoryUsage + m_audioData.size() > m_budgetBytes) {
+        // 递增代数，已提交转换的帧返回后不再放入缓存
+        ++m_generation;
+        m_overBudget = true;
+        m_capturing = false;
+        m_pendingConversions = 0;
+        m_frames.clear();
+        m_audioData.clear();
+        return;
+    }
+    
+    ++m_pendingConversions;
+    quint64 generation = m_generation;
+    qint64 offset = qMax<qint64>(0, timestamp - m_startMs);
+    QPointer<SegmentCache> guard(this);
+    GridPlaybackView::framePool()->start([frame, scaledSize, generation, offset, guard]() {
+        QImage image = frame.toImage();
+        if (!image.isNull() && image.size() != scaledSize) {
+            image = image.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, generation, offset, image]() {
+            if (guard) {
+                guard->onFrameConverted(generation, offset, image);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SegmentCache::addAudio(const QAudioBuffer &buffer)
+{
+    if (!m_capturing || !buffer.isValid()) {
+        return;
+    }
+    qint64 timestamp = buffer.startTime() / 1000;
+    if (timestamp < m_startMs - EdgeToleranceMs || timestamp >= m_endMs) {
+        return;
+    }
+    if (!m_audioFormat.isValid()) {
+        m_audioFormat = buffer.format();
+    } else if (buffer.format() != m_audioFormat) {
+        return;
+    }
+    
+    // 画面按相对A点的偏移保存，音频也要从A点开始：
+    // 早于A点的部分裁掉，稍晚于A点开始时在前面补静音
+    const char *data = buffer.constData<char>();
+    qsizetype bytes = buffer.byteCount();
+    if (m_audioData.isEmpty() && buffer.startTime() > m_startMs * 1000
+        && buffer.startTime() <= (m_startMs + EdgeToleranceMs) * 1000) {
+        qsizetype silence = m_audioFormat.bytesForDuration(buffer.startTime() - m_startMs * 1000);
+        char silentByte = m_audioFormat.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : char(0);
+        m_audioData.fill(silentByte, silence);
+    } else if (buffer.startTime() < m_startMs * 1000) {
+        qsizetype skip = m_audioFormat.bytesForDuration(m_startMs * 1000 - buffer.startTime());
+        if (skip >= bytes) {
+            return;
+        }
+        data += skip;
+        bytes -= skip;
+    }
+    m_audioData.append(data, bytes);
+}
+
+void SegmentCache::finishCapture()
+{
+    if (!m_capturing) {
+        return;
+    }
+    m_capturing = false;
+    m_finished = true;
+    checkReady();
+}
+
+const QImage &SegmentCache::frameAt(qint64 offsetMs) const
+{
+    static const QImage empty;
+    auto it = std::upper_bound(m_frameOffsets.cbegin(), m_frameOffsets.cend(), offsetMs);
+    if (it == m_frameOffsets.cbegin()) {
+        return m_frameImages.isEmpty() ? empty : m_frameImages.first();
+    }
+    return m_frameImages.at(int(it - m_frameOffsets.cbegin()) - 1);
+}
+
+void SegmentCache::onFrameConverted(quint64 generation, qint64 offsetMs, const QImage &image)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    --m_pendingConversions;
+    if (!image.isNull()) {
+        m_frames.insert(offsetMs, image);
+    }
+    checkReady();
+}
+
+void SegmentCache::checkReady()
+{
+    if (!m_finished || m_ready || m_pendingConversions > 0) {
+        return;
+    }
+    
+    // 片段开头缺帧（例如收集中途才开始）时不能用于重放
+    if (m_frames.isEmpty() || m_frames.firstKey() > EdgeToleranceMs) {
+        m_finished = false;
+        return;
+    }
+    
+    m_frameOffsets = m_frames.keys();
+    m_frameImages = m_frames.values();
+    m_frames.clear();
+    m_ready = true;
+    emit ready();
+}
@@ -0,0 +1,73 @@
+#ifndef SEGMENTCACHE_H
+#define SEGMENTCACHE_H
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QMap>
+#include <QByteArray>
+#include <QAudioFormat>
+#include <QVideoFrame>
+#include <QAudioBuffer>
+
+// A-B循环片段的内存缓存
+// 第一遍播放时收集片段内解码出的画面（缩小到显示尺寸后在共享线程池中转换）
+// 和音频PCM数据，总大小超过预算时放弃缓存。缓存完整后循环可以直接从内存重放。
+class SegmentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SegmentCache(QObject *parent = nullptr);
+    
+    // 开始收集 [startMs, endMs] 内的帧，会丢弃之前的内容
+    void begin(qint64 startMs, qint64 endMs, qint64 budgetBytes, const QSize &maxFrameSize);
+    void clear();
+    
+    void addFrame(const QVideoFrame &frame);
+    void addAudio(const QAudioBuffer &buffer);
+    // 播放到达B点，收集结束（帧转换全部完成后变为可用）
+    void finishCapture();
+    
+    bool isCapturing() const { return m_capturing; }
+    bool isReady() const { return m_ready; }
+    // 收集已结束，正在等待帧转换完成
+    bool isFinishing() const { return m_finished && !m_ready; }
+    bool isOverBudget() const { return m_overBudget; }
+    qint64 startMs() const { return m_startMs; }
+    qint64 endMs() const { return m_endMs; }
+    qint64 durationMs() const { return m_endMs - m_startMs; }
+    qint64 memoryUsage() const { return m_memoryUsage; }
+    
+    // 片段内偏移offsetMs处应显示的帧
+    const QImage &frameAt(qint64 offsetMs) const;
+    QAudioFormat audioFormat() const { return m_audioFormat; }
+    const QByteArray &audioData() const { return m_audioData; }
+
+signals:
+    void ready();
+
+private:
+    void onFrameConverted(quint64 generation, qint64 offsetMs, const QImage &image);
+    void checkReady();
+    
+    quint64 m_generation;
+    qint64 m_startMs;
+    qint64 m_endMs;
+    qint64 m_budgetBytes;
+    QSize m_maxFrameSize;
+    bool m_capturing;
+    bool m_finished;
+    bool m_ready;
+    bool m_overBudget;
+    int m_pendingConversions;
+    qint64 m_memoryUsage;
+    
+    QMap<qint64, QImage> m_frames;   // 片段内偏移（毫秒） -> 画面
+    QList<qint64> m_frameOffsets;    // 可用后按顺序保存，便于二分查找
+    QList<QImage> m_frameImages;
+    QAudioFormat m_audioFormat;
+    QByteArray m_audioData;
+};
+
+#endif // SEGMENTCACHE_H
@@ -0,0 +1,172 @@
+#include "segmentplaybackview.h"
+#include "segmentcache.h"
+#include <QTimer>
+#include <QPainter>
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QAudioDevice>
+
+SegmentPlaybackView::SegmentPlaybackView(QWidget *parent)
+    : QWidget(parent)
+    , m_cache(nullptr)
+    , m_tickTimer(nullptr)
+    , m_audioSink(nullptr)
+    , m_audioDevice(nullptr)
+    , m_audioLoopBytes(0)
+    , m_audioOffset(0)
+    , m_periodMs(0)
+    , m_pausedClock(0)
+    , m_paused(false)
+    , m_currentImage(nullptr)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(5);
+    connect(m_tickTimer, &QTimer::timeout, this, &SegmentPlaybackView::onTick);
+}
+
+SegmentPlaybackView::~SegmentPlaybackView()
+{
+    stop();
+}
+
+void SegmentPlaybackView::start(const SegmentCache *cache, qreal volume)
+{
+    stop();
+    if (!cache || !cache->isReady() || cache->durationMs() <= 0) {
+        return;
+    }
+    m_cache = cache;
+    m_paused = false;
+    m_periodMs = cache->durationMs();
+    
+    // 音频按整帧对齐截取到片段时长，循环时首尾相接
+    QAudioFormat format = cache->audioFormat();
+    if (format.isValid() && !cache->audioData().isEmpty()) {
+        qint64 segmentBytes = format.bytesForDuration(cache->durationMs() * 1000);
+        m_audioLoopBytes = qMin<qint64>(cache->audioData().size(), segmentBytes);
+        m_audioLoopBytes -= m_audioLoopBytes % qMax(1, format.bytesPerFrame());
+        if (m_audioLoopBytes > 0) {
+            m_audioSink = new QAudioSink(QMediaDevices::defaultAudioOutput(), format, this);
+            m_audioSink->setVolume(volume);
+            m_audioDevice = m_audioSink->start();
+            m_audioOffset = 0;
+            // 以音频为时钟时，循环周期等于实际缓存的音频时长，画面与声音不会逐圈漂移
+            m_periodMs = qMax<qint64>(1, format.durationForBytes(m_audioLoopBytes) / 1000);
+            feedAudio();
+        }
+    }
+    
+    m_clock.start();
+    m_tickTimer->start();
+    onTick();
+}
+
+void SegmentPlaybackView::stop()
+{
+    m_tickTimer->stop();
+    if (m_audioSink) {
+        m_audioSink->stop();
+        delete m_audioSink;
+        m_audioSink = nullptr;
+        m_audioDevice = nullptr;
+    }
+    m_cache = nullptr;
+    m_currentImage = nullptr;
+    m_audioLoopBytes = 0;
+    m_pausedClock = 0;
+    m_paused = false;
+}
+
+void SegmentPlaybackView::pause()
+{
+    if (!m_cache || m_paused) {
+        return;
+    }
+    m_pausedClock = clockMs();
+    m_paused = true;
+    m_tickTimer->stop();
+    if (m_audioSink) {
+        m_audioSink->suspend();
+    }
+}
+
+void SegmentPlaybackView::resume()
+{
+    if (!m_cache || !m_paused) {
+        return;
+    }
+    m_paused = false;
+    if (m_audioSink) {
+        m_audioSink->resume();
+    }
+    // 无音频时从暂停处继续计时
+    m_clock.restart();
+    m_tickTimer->start();
+}
+
+void SegmentPlaybackView::setVolume(qreal volume)
+{
+    if (m_audioSink) {
+        m_audioSink->setVolume(volume);
+    }
+}
+
+qint64 SegmentPlaybackView::clockMs() const
+{
+    if (m_paused) {
+        return m_pausedClock;
+    }
+    if (m_audioSink) {
+        return m_audioSink->processedUSecs() / 1000;
+    }
+    return m_pausedClock + m_clock.elapsed();
+}
+
+void SegmentPlaybackView::onTick()
+{
+    if (!m_cache) {
+        return;
+    }
+    feedAudio();
+    
+    qint64 offset = clockMs() % m_periodMs;
+    const QImage &image = m_cache->frameAt(offset);
+    if (&image != m_currentImage) {
+        m_currentImage = &image;
+        update();
+    }
+    emit positionChanged(m_cache->startMs() + offset);
+}
+
+void SegmentPlaybackView::feedAudio()
+{
+    if (!m_audioDevice || m_audioLoopBytes <= 0) {
+        return;
+    }
+    const char *data = m_cache->audioData().constData();
+    qint64 free = m_audioSink->bytesFree();
+    while (free > 0) {
+        qint64 chunk = qMin(free, m_audioLoopBytes - m_audioOffset);
+        qint64 written = m_audioDevice->write(data + m_audioOffset, chunk);
+        if (written <= 0) {
+            break;
+        }
+        free -= written;
+        m_audioOffset = (m_audioOffset + written) % m_audioLoopBytes;
+    }
+}
+
+void SegmentPlaybackView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    if (m_currentImage && !m_currentImage->isNull()) {
+        QRect target(QPoint(0, 0), m_currentImage->size().scaled(size(), Qt::KeepAspectRatio));
+        target.moveCenter(rect().center());
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(target, *m_currentImage);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SEGMENTPLAYBACKVIEW_H
+#define SEGMENTPLAYBACKVIEW_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QImage>
+
+class QTimer;
+class QAudioSink;
+class QIODevice;
+class SegmentCache;
+
+// 从SegmentCache循环重放片段，不经过解码器
+// 有音频时以音频输出已播放的时长为时钟，画面跟随音频；否则使用计时器。
+class SegmentPlaybackView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SegmentPlaybackView(QWidget *parent = nullptr);
+    ~SegmentPlaybackView() override;
+    
+    void start(const SegmentCache *cache, qreal volume);
+    void stop();
+    void pause();
+    void resume();
+    void setVolume(qreal volume);
+    bool isActive() const { return m_cache != nullptr; }
+    bool isPaused() const { return m_paused; }
+
+signals:
+    // 当前重放位置（原视频中的毫秒）
+    void positionChanged(qint64 position);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void onTick();
+
+private:
+    void feedAudio();
+    qint64 clockMs() const;
+    
+    const SegmentCache *m_cache;
+    QTimer *m_tickTimer;
+    QAudioSink *m_audioSink;
+    QIODevice *m_audioDevice;
+    qint64 m_audioLoopBytes;
+    qint64 m_audioOffset;
+    qint64 m_periodMs;
+    QElapsedTimer m_clock;
+    qint64 m_pausedClock;
+    bool m_paused;
+    const QImage *m_currentImage;
+};
+
+#endif // SEGMENTPLAYBACKVIEW_H
@@ -4,16 +4,32 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent)
     , m_leftSpeedComboBox(nullptr)
     , m_rightSpeedComboBox(nullptr)
+    , m_smoothSlowMotionCheckBox(nullptr)
+    , m_fastSeekCheckBox(nullptr)
+    , m_readAheadCheckBox(nullptr)
+    , m_singleInstanceCheckBox(nullptr)
+    , m_loopCacheSpinBox(nullptr)
+    , m_snapshotFormatComboBox(nullptr)
+    , m_metadataProbeSpinBox(nullptr)
+    , m_thumbnailCacheSpinBox(nullptr)
     , m_okButton(nullptr)
     , m_cancelButton(nullptr)
     , m_originalLeftSpeed(2.0)
     , m_originalRightSpeed(2.0)
+    , m_originalSmoothSlowMotion(false)
+    , m_originalFastSeek(false)
+    , m_originalReadAhead(false)
+    , m_originalSingleInstance(true)
+    , m_originalLoopCacheMB(512)
+    , m_originalSnapshotFormat("png")
+    , m_originalMetadataProbeLimit(4)
+    , m_originalThumbnailCacheMB(256)
 {
     setupUI();
     setupConnections();
     
     setWindowTitle("设置");
-    setFixedSize(400, 220);
+    setFixedSize(400, 650);
     setModal(true);
 }
 
@@ -65,6 +81,102 @@ void SettingsDialog::setupUI()
     speedLayout->addLayout(leftLayout);
     speedLayout->addLayout(rightLayout);
     
+    m_smoothSlowMotionCheckBox = new QCheckBox("慢速播放时运动补偿插帧（画面更流畅，占用CPU）");
+    m_smoothSlowMotionCheckBox->setStyleSheet("color: black; font-weight: normal;");
+    speedLayout->addWidget(m_smoothSlowMotionCheckBox);
+    
+    m_fastSeekCheckBox = new QCheckBox("快速跳转（对齐到关键帧，跳转更快但位置不精确）");
+    m_fastSeekCheckBox->setStyleSheet("color: black; font-weight: normal;");
+    speedLayout->addWidget(m_fastSeekCheckBox);
+    
+    // 创建播放源设置组
+    QGroupBox *sourceGroup = new QGroupBox("播放源与启动");
+    sourceGroup->setStyleSheet("QGroupBox { font-weight: bold; color: black; border: 1px solid #ccc; border-radius: 4px; margin: 5px 0; padding-top: 10px; } QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px 0 5px; }");
+    
+    QVBoxLayout *sourceLayout = new QVBoxLayout(sourceGroup);
+    
+    m_readAheadCheckBox = new QCheckBox("启用预读缓冲（适用于网络共享和慢速磁盘）");
+    m_readAheadCheckBox->setStyleSheet("color: black; font-weight: normal;");
+    sourceLayout->addWidget(m_readAheadCheckBox);
+    
+    m_singleInstanceCheckBox = new QCheckBox("单实例模式（打开文件时交给已运行的播放器）");
+    m_singleInstanceCheckBox->setStyleSheet("color: black; font-weight: normal;");
+    sourceLayout->addWidget(m_singleInstanceCheckBox);
+    
+    // 创建循环播放设置组
+    QGroupBox *loopGroup = new QGroupBox("A-B循环");
+    loopGroup->setStyleSheet("QGroupBox { font-weight: bold; color: black; border: 1px solid #ccc; border-radius: 4px; margin: 5px 0; padding-top: 10px; } QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px 0 5px; }");
+    
+    QHBoxLayout *loopLayout = new QHBoxLayout(loopGroup);
+    QLabel *loopCacheLabel = new QLabel("内存缓存上限:");
+    loopCacheLabel->setStyleSheet("color: black; font-weight: normal;");
+    loopCacheLabel->setMinimumWidth(120);
+    loopCacheLabel->setToolTip("循环片段的画面和声音不超过此大小时，从内存重放而不重新解码");
+    
+    m_loopCacheSpinBox = new QSpinBox();
+    m_loopCacheSpinBox->setRange(0, 8192);
+    m_loopCacheSpinBox->setSingleStep(128);
+    m_loopCacheSpinBox->setSuffix(" MB");
+    m_loopCacheSpinBox->setSpecialValueText("不缓存");
+    m_loopCacheSpinBox->setStyleSheet("QSpinBox { padding: 5px 10px; background-color: white; border: 1px solid #ccc; border-radius: 4px; color: black; font-weight: normal; }");
+    
+    loopLayout->addWidget(loopCacheLabel);
+    loopLayout->addWidget(m_loopCacheSpinBox);
+    
+    // 创建截图设置组
+    QGroupBox *snapshotGroup = new QGroupBox("截图");
+    snapshotGroup->setStyleSheet("QGroupBox { font-weight: bold; color: black; border: 1px solid #ccc; border-radius: 4px; margin: 5px 0; padding-top: 10px; } QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px 0 5px; }");
+    
+    QHBoxLayout *snapshotLayout = new QHBoxLayout(snapshotGroup);
+    QLabel *snapshotFormatLabel = new QLabel("图片格式:");
+    snapshotFormatLabel->setStyleSheet("color: black; font-weight: normal;");
+    snapshotFormatLabel->setMinimumWidth(120);
+    snapshotFormatLabel->setToolTip("S键截图，Shift+S连拍，保存在“图片/VideoPlayer”目录");
+    
+    m_snapshotFormatComboBox = new QComboBox();
+    m_snapshotFormatComboBox->addItem("PNG（无损）", "png");
+    m_snapshotFormatComboBox->addItem("JPEG", "jpg");
+    m_snapshotFormatComboBox->setStyleSheet("QComboBox { padding: 5px 10px; background-color: white; border: 1px solid #ccc; border-radius: 4px; color: black; font-weight: normal; } QComboBox::drop-down { border: none; } QComboBox::down-arrow { image: none; border: none; } QComboBox QAbstractItemView { background-color: white; color: black; border: 1px solid #ccc; }");
+    
+    snapshotLayout->addWidget(snapshotFormatLabel);
+    snapshotLayout->addWidget(m_snapshotFormatComboBox);
+    
+    // 创建播放列表设置组
+    QGroupBox *playlistGroup = new QGroupBox("播放列表");
+    playlistGroup->setStyleSheet("QGroupBox { font-weight: bold; color: black; border: 1px solid #ccc; border-radius: 4px; margin: 5px 0; padding-top: 10px; } QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px 0 5px; }");
+    
+    QVBoxLayout *playlistLayout = new QVBoxLayout(playlistGroup);
+    QHBoxLayout *metadataProbeLayout = new QHBoxLayout();
+    QLabel *metadataProbeLabel = new QLabel("信息读取并发数:");
+    metadataProbeLabel->setStyleSheet("color: black; font-weight: normal;");
+    metadataProbeLabel->setMinimumWidth(120);
+    metadataProbeLabel->setToolTip("读取时长、分辨率等信息时最多同时打开的文件数，网络共享上的列表建议调小");
+    
+    m_metadataProbeSpinBox = new QSpinBox();
+    m_metadataProbeSpinBox->setRange(1, 16);
+    m_metadataProbeSpinBox->setStyleSheet("QSpinBox { padding: 5px 10px; background-color: white; border: 1px solid #ccc; border-radius: 4px; color: black; font-weight: normal; }");
+    
+    metadataProbeLayout->addWidget(metadataProbeLabel);
+    metadataProbeLayout->addWidget(m_metadataProbeSpinBox);
+    
+    QHBoxLayout *thumbnailCacheLayout = new QHBoxLayout();
+    QLabel *thumbnailCacheLabel = new QLabel("缩略图缓存上限:");
+    thumbnailCacheLabel->setStyleSheet("color: black; font-weight: normal;");
+    thumbnailCacheLabel->setMinimumWidth(120);
+    thumbnailCacheLabel->setToolTip("生成过的缩略图保存在磁盘上，超过此大小时删除最久未显示的");
+    
+    m_thumbnailCacheSpinBox = new QSpinBox();
+    m_thumbnailCacheSpinBox->setRange(16, 4096);
+    m_thumbnailCacheSpinBox->setSingleStep(64);
+    m_thumbnailCacheSpinBox->setSuffix(" MB");
+    m_thumbnailCacheSpinBox->setStyleSheet("QSpinBox { padding: 5px 10px; background-color: white; border: 1px solid #ccc; border-radius: 4px; color: black; font-weight: normal; }");
+    
+    thumbnailCacheLayout->addWidget(thumbnailCacheLabel);
+    thumbnailCacheLayout->addWidget(m_thumbnailCacheSpinBox);
+    
+    playlistLayout->addLayout(metadataProbeLayout);
+    playlistLayout->addLayout(thumbnailCacheLayout);
+    
     // 创建按钮布局
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     
@@ -80,6 +192,10 @@ void SettingsDialog::setupUI()
     
     // 添加到主布局
     mainLayout->addWidget(speedGroup);
+    mainLayout->addWidget(sourceGroup);
+    mainLayout->addWidget(loopGroup);
+    mainLayout->addWidget(snapshotGroup);
+    mainLayout->addWidget(playlistGroup);
     mainLayout->addLayout(buttonLayout);
     mainLayout->setContentsMargins(15, 15, 15, 15);
 }
@@ -128,6 +244,97 @@ void SettingsDialog::setRightKeySpeed(double speed)
     m_originalRightSpeed = speed;
 }
 
+bool SettingsDialog::getSmoothSlowMotionEnabled() const
+{
+    return m_smoothSlowMotionCheckBox->isChecked();
+}
+
+void SettingsDialog::setSmoothSlowMotionEnabled(bool enabled)
+{
+    m_smoothSlowMotionCheckBox->setChecked(enabled);
+    m_originalSmoothSlowMotion = enabled;
+}
+
+bool SettingsDialog::getFastSeekEnabled() const
+{
+    return m_fastSeekCheckBox->isChecked();
+}
+
+void SettingsDialog::setFastSeekEnabled(bool enabled)
+{
+    m_fastSeekCheckBox->setChecked(enabled);
+    m_originalFastSeek = enabled;
+}
+
+bool SettingsDialog::getReadAheadEnabled() const
+{
+    return m_readAheadCheckBox->isChecked();
+}
+
+void SettingsDialog::setReadAheadEnabled(bool enabled)
+{
+    m_readAheadCheckBox->setChecked(enabled);
+    m_originalReadAhead = enabled;
+}
+
+bool SettingsDialog::getSingleInstanceEnabled() const
+{
+    return m_singleInstanceCheckBox->isChecked();
+}
+
+void SettingsDialog::setSingleInstanceEnabled(bool enabled)
+{
+    m_singleInstanceCheckBox->setChecked(enabled);
+    m_originalSingleInstance = enabled;
+}
+
+int SettingsDialog::getLoopCacheMB() const
+{
+    return m_loopCacheSpinBox->value();
+}
+
+void SettingsDialog::setLoopCacheMB(int megabytes)
+{
+    m_loopCacheSpinBox->setValue(megabytes);
+    m_originalLoopCacheMB = megabytes;
+}
+
+QString SettingsDialog::getSnapshotFormat() const
+{
+    return m_snapshotFormatComboBox->currentData().toString();
+}
+
+void SettingsDialog::setSnapshotFormat(const QString &format)
+{
+    int index = m_snapshotFormatComboBox->findData(format);
+    if (index >= 0) {
+        m_snapshotFormatComboBox->setCurrentIndex(index);
+    }
+    m_originalSnapshotFormat = format;
+}
+
+int SettingsDialog::getMetadataProbeLimit() const
+{
+    return m_metadataProbeSpinBox->value();
+}
+
+void SettingsDialog::setMetadataProbeLimit(int count)
+{
+    m_metadataProbeSpinBox->setValue(count);
+    m_originalMetadataProbeLimit = count;
+}
+
+int SettingsDialog::getThumbnailCacheMB() const
+{
+    return m_thumbnailCacheSpinBox->value();
+}
+
+void SettingsDialog::setThumbnailCacheMB(int megabytes)
+{
+    m_thumbnailCacheSpinBox->setValue(megabytes);
+    m_originalThumbnailCacheMB = megabytes;
+}
+
 void SettingsDialog::onOkClicked()
 {
     accept();
@@ -138,5 +345,13 @@ void SettingsDialog::onCancelClicked()
     // 恢复原始设置
     setLeftKeySpeed(m_originalLeftSpeed);
     setRightKeySpeed(m_originalRightSpeed);
+    setSmoothSlowMotionEnabled(m_originalSmoothSlowMotion);
+    setFastSeekEnabled(m_originalFastSeek);
+    setReadAheadEnabled(m_originalReadAhead);
+    setSingleInstanceEnabled(m_originalSingleInstance);
+    setLoopCacheMB(m_originalLoopCacheMB);
+    setSnapshotFormat(m_originalSnapshotFormat);
+    setMetadataProbeLimit(m_originalMetadataProbeLimit);
+    setThumbnailCacheMB(m_originalThumbnailCacheMB);
     reject();
 }
\ No newline at end of file
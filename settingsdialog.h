@@ -8,6 +8,8 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
+#include <QCheckBox>
+#include <QSpinBox>
 
 class SettingsDialog : public QDialog
 {
@@ -21,6 +23,36 @@ public:
     double getRightKeySpeed() const;
     void setLeftKeySpeed(double speed);
     void setRightKeySpeed(double speed);
+    
+    // 获取和设置慢速播放插帧
+    bool getSmoothSlowMotionEnabled() const;
+    void setSmoothSlowMotionEnabled(bool enabled);
+    bool getFastSeekEnabled() const;
+    void setFastSeekEnabled(bool enabled);
+    
+    // 获取和设置预读缓冲
+    bool getReadAheadEnabled() const;
+    void setReadAheadEnabled(bool enabled);
+    
+    // 获取和设置单实例模式
+    bool getSingleInstanceEnabled() const;
+    void setSingleInstanceEnabled(bool enabled);
+    
+    // 获取和设置A-B循环缓存上限（MB）
+    int getLoopCacheMB() const;
+    void setLoopCacheMB(int megabytes);
+    
+    // 获取和设置截图格式（"png" 或 "jpg"）
+    QString getSnapshotFormat() const;
+    void setSnapshotFormat(const QString &format);
+    
+    // 获取和设置元数据探测同时打开的文件数
+    int getMetadataProbeLimit() const;
+    void setMetadataProbeLimit(int count);
+    
+    // 获取和设置缩略图磁盘缓存上限（MB）
+    int getThumbnailCacheMB() const;
+    void setThumbnailCacheMB(int megabytes);
 
 private slots:
     void onOkClicked();
@@ -32,11 +64,27 @@ private:
     
     QComboBox *m_leftSpeedComboBox;
     QComboBox *m_rightSpeedComboBox;
+    QCheckBox *m_smoothSlowMotionCheckBox;
+    QCheckBox *m_fastSeekCheckBox;
+    QCheckBox *m_readAheadCheckBox;
+    QCheckBox *m_singleInstanceCheckBox;
+    QSpinBox *m_loopCacheSpinBox;
+    QComboBox *m_snapshotFormatComboBox;
+    QSpinBox *m_metadataProbeSpinBox;
+    QSpinBox *m_thumbnailCacheSpinBox;
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
     
     double m_originalLeftSpeed;
     double m_originalRightSpeed;
+    bool m_originalSmoothSlowMotion;
+    bool m_originalFastSeek;
+    bool m_originalReadAhead;
+    bool m_originalSingleInstance;
+    int m_originalLoopCacheMB;
+    QString m_originalSnapshotFormat;
+    int m_originalMetadataProbeLimit;
+    int m_originalThumbnailCacheMB;
 };
 
 #endif // SETTINGSDIALOG_H
\ No newline at end of file
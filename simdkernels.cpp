@@ -0,0 +1,271 @@
+#include "simdkernels.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMDKERNELS_SSE2
+#endif
+
+namespace SimdKernels {
+
+quint64 sumAbsDiffU8(const quint8 *a, const quint8 *b, int count)
+{
+    quint64 total = 0;
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    // _mm_sad_epu8每次处理16字节，得到两个64位部分和
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    total = lanes[0] + lanes[1];
+#endif
+    
+    for (; i < count; ++i) {
+        total += quint64(std::abs(int(a[i]) - int(b[i])));
+    }
+    return total;
+}
+
+quint64 sumAbsDiffU32(const quint32 *a, const quint32 *b, int count)
+{
+    quint64 total = 0;
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    // SSE2没有32位绝对值指令，用符号掩码计算 |x| = (x ^ m) - m
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i diff = _mm_sub_epi32(va, vb);
+        __m128i mask = _mm_srai_epi32(diff, 31);
+        __m128i absDiff = _mm_sub_epi32(_mm_xor_si128(diff, mask), mask);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(absDiff, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(absDiff, zero));
+    }
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    total = lanes[0] + lanes[1];
+#endif
+    
+    for (; i < count; ++i) {
+        total += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+    return total;
+}
+
+void minMaxF32(const float *data, int count, float *minValue, float *maxValue)
+{
+    float low = *minValue;
+    float high = *maxValue;
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    if (count >= 4) {
+        __m128 lowVector = _mm_set1_ps(low);
+        __m128 highVector = _mm_set1_ps(high);
+        for (; i + 4 <= count; i += 4) {
+            __m128 values = _mm_loadu_ps(data + i);
+            lowVector = _mm_min_ps(lowVector, values);
+            highVector = _mm_max_ps(highVector, values);
+        }
+        float lows[4];
+        float highs[4];
+        _mm_storeu_ps(lows, lowVector);
+        _mm_storeu_ps(highs, highVector);
+        for (int lane = 0; lane < 4; ++lane) {
+            low = lows[lane] < low ? lows[lane] : low;
+            high = highs[lane] > high ? highs[lane] : high;
+        }
+    }
+#endif
+    
+    for (; i < count; ++i) {
+        low = data[i] < low ? data[i] : low;
+        high = data[i] > high ? data[i] : high;
+    }
+    *minValue = low;
+    *maxValue = high;
+}
+
+float dotF32(const float *a, const float *b, int count)
+{
+    float total = 0.0f;
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    
+    for (; i < count; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+void histogramU8(const quint8 *data, int count, quint32 *histogram, int bins)
+{
+    int shift = 0;
+    while ((256 >> shift) > bins) {
+        ++shift;
+    }
+    
+    // 四组子直方图交替累加，减少相邻像素落入同一个桶时的写后读依赖
+    quint32 partial[4][256];
+    std::memset(partial, 0, sizeof(partial));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        ++partial[0][data[i] >> shift];
+        ++partial[1][data[i + 1] >> shift];
+        ++partial[2][data[i + 2] >> shift];
+        ++partial[3][data[i + 3] >> shift];
+    }
+    for (; i < count; ++i) {
+        ++partial[0][data[i] >> shift];
+    }
+    
+    for (int bin = 0; bin < bins; ++bin) {
+        histogram[bin] += partial[0][bin] + partial[1][bin] + partial[2][bin] + partial[3][bin];
+    }
+}
+
+void mulF32(const float *a, const float *b, float *out, int count)
+{
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#endif
+    
+    for (; i < count; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+void butterflyF32(float *re0, float *im0, float *re1, float *im1,
+                  const float *twiddleRe, const float *twiddleIm, int count)
+{
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    // 分离存储下复数乘法不需要重排，四个蝶形一组
+    for (; i + 4 <= count; i += 4) {
+        __m128 wr = _mm_loadu_ps(twiddleRe + i);
+        __m128 wi = _mm_loadu_ps(twiddleIm + i);
+        __m128 xr = _mm_loadu_ps(re1 + i);
+        __m128 xi = _mm_loadu_ps(im1 + i);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        __m128 ar = _mm_loadu_ps(re0 + i);
+        __m128 ai = _mm_loadu_ps(im0 + i);
+        _mm_storeu_ps(re1 + i, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(im1 + i, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(re0 + i, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(im0 + i, _mm_add_ps(ai, ti));
+    }
+#endif
+    
+    for (; i < count; ++i) {
+        float tr = re1[i] * twiddleRe[i] - im1[i] * twiddleIm[i];
+        float ti = re1[i] * twiddleIm[i] + im1[i] * twiddleRe[i];
+        re1[i] = re0[i] - tr;
+        im1[i] = im0[i] - ti;
+        re0[i] += tr;
+        im0[i] += ti;
+    }
+}
+
+void powerF32(const float *re, const float *im, float *out, int count)
+{
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    for (; i + 4 <= count; i += 4) {
+        __m128 r = _mm_loadu_ps(re + i);
+        __m128 m = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m)));
+    }
+#endif
+    
+    for (; i < count; ++i) {
+        out[i] = re[i] * re[i] + im[i] * im[i];
+    }
+}
+
+quint64 sumAbsDiffBlockU8(const quint8 *a, int strideA, const quint8 *b, int strideB, int width, int height)
+{
+    quint64 total = 0;
+    for (int y = 0; y < height; ++y) {
+        const quint8 *rowA = a + qsizetype(y) * strideA;
+        const quint8 *rowB = b + qsizetype(y) * strideB;
+        int x = 0;
+        
+#ifdef SIMDKERNELS_SSE2
+        // 常见的8、16像素宽的块整行在寄存器中完成
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= width; x += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rowA + x));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rowB + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+        }
+        if (x + 8 <= width) {
+            __m128i va = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rowA + x));
+            __m128i vb = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rowB + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+            x += 8;
+        }
+        quint64 lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+        total += lanes[0] + lanes[1];
+#endif
+        
+        for (; x < width; ++x) {
+            total += quint64(std::abs(int(rowA[x]) - int(rowB[x])));
+        }
+    }
+    return total;
+}
+
+void blendU8(const quint8 *a, const quint8 *b, quint8 *out, int count, int weight)
+{
+    int i = 0;
+    
+#ifdef SIMDKERNELS_SSE2
+    // 扩展到16位计算，差值乘以不超过128的权重不会溢出
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w = _mm_set1_epi16(short(weight));
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i aLow = _mm_unpacklo_epi8(va, zero);
+        __m128i aHigh = _mm_unpackhi_epi8(va, zero);
+        __m128i diffLow = _mm_sub_epi16(_mm_unpacklo_epi8(vb, zero), aLow);
+        __m128i diffHigh = _mm_sub_epi16(_mm_unpackhi_epi8(vb, zero), aHigh);
+        __m128i low = _mm_add_epi16(aLow, _mm_srai_epi16(_mm_mullo_epi16(diffLow, w), 7));
+        __m128i high = _mm_add_epi16(aHigh, _mm_srai_epi16(_mm_mullo_epi16(diffHigh, w), 7));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    
+    for (; i < count; ++i) {
+        out[i] = quint8(int(a[i]) + ((int(b[i]) - int(a[i])) * weight >> 7));
+    }
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <QtGlobal>
+
+// 向量化的图像/信号处理内核
+// x86平台使用SSE2实现（x86-64上总是可用），其他平台使用标量实现，结果一致
+namespace SimdKernels {
+
+// 两段8位数据的绝对差之和
+quint64 sumAbsDiffU8(const quint8 *a, const quint8 *b, int count);
+
+// 两段32位计数（每个值小于2^31）的绝对差之和，用于比较直方图
+quint64 sumAbsDiffU32(const quint32 *a, const quint32 *b, int count);
+
+// 浮点数据的最小值和最大值，结果与*minValue、*maxValue中已有的值合并
+void minMaxF32(const float *data, int count, float *minValue, float *maxValue);
+
+// 两段浮点数据的点积
+float dotF32(const float *a, const float *b, int count);
+
+// 8位数据的直方图，bins个桶（必须是2的幂且不超过256），结果累加到histogram
+void histogramU8(const quint8 *data, int count, quint32 *histogram, int bins);
+
+// 逐元素相乘 out[i] = a[i] * b[i]，out可以与a或b相同
+void mulF32(const float *a, const float *b, float *out, int count);
+
+// 分离存储（实部、虚部各一段）的基2蝶形运算：
+// t = (re1, im1) * (twiddleRe, twiddleIm)，(re1, im1) = x0 - t，(re0, im0) = x0 + t
+void butterflyF32(float *re0, float *im0, float *re1, float *im1,
+                  const float *twiddleRe, const float *twiddleIm, int count);
+
+// 复数的模平方 out[i] = re[i]^2 + im[i]^2
+void powerF32(const float *re, const float *im, float *out, int count);
+
+// 两个8位图像块（width x height，各自的行跨度）的绝对差之和，用于块匹配运动估计
+quint64 sumAbsDiffBlockU8(const quint8 *a, int strideA, const quint8 *b, int strideB, int width, int height);
+
+// 8位数据按权重混合 out[i] = a[i] + (b[i] - a[i]) * weight / 128，weight为0 ~ 128
+void blendU8(const quint8 *a, const quint8 *b, quint8 *out, int count, int weight);
+
+}
+
+#endif // SIMDKERNELS_H
@@ -0,0 +1,86 @@
+#include "singleinstance.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+SingleInstance::SingleInstance(const QString &applicationName, QObject *parent)
+    : QObject(parent)
+    , m_server(nullptr)
+{
+    // 服务名包含用户名，不同用户的实例互不干扰
+    QString userName = qEnvironmentVariable("USERNAME", qEnvironmentVariable("USER"));
+    QByteArray userHash = QCryptographicHash::hash(userName.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+    m_serverName = applicationName + "-" + QString::fromLatin1(userHash);
+}
+
+bool SingleInstance::forwardToRunningInstance(const QStringList &arguments, int timeoutMs)
+{
+    QLocalSocket socket;
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(timeoutMs)) {
+        return false;
+    }
+    
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << arguments;
+    socket.write(data);
+    if (!socket.waitForBytesWritten(timeoutMs)) {
+        return false;
+    }
+    socket.disconnectFromServer();
+    return true;
+}
+
+bool SingleInstance::listen()
+{
+    if (m_server) {
+        return true;
+    }
+    
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    
+    if (!m_server->listen(m_serverName)) {
+        // 之前的实例异常退出可能留下了失效的服务：先试着连接，
+        // 确认没有实例在监听后才清理并重试，不能删掉正在运行的实例的服务
+        QLocalSocket probe;
+        probe.connectToServer(m_serverName);
+        bool stale = !probe.waitForConnected(1000)
+                     && (probe.error() == QLocalSocket::ServerNotFoundError
+                         || probe.error() == QLocalSocket::ConnectionRefusedError);
+        probe.abort();
+        if (stale) {
+            QLocalServer::removeServer(m_serverName);
+        }
+        if (!stale || !m_server->listen(m_serverName)) {
+            delete m_server;
+            m_server = nullptr;
+            return false;
+        }
+    }
+    
+    connect(m_server, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+            connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readArguments(socket); });
+            connect(socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater);
+            readArguments(socket);
+        }
+    });
+    return true;
+}
+
+void SingleInstance::readArguments(QLocalSocket *socket)
+{
+    // 数据可能分多次到达，读不完整时回滚等待下一次readyRead
+    QDataStream stream(socket);
+    stream.startTransaction();
+    QStringList arguments;
+    stream >> arguments;
+    if (!stream.commitTransaction()) {
+        return;
+    }
+    
+    emit argumentsReceived(arguments);
+}
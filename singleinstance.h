@@ -0,0 +1,36 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 单实例支持
+// 新启动的进程先尝试连接已运行的实例，把命令行参数转发过去后立即退出；
+// 没有已运行的实例时由当前进程监听，接收之后启动的进程转发来的参数。
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SingleInstance(const QString &applicationName, QObject *parent = nullptr);
+    
+    // 把参数转发给已运行的实例，成功时返回true（当前进程应退出）
+    bool forwardToRunningInstance(const QStringList &arguments, int timeoutMs = 500);
+    
+    // 作为主实例开始监听
+    bool listen();
+
+signals:
+    void argumentsReceived(const QStringList &arguments);
+
+private:
+    void readArguments(QLocalSocket *socket);
+    
+    QString m_serverName;
+    QLocalServer *m_server;
+};
+
+#endif // SINGLEINSTANCE_H
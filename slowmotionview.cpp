@@ -0,0 +1,182 @@
+#include "slowmotionview.h"
+#include <QPainter>
+#include <QTimer>
+#include <QScreen>
+
+namespace {
+
+constexpr qint64 ResyncMs = 300;   // 时钟与目标相差更多时直接对齐（跳转、卡顿后）
+constexpr qint64 DefaultFrameIntervalMs = 40;
+
+}
+
+SlowMotionView::SlowMotionView(QWidget *parent)
+    : QWidget(parent)
+    , m_interpolator(nullptr)
+    , m_tickTimer(nullptr)
+    , m_clockBase(0)
+    , m_hasClock(false)
+    , m_rate(1.0)
+    , m_paused(false)
+    , m_active(false)
+    , m_displayIntervalMs(16)
+    , m_lastOriginalTime(-1)
+    , m_frameIntervalMs(DefaultFrameIntervalMs)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    
+    m_interpolator = new MotionInterpolator(this);
+    connect(m_interpolator, &MotionInterpolator::framesReady, this, &SlowMotionView::onFramesReady);
+    
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_tickTimer, &QTimer::timeout, this, &SlowMotionView::onTick);
+}
+
+void SlowMotionView::start(qreal rate)
+{
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    m_displayIntervalMs = qMax(4, int(1000.0 / qBound(30.0, refreshRate, 240.0)));
+    m_interpolator->setDisplayInterval(m_displayIntervalMs);
+    m_interpolator->setOutputSize((QSizeF(size()) * devicePixelRatioF()).toSize());
+    m_interpolator->reset();
+    
+    m_active = true;
+    m_hasClock = false;
+    m_lastOriginalTime = -1;
+    m_frameIntervalMs = DefaultFrameIntervalMs;
+    m_queue.clear();
+    setPlaybackRate(rate);
+    m_tickTimer->start(m_displayIntervalMs);
+}
+
+void SlowMotionView::stop()
+{
+    m_active = false;
+    m_tickTimer->stop();
+    m_interpolator->reset();
+    m_queue.clear();
+    m_currentImage = QImage();
+}
+
+void SlowMotionView::addFrame(const QVideoFrame &frame)
+{
+    if (m_active) {
+        m_interpolator->addFrame(frame);
+    }
+}
+
+void SlowMotionView::setPlaybackRate(qreal rate)
+{
+    if (m_hasClock) {
+        setClock(clockMs());
+    }
+    m_rate = rate;
+    m_interpolator->setPlaybackRate(rate);
+}
+
+void SlowMotionView::setPaused(bool paused)
+{
+    if (paused == m_paused) {
+        return;
+    }
+    m_paused = paused;
+    if (paused) {
+        // 暂停时显示与播放器位置一致的原始帧
+        showLatestFrame();
+    } else {
+        m_hasClock = false;
+    }
+}
+
+qint64 SlowMotionView::clockMs() const
+{
+    return m_clockBase + qint64(m_clock.elapsed() * m_rate);
+}
+
+void SlowMotionView::setClock(qint64 timeMs)
+{
+    m_clockBase = timeMs;
+    m_clock.start();
+    m_hasClock = true;
+}
+
+void SlowMotionView::showLatestFrame()
+{
+    for (auto it = m_queue.crbegin(); it != m_queue.crend(); ++it) {
+        if (!it->synthesized) {
+            m_currentImage = it->image;
+            break;
+        }
+    }
+    m_queue.clear();
+    update();
+}
+
+void SlowMotionView::onFramesReady(const QList<InterpolatedFrame> &frames)
+{
+    if (!m_active || frames.isEmpty()) {
+        return;
+    }
+    const qint64 originalTime = frames.last().timeMs;
+    if (m_lastOriginalTime >= 0 && originalTime > m_lastOriginalTime) {
+        m_frameIntervalMs = qMin(originalTime - m_lastOriginalTime, qint64(250));
+    }
+    m_lastOriginalTime = originalTime;
+    
+    // 最新的原始帧就是播放器此刻的位置，显示时钟落后一个帧间隔，中间帧才来得及生成
+    qint64 target = originalTime - m_frameIntervalMs - qint64(m_displayIntervalMs * m_rate);
+    if (!m_hasClock || qAbs(target - clockMs()) > ResyncMs) {
+        // 跳转后队列中的旧帧不再有效
+        if (m_hasClock) {
+            m_queue.clear();
+        }
+        setClock(target);
+    } else {
+        // 小的偏差逐渐修正，避免画面跳动
+        qint64 now = clockMs();
+        setClock(now + (target - now) / 8);
+    }
+    
+    m_queue.append(frames);
+    if (m_paused) {
+        showLatestFrame();
+    }
+}
+
+void SlowMotionView::onTick()
+{
+    if (m_paused || m_queue.isEmpty() || !m_hasClock) {
+        return;
+    }
+    // 取出时间不晚于时钟的最后一帧，更早的帧跳过
+    const qint64 now = clockMs();
+    int index = -1;
+    while (index + 1 < m_queue.size() && m_queue.at(index + 1).timeMs <= now) {
+        ++index;
+    }
+    if (index < 0) {
+        return;
+    }
+    m_currentImage = m_queue.at(index).image;
+    m_queue.remove(0, index + 1);
+    update();
+}
+
+void SlowMotionView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_interpolator->setOutputSize((QSizeF(size()) * devicePixelRatioF()).toSize());
+}
+
+void SlowMotionView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    if (!m_currentImage.isNull()) {
+        QRect target(QPoint(0, 0), m_currentImage.size().scaled(size(), Qt::KeepAspectRatio));
+        target.moveCenter(rect().center());
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(target, m_currentImage);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SLOWMOTIONVIEW_H
+#define SLOWMOTIONVIEW_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QList>
+#include "motioninterpolator.h"
+
+class QTimer;
+
+// 慢速播放时代替视频控件显示插帧后的画面
+// 播放器解码出的帧交给MotionInterpolator，插出的中间帧和原始帧按原视频时间排队，
+// 按显示刷新间隔取出当前时刻的帧。中间帧需要等到下一个原始帧才能生成，
+// 画面比声音晚约一个原始帧间隔。
+class SlowMotionView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SlowMotionView(QWidget *parent = nullptr);
+    
+    void start(qreal rate);
+    void stop();
+    bool isActive() const { return m_active; }
+    
+    void addFrame(const QVideoFrame &frame);
+    void setPlaybackRate(qreal rate);
+    void setPaused(bool paused);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void onFramesReady(const QList<InterpolatedFrame> &frames);
+    void onTick();
+
+private:
+    qint64 clockMs() const;
+    void setClock(qint64 timeMs);
+    void showLatestFrame();
+    
+    MotionInterpolator *m_interpolator;
+    QTimer *m_tickTimer;
+    QElapsedTimer m_clock;
+    qint64 m_clockBase;          // m_clock启动时对应的原视频时间
+    bool m_hasClock;
+    qreal m_rate;
+    bool m_paused;
+    bool m_active;
+    int m_displayIntervalMs;
+    qint64 m_lastOriginalTime;
+    qint64 m_frameIntervalMs;
+    QList<InterpolatedFrame> m_queue;
+    QImage m_currentImage;
+};
+
+#endif // SLOWMOTIONVIEW_H
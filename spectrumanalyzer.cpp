@@ -0,0 +1,232 @@
+#include "spectrumanalyzer.h"
+#include "audiobufferutils.h"
+#include "simdkernels.h"
+#include "fft.h"
+#include "tracer.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr float MinFrequency = 40.0f;
+constexpr float MaxFrequency = 16000.0f;
+constexpr float FloorDb = -72.0f;
+
+// 把分贝值映射到 0 ~ 1
+inline float levelFromDb(float db)
+{
+    return qBound(0.0f, (db - FloorDb) / -FloorDb, 1.0f);
+}
+
+}
+
+// 运行在工作线程中，只在工作线程中访问
+class SpectrumWorker : public QObject
+{
+public:
+    explicit SpectrumWorker(SpectrumAnalyzer *owner)
+        : m_owner(owner)
+        , m_fft(SpectrumAnalyzer::FftSize)
+        , m_window(SpectrumAnalyzer::FftSize)
+        , m_history(SpectrumAnalyzer::FftSize, 0.0f)
+        , m_re(SpectrumAnalyzer::FftSize)
+        , m_im(SpectrumAnalyzer::FftSize)
+        , m_power(SpectrumAnalyzer::FftSize / 2)
+    {
+        const int size = SpectrumAnalyzer::FftSize;
+        for (int i = 0; i < size; ++i) {
+            m_window[size_t(i)] = float(0.5 - 0.5 * std::cos(2.0 * M_PI * i / (size - 1)));
+        }
+        // 满幅正弦经汉宁窗后峰值处的模为 size/4，以此作为0dB
+        m_fullScalePower = float(size / 4) * float(size / 4);
+    }
+    
+    void reset(quint64 session)
+    {
+        m_session = session;
+        std::fill(m_history.begin(), m_history.end(), 0.0f);
+        m_averageUs = 0.0f;
+        m_maxUs = 0.0f;
+    }
+    
+    void process(quint64 session, const QAudioBuffer &buffer)
+    {
+        if (session != m_session) {
+            return;
+        }
+        TraceScope scope("频谱分析");
+        QElapsedTimer timer;
+        timer.start();
+        
+        AudioBufferUtils::toMonoFloat(buffer, m_samples);
+        const int count = int(m_samples.size());
+        if (count == 0) {
+            return;
+        }
+        int sampleRate = buffer.format().sampleRate();
+        if (sampleRate != m_sampleRate) {
+            updateBands(sampleRate);
+        }
+        
+        // 分析窗口滑动到最新的采样
+        const int size = SpectrumAnalyzer::FftSize;
+        if (count >= size) {
+            std::memcpy(m_history.data(), m_samples.data() + (count - size), sizeof(float) * size_t(size));
+        } else {
+            std::memmove(m_history.data(), m_history.data() + count, sizeof(float) * size_t(size - count));
+            std::memcpy(m_history.data() + (size - count), m_samples.data(), sizeof(float) * size_t(count));
+        }
+        
+        SimdKernels::mulF32(m_history.data(), m_window.data(), m_re.data(), size);
+        std::fill(m_im.begin(), m_im.end(), 0.0f);
+        m_fft.transform(m_re.data(), m_im.data());
+        SimdKernels::powerF32(m_re.data(), m_im.data(), m_power.data(), size / 2);
+        
+        for (int band = 0; band < SpectrumFrame::BandCount; ++band) {
+            const float *first = m_power.data() + m_bandFirst[band];
+            const float *last = m_power.data() + m_bandLast[band];
+            float power = *std::max_element(first, last);
+            m_back.bands[band] = levelFromDb(10.0f * std::log10(power / m_fullScalePower + 1e-12f));
+        }
+        
+        // 电平只统计本次的新采样
+        float low = 0.0f;
+        float high = 0.0f;
+        SimdKernels::minMaxF32(m_samples.data(), count, &low, &high);
+        float meanSquare = SimdKernels::dotF32(m_samples.data(), m_samples.data(), count) / count;
+        m_back.rms = levelFromDb(10.0f * std::log10(meanSquare + 1e-12f));
+        m_back.peak = levelFromDb(20.0f * std::log10(qMax(-low, high) + 1e-6f));
+        
+        float elapsedUs = timer.nsecsElapsed() / 1000.0f;
+        m_averageUs = m_averageUs > 0.0f ? m_averageUs * 0.95f + elapsedUs * 0.05f : elapsedUs;
+        m_maxUs = qMax(m_maxUs, elapsedUs);
+        m_back.processingUs = elapsedUs;
+        m_back.averageUs = m_averageUs;
+        m_back.maxUs = m_maxUs;
+        m_back.dropped = m_owner->m_dropped.load(std::memory_order_relaxed);
+        m_owner->publish(m_back);
+    }
+
+private:
+    // 频带在对数频率上等分，每个频带至少包含一个频点
+    void updateBands(int sampleRate)
+    {
+        m_sampleRate = sampleRate;
+        const int bins = SpectrumAnalyzer::FftSize / 2;
+        const float binHz = float(qMax(1, sampleRate)) / SpectrumAnalyzer::FftSize;
+        const float top = qMin(MaxFrequency, sampleRate / 2.0f);
+        const float ratio = std::pow(top / MinFrequency, 1.0f / SpectrumFrame::BandCount);
+        float frequency = MinFrequency;
+        for (int band = 0; band < SpectrumFrame::BandCount; ++band) {
+            float next = frequency * ratio;
+            int first = qBound(1, int(frequency / binHz), bins - 1);
+            int last = qBound(first + 1, int(next / binHz), bins);
+            m_bandFirst[band] = first;
+            m_bandLast[band] = last;
+            frequency = next;
+        }
+    }
+    
+    SpectrumAnalyzer *m_owner;
+    quint64 m_session = 0;
+    int m_sampleRate = 0;
+    Fft m_fft;
+    std::vector<float> m_window;
+    std::vector<float> m_history;
+    std::vector<float> m_samples;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_power;
+    float m_fullScalePower = 1.0f;
+    int m_bandFirst[SpectrumFrame::BandCount] = {};
+    int m_bandLast[SpectrumFrame::BandCount] = {};
+    float m_averageUs = 0.0f;
+    float m_maxUs = 0.0f;
+    SpectrumFrame m_back;
+};
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+    , m_session(0)
+    , m_pendingBuffers(0)
+    , m_dropped(0)
+    , m_frontFresh(false)
+{
+    m_worker = new SpectrumWorker(this);
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("频谱分析");
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void SpectrumAnalyzer::addBuffer(const QAudioBuffer &buffer)
+{
+    if (m_pendingBuffers.fetch_add(1, std::memory_order_relaxed) >= MaxPendingBuffers) {
+        m_pendingBuffers.fetch_sub(1, std::memory_order_relaxed);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // QAudioBuffer是隐式共享的，传给工作线程不复制PCM
+    SpectrumWorker *worker = m_worker;
+    quint64 session = m_session;
+    QMetaObject::invokeMethod(m_worker, [this, worker, session, buffer]() {
+        m_pendingBuffers.fetch_sub(1, std::memory_order_relaxed);
+        worker->process(session, buffer);
+    }, Qt::QueuedConnection);
+}
+
+void SpectrumAnalyzer::reset()
+{
+    // 递增会话号，工作线程中尚未处理的旧缓冲都会被丢弃
+    SpectrumWorker *worker = m_worker;
+    quint64 session = ++m_session;
+    QMetaObject::invokeMethod(m_worker, [worker, session]() {
+        worker->reset(session);
+    }, Qt::QueuedConnection);
+    
+    QMutexLocker locker(&m_frontMutex);
+    m_frontFresh = false;
+}
+
+bool SpectrumAnalyzer::takeFrame(SpectrumFrame *frame)
+{
+    QMutexLocker locker(&m_frontMutex);
+    if (!m_frontFresh) {
+        return false;
+    }
+    *frame = m_front;
+    m_frontFresh = false;
+    return true;
+}
+
+void SpectrumAnalyzer::publish(SpectrumFrame &back)
+{
+    bool notify;
+    {
+        QMutexLocker locker(&m_frontMutex);
+        std::swap(m_front, back);
+        notify = !m_frontFresh;
+        m_frontFresh = true;
+    }
+    // 界面还没取走上一个结果时不再通知，通知频率不超过界面的取用频率
+    if (notify) {
+        emit frameReady();
+    }
+}
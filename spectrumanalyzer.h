@@ -0,0 +1,66 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAudioBuffer>
+#include <atomic>
+
+class QThread;
+class SpectrumWorker;
+
+// 一次分析的结果，电平都映射到 0（-72dB及以下）~ 1（0dBFS）
+struct SpectrumFrame
+{
+    static constexpr int BandCount = 48;
+    
+    float bands[BandCount] = {};   // 按对数频率划分的频带，40Hz ~ 16kHz
+    float rms = 0.0f;
+    float peak = 0.0f;
+    float processingUs = 0.0f;     // 本次处理（格式转换、加窗、FFT、分频带）耗时，微秒
+    float averageUs = 0.0f;
+    float maxUs = 0.0f;
+    quint64 dropped = 0;           // 积压过多而丢弃的缓冲数
+};
+
+// 实时音频频谱分析
+// 播放器交出的音频缓冲在工作线程中转为单声道，取最近2048个采样加汉宁窗做FFT，
+// 按频带求电平。结果双缓冲：工作线程写后台缓冲后与前台交换，界面按显示帧率取走前台结果，
+// 每次取走后有新结果时最多通知一次。工作线程来不及处理时丢弃新缓冲，不拖慢播放。
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumAnalyzer(QObject *parent = nullptr);
+    ~SpectrumAnalyzer() override;
+    
+    void addBuffer(const QAudioBuffer &buffer);
+    // 切换视频时清空分析窗口
+    void reset();
+    // 取走最新结果，上次取走后没有新结果时返回false
+    bool takeFrame(SpectrumFrame *frame);
+    
+    static constexpr int FftSize = 2048;
+    static constexpr int MaxPendingBuffers = 4;
+
+signals:
+    void frameReady();
+
+private:
+    friend class SpectrumWorker;
+    // 工作线程调用：把写好的后台缓冲与前台交换
+    void publish(SpectrumFrame &back);
+    
+    QThread *m_workerThread;
+    SpectrumWorker *m_worker;
+    quint64 m_session;
+    std::atomic<int> m_pendingBuffers;
+    std::atomic<quint64> m_dropped;
+    
+    QMutex m_frontMutex;
+    SpectrumFrame m_front;
+    bool m_frontFresh;
+};
+
+#endif // SPECTRUMANALYZER_H
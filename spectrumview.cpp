@@ -0,0 +1,152 @@
+#include "spectrumview.h"
+#include <QPainter>
+#include <QLinearGradient>
+#include <QScreen>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr float FallPerSecond = 1.5f;      // 频带柱每秒下落满幅的比例
+constexpr float PeakFallPerSecond = 0.6f;
+constexpr float PeakHoldMs = 600.0f;
+constexpr int MeterWidth = 10;
+constexpr int BarGap = 1;
+
+}
+
+SpectrumView::SpectrumView(SpectrumAnalyzer *analyzer, QWidget *parent)
+    : QWidget(parent)
+    , m_analyzer(analyzer)
+    , m_timer(nullptr)
+    , m_rms(0.0f)
+    , m_peak(0.0f)
+{
+    setFixedHeight(64);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setToolTip("音频频谱（A 键显示/隐藏）");
+    
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SpectrumView::onTick);
+    connect(m_analyzer, &SpectrumAnalyzer::frameReady, this, &SpectrumView::onFrameReady);
+    clear();
+}
+
+void SpectrumView::clear()
+{
+    std::fill(std::begin(m_bands), std::end(m_bands), 0.0f);
+    std::fill(std::begin(m_peaks), std::end(m_peaks), 0.0f);
+    std::fill(std::begin(m_peakHoldMs), std::end(m_peakHoldMs), 0.0f);
+    m_rms = 0.0f;
+    m_peak = 0.0f;
+    m_frame = SpectrumFrame();
+    update();
+}
+
+void SpectrumView::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    onFrameReady();
+}
+
+void SpectrumView::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_timer->stop();
+}
+
+void SpectrumView::onFrameReady()
+{
+    if (!isVisible() || m_timer->isActive()) {
+        return;
+    }
+    // 与显示器刷新同步取结果，更快的音频缓冲只保留最新的一个
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    m_timer->start(qMax(4, int(1000.0 / qBound(30.0, refreshRate, 240.0))));
+    m_clock.start();
+}
+
+void SpectrumView::onTick()
+{
+    float elapsedMs = float(m_clock.restart());
+    float fall = FallPerSecond * elapsedMs / 1000.0f;
+    float peakFall = PeakFallPerSecond * elapsedMs / 1000.0f;
+    bool fresh = m_analyzer->takeFrame(&m_frame);
+    
+    bool active = fresh;
+    for (int band = 0; band < SpectrumFrame::BandCount; ++band) {
+        float target = fresh ? m_frame.bands[band] : 0.0f;
+        m_bands[band] = qMax(target, m_bands[band] - fall);
+        if (m_bands[band] >= m_peaks[band]) {
+            m_peaks[band] = m_bands[band];
+            m_peakHoldMs[band] = PeakHoldMs;
+        } else if (m_peakHoldMs[band] > 0.0f) {
+            m_peakHoldMs[band] -= elapsedMs;
+        } else {
+            m_peaks[band] = qMax(0.0f, m_peaks[band] - peakFall);
+        }
+        active = active || m_bands[band] > 0.0f || m_peaks[band] > 0.0f;
+    }
+    m_rms = qMax(fresh ? m_frame.rms : 0.0f, m_rms - fall);
+    m_peak = qMax(fresh ? m_frame.peak : 0.0f, m_peak - fall);
+    active = active || m_rms > 0.0f || m_peak > 0.0f;
+    
+    update();
+    if (!active) {
+        // 没有新数据且已全部落到底，等下一次有结果时再启动
+        m_timer->stop();
+    }
+}
+
+void SpectrumView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+    
+    const int h = height() - 2;
+    QLinearGradient gradient(0, height(), 0, 0);
+    gradient.setColorAt(0.0, QColor(0, 150, 90));
+    gradient.setColorAt(0.7, QColor(220, 200, 40));
+    gradient.setColorAt(1.0, QColor(230, 60, 40));
+    
+    // 频带柱
+    const int barsWidth = width() - MeterWidth - 8;
+    const qreal barWidth = qreal(barsWidth) / SpectrumFrame::BandCount;
+    for (int band = 0; band < SpectrumFrame::BandCount; ++band) {
+        int left = int(band * barWidth) + 2;
+        int right = int((band + 1) * barWidth) + 2 - BarGap;
+        int barHeight = int(m_bands[band] * h);
+        if (barHeight > 0) {
+            painter.fillRect(QRect(left, height() - 1 - barHeight, right - left, barHeight), gradient);
+        }
+        int peakY = height() - 1 - int(m_peaks[band] * h);
+        if (m_peaks[band] > 0.0f) {
+            painter.fillRect(QRect(left, peakY, right - left, 1), QColor(220, 220, 220));
+        }
+    }
+    
+    // 电平表：填充为有效值，横线为峰值
+    QRect meter(width() - MeterWidth - 2, 1, MeterWidth, h);
+    painter.fillRect(meter, QColor(50, 50, 50));
+    int rmsHeight = int(m_rms * h);
+    painter.fillRect(QRect(meter.left(), meter.bottom() + 1 - rmsHeight, MeterWidth, rmsHeight), gradient);
+    if (m_peak > 0.0f) {
+        painter.fillRect(QRect(meter.left(), meter.bottom() - int(m_peak * h), MeterWidth, 2), QColor(240, 240, 240));
+    }
+    
+    // 处理耗时
+    if (m_frame.maxUs > 0.0f) {
+        QString text = QString("处理 %1 ms / 最大 %2 ms")
+                           .arg(m_frame.averageUs / 1000.0, 0, 'f', 3)
+                           .arg(m_frame.maxUs / 1000.0, 0, 'f', 3);
+        if (m_frame.dropped > 0) {
+            text += QString(" / 丢弃 %1").arg(m_frame.dropped);
+        }
+        QFont font = painter.font();
+        font.setPointSize(8);
+        painter.setFont(font);
+        painter.setPen(QColor(160, 160, 160));
+        painter.drawText(rect().adjusted(6, 2, 0, 0), Qt::AlignLeft | Qt::AlignTop, text);
+    }
+}
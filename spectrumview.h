@@ -0,0 +1,43 @@
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "spectrumanalyzer.h"
+
+// 视频下方的音频频谱和电平表
+// 显示期间按显示帧率从分析器取最新结果；频带柱下落有惯性并保留峰值，
+// 暂停或静音后全部落到底时停止定时器。左上角显示每个缓冲的处理耗时。
+class SpectrumView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumView(SpectrumAnalyzer *analyzer, QWidget *parent = nullptr);
+    
+    // 清空显示（切换视频时）
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onFrameReady();
+    void onTick();
+
+private:
+    SpectrumAnalyzer *m_analyzer;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    SpectrumFrame m_frame;
+    float m_bands[SpectrumFrame::BandCount];
+    float m_peaks[SpectrumFrame::BandCount];
+    float m_peakHoldMs[SpectrumFrame::BandCount];
+    float m_rms;
+    float m_peak;
+};
+
+#endif // SPECTRUMVIEW_H
@@ -0,0 +1,41 @@
+#include "startupprofiler.h"
+#include <QDebug>
+
+StartupProfiler &StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_lastMark(0)
+    , m_enabled(false)
+    , m_reported(false)
+{
+    m_timer.start();
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+    qint64 now = m_timer.nsecsElapsed();
+    m_phases.append(qMakePair(phase, now - m_lastMark));
+    m_lastMark = now;
+}
+
+void StartupProfiler::report()
+{
+    if (!m_enabled || m_reported) {
+        return;
+    }
+    m_reported = true;
+
+    qInfo().noquote() << "启动耗时分析:";
+    for (const QPair<QString, qint64> &phase : m_phases) {
+        qInfo().noquote() << QString("  %1 %2 ms")
+                                 .arg(phase.first, -24)
+                                 .arg(phase.second / 1000000.0, 0, 'f', 2);
+    }
+    qInfo().noquote() << QString("  %1 %2 ms")
+                             .arg("合计", -24)
+                             .arg(m_lastMark / 1000000.0, 0, 'f', 2);
+}
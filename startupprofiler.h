@@ -0,0 +1,35 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// 启动耗时分析器，按阶段记录启动过程的耗时
+// 始终记录（开销可忽略），只有通过 --startup-profile 参数启用时才打印
+class StartupProfiler
+{
+public:
+    static StartupProfiler &instance();
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    // 标记一个阶段结束，耗时从上一个标记点开始计算
+    void mark(const QString &phase);
+
+    // 打印各阶段耗时（只打印一次）
+    void report();
+
+private:
+    StartupProfiler();
+
+    QElapsedTimer m_timer;
+    qint64 m_lastMark;
+    QList<QPair<QString, qint64>> m_phases;
+    bool m_enabled;
+    bool m_reported;
+};
+
+#endif // STARTUPPROFILER_H
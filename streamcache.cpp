@@ -0,0 +1,219 @@
+#include "streamcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+
+StreamCache::StreamCache(const QString &directory, qint64 maxBytes)
+    : m_directory(directory)
+    , m_maxBytes(maxBytes)
+    , m_totalBytes(0)
+    , m_lastStamp(0)
+{
+    QDir().mkpath(m_directory);
+    scanDirectory();
+}
+
+QString StreamCache::keyForUrl(const QUrl &url)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(url.toEncoded());
+    return hash.result().toHex();
+}
+
+void StreamCache::scanDirectory()
+{
+    // 恢复上次运行留下的缓存，文件修改时间作为最近访问时间
+    QDir root(m_directory);
+    const QStringList keys = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &key : keys) {
+        QFile infoFile(resourceDirectory(key) + "/info");
+        if (!infoFile.open(QIODevice::ReadOnly)) {
+            QDir(resourceDirectory(key)).removeRecursively();
+            continue;
+        }
+        QList<QByteArray> lines = infoFile.readAll().split('\n');
+        ResourceInfo info;
+        info.size = lines.value(0).toLongLong();
+        info.contentType = lines.value(1);
+        m_resources.insert(key, info);
+        
+        const QFileInfoList blocks = QDir(resourceDirectory(key)).entryInfoList({"*.blk"}, QDir::Files);
+        for (const QFileInfo &blockInfo : blocks) {
+            BlockEntry entry;
+            entry.size = blockInfo.size();
+            entry.stamp = blockInfo.lastModified().toMSecsSinceEpoch();
+            while (m_lru.contains(entry.stamp)) {
+                ++entry.stamp;
+            }
+            QString name = blockName(key, blockInfo.completeBaseName().toLongLong());
+            m_blocks.insert(name, entry);
+            m_lru.insert(entry.stamp, name);
+            m_totalBytes += entry.size;
+            m_lastStamp = qMax(m_lastStamp, entry.stamp);
+        }
+    }
+    evictIfNeeded(QString());
+}
+
+qint64 StreamCache::resourceSize(const QString &key) const
+{
+    auto it = m_resources.constFind(key);
+    return it != m_resources.constEnd() ? it->size : -1;
+}
+
+QByteArray StreamCache::contentType(const QString &key) const
+{
+    return m_resources.value(key).contentType;
+}
+
+void StreamCache::setResourceInfo(const QString &key, qint64 size, const QByteArray &contentType)
+{
+    auto it = m_resources.constFind(key);
+    if (it != m_resources.constEnd() && it->size == size && it->contentType == contentType) {
+        return;
+    }
+    
+    // 资源大小变化说明远程文件已更新，旧数据块作废
+    if (it != m_resources.constEnd() && it->size != size) {
+        const QString prefix = key + "/";
+        for (auto block = m_blocks.begin(); block != m_blocks.end();) {
+            if (block.key().startsWith(prefix)) {
+                m_lru.remove(block->stamp);
+                m_totalBytes -= block->size;
+                QFile::remove(m_directory + "/" + block.key() + ".blk");
+                block = m_blocks.erase(block);
+            } else {
+                ++block;
+            }
+        }
+    }
+    
+    ResourceInfo info;
+    info.size = size;
+    info.contentType = contentType;
+    m_resources.insert(key, info);
+    
+    QDir().mkpath(resourceDirectory(key));
+    QFile infoFile(resourceDirectory(key) + "/info");
+    if (infoFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        infoFile.write(QByteArray::number(size) + "\n" + contentType);
+    }
+}
+
+qint64 StreamCache::expectedBlockSize(const QString &key, qint64 index) const
+{
+    qint64 size = resourceSize(key);
+    if (size < 0) {
+        return BlockSize;
+    }
+    return qBound<qint64>(0, size - index * BlockSize, BlockSize);
+}
+
+bool StreamCache::hasBlock(const QString &key, qint64 index) const
+{
+    return m_blocks.contains(blockName(key, index));
+}
+
+bool StreamCache::readBlock(const QString &key, qint64 index, QByteArray *data)
+{
+    QString name = blockName(key, index);
+    auto it = m_blocks.find(name);
+    if (it == m_blocks.end()) {
+        return false;
+    }
+    
+    QFile file(blockPath(key, index));
+    if (!file.open(QIODevice::ReadWrite)) {
+        // 文件被外部删除，同步索引
+        m_lru.remove(it->stamp);
+        m_totalBytes -= it->size;
+        m_blocks.erase(it);
+        return false;
+    }
+    *data = file.readAll();
+    
+    touch(name, *it);
+    file.setFileTime(QDateTime::fromMSecsSinceEpoch(it->stamp), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void StreamCache::writeBlock(const QString &key, qint64 index, const QByteArray &data)
+{
+    if (data.size() > m_maxBytes) {
+        return;
+    }
+    
+    QDir().mkpath(resourceDirectory(key));
+    QFile file(blockPath(key, index));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+        file.remove();
+        return;
+    }
+    file.close();
+    
+    QString name = blockName(key, index);
+    auto it = m_blocks.find(name);
+    if (it != m_blocks.end()) {
+        m_totalBytes -= it->size;
+        it->size = data.size();
+        m_totalBytes += it->size;
+        touch(name, *it);
+    } else {
+        BlockEntry entry;
+        entry.size = data.size();
+        entry.stamp = nextStamp();
+        m_blocks.insert(name, entry);
+        m_lru.insert(entry.stamp, name);
+        m_totalBytes += entry.size;
+    }
+    
+    evictIfNeeded(name);
+}
+
+QString StreamCache::resourceDirectory(const QString &key) const
+{
+    return m_directory + "/" + key;
+}
+
+QString StreamCache::blockPath(const QString &key, qint64 index) const
+{
+    return m_directory + "/" + blockName(key, index) + ".blk";
+}
+
+QString StreamCache::blockName(const QString &key, qint64 index)
+{
+    return key + "/" + QString::number(index);
+}
+
+void StreamCache::touch(const QString &name, BlockEntry &entry)
+{
+    m_lru.remove(entry.stamp);
+    entry.stamp = nextStamp();
+    m_lru.insert(entry.stamp, name);
+}
+
+qint64 StreamCache::nextStamp()
+{
+    m_lastStamp = qMax(m_lastStamp + 1, QDateTime::currentMSecsSinceEpoch());
+    return m_lastStamp;
+}
+
+void StreamCache::evictIfNeeded(const QString &keepName)
+{
+    auto it = m_lru.begin();
+    while (m_totalBytes > m_maxBytes && it != m_lru.end()) {
+        if (it.value() == keepName) {
+            ++it;
+            continue;
+        }
+        auto block = m_blocks.find(it.value());
+        if (block != m_blocks.end()) {
+            m_totalBytes -= block->size;
+            m_blocks.erase(block);
+        }
+        QFile::remove(m_directory + "/" + it.value() + ".blk");
+        it = m_lru.erase(it);
+    }
+}
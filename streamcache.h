@@ -0,0 +1,65 @@
+#ifndef STREAMCACHE_H
+#define STREAMCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QUrl>
+
+// 网络视频的磁盘缓存
+// 每个远程资源按固定大小分块保存（HLS分段和播放列表也是资源），
+// 总大小超过上限时按最近最少使用的顺序淘汰数据块。
+// 非线程安全，只在代理线程中使用。
+class StreamCache
+{
+public:
+    StreamCache(const QString &directory, qint64 maxBytes);
+    
+    static QString keyForUrl(const QUrl &url);
+    
+    // 资源信息（总大小未知时返回-1）
+    qint64 resourceSize(const QString &key) const;
+    QByteArray contentType(const QString &key) const;
+    void setResourceInfo(const QString &key, qint64 size, const QByteArray &contentType);
+    
+    bool hasBlock(const QString &key, qint64 index) const;
+    bool readBlock(const QString &key, qint64 index, QByteArray *data);
+    void writeBlock(const QString &key, qint64 index, const QByteArray &data);
+    
+    // 资源的第index块应有的大小（最后一块可能不满）
+    qint64 expectedBlockSize(const QString &key, qint64 index) const;
+    
+    qint64 totalBytes() const { return m_totalBytes; }
+    qint64 maxBytes() const { return m_maxBytes; }
+    
+    static constexpr qint64 BlockSize = 1024 * 1024;
+
+private:
+    struct ResourceInfo {
+        qint64 size;
+        QByteArray contentType;
+    };
+    struct BlockEntry {
+        qint64 size;
+        qint64 stamp;
+    };
+    
+    void scanDirectory();
+    QString resourceDirectory(const QString &key) const;
+    QString blockPath(const QString &key, qint64 index) const;
+    static QString blockName(const QString &key, qint64 index);
+    void touch(const QString &name, BlockEntry &entry);
+    qint64 nextStamp();
+    void evictIfNeeded(const QString &keepName);
+    
+    QString m_directory;
+    qint64 m_maxBytes;
+    qint64 m_totalBytes;
+    qint64 m_lastStamp;
+    QHash<QString, ResourceInfo> m_resources;
+    QHash<QString, BlockEntry> m_blocks;   // "资源键/块号" -> 数据块
+    QMap<qint64, QString> m_lru;           // 访问时间戳 -> 数据块，最早的排在前面
+};
+
+#endif // STREAMCACHE_H
@@ -0,0 +1,874 @@
+#include "streamproxy.h"
+#include "streamcache.h"
+#include "mediapath.h"
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include <QPointer>
+#include <QRandomGenerator>
+
+namespace {
+// 单个连接待发送数据的上限，超过时等播放器读走后再继续
+const qint64 MaxPendingBytes = 4 * 1024 * 1024;
+const QByteArray PlaylistContentType = "application/vnd.apple.mpegurl";
+
+bool isPlaylistUrl(const QUrl &url)
+{
+    QString path = url.path().toLower();
+    return path.endsWith(".m3u8") || path.endsWith(".m3u");
+}
+}
+
+class WholeDownload;
+
+// 运行在代理线程中的服务端，持有监听套接字、网络访问和缓存
+class StreamProxyServer : public QObject
+{
+public:
+    StreamProxyServer()
+        : m_server(nullptr)
+        , m_network(nullptr)
+        , m_cache(nullptr)
+    {
+    }
+
+    ~StreamProxyServer() override
+    {
+        delete m_cache;
+    }
+
+    quint16 listen(const QString &cacheDirectory, qint64 cacheMaxBytes, const QByteArray &token);
+    quint16 port() const { return m_server ? m_server->serverPort() : 0; }
+    QByteArray token() const { return m_token; }
+    StreamCache *cache() { return m_cache; }
+    QNetworkAccessManager *network() { return m_network; }
+
+    // 正在进行的完整资源下载，每个资源最多一个
+    WholeDownload *wholeDownload(const QString &key) const { return m_wholeDownloads.value(key); }
+    void setWholeDownload(const QString &key, WholeDownload *download) { m_wholeDownloads.insert(key, download); }
+    void removeWholeDownload(const QString &key, WholeDownload *download)
+    {
+        if (m_wholeDownloads.value(key) == download) {
+            m_wholeDownloads.remove(key);
+        }
+    }
+
+private:
+    QTcpServer *m_server;
+    QNetworkAccessManager *m_network;
+    StreamCache *m_cache;
+    QByteArray m_token;
+    QHash<QString, WholeDownload *> m_wholeDownloads;
+};
+
+// 代理的一个客户端连接，处理一次HTTP请求后关闭
+class ProxyConnection : public QObject
+{
+public:
+    ProxyConnection(QTcpSocket *socket, StreamProxyServer *server);
+
+    // 等待的完整资源下载又写入了数据块，或者下载结束
+    void onWholeProgress();
+    void onWholeFinished(bool ok);
+
+private:
+    void onReadyRead();
+    void onDisconnected();
+    void handleRequest(const QByteArray &method, const QByteArray &target, const QByteArray &hostHeader,
+                       const QByteArray &rangeHeader);
+
+    void servePlaylist();
+    void onPlaylistFetched(QNetworkReply *reply);
+    void sendPlaylist(const QByteArray &playlist);
+    QByteArray rewritePlaylist(const QByteArray &playlist) const;
+
+    void serveBytes();
+    void startBody();
+    void pump();
+    void fetchBlock(qint64 index);
+    void onBlockFetched(QNetworkReply *reply, qint64 index);
+    void onBlockData(QNetworkReply *reply);
+    void adoptWholeDownload(QNetworkReply *reply);
+    void continueServing();
+    bool blockData(qint64 index, QByteArray *data);
+
+    void sendHeaders(const QByteArray &statusLine, const QList<QPair<QByteArray, QByteArray>> &headers);
+    void sendError(int status, const QByteArray &reason);
+    void finish();
+
+    QTcpSocket *m_socket;
+    StreamProxyServer *m_server;
+    QByteArray m_requestBuffer;
+    bool m_requestHandled;
+    bool m_headOnly;
+    bool m_socketGone;
+    bool m_headersSent;
+    bool m_finished;
+
+    QUrl m_remoteUrl;
+    QString m_key;
+
+    // 请求的字节范围，m_rangeEnd为-1表示直到末尾，m_suffixLength用于 bytes=-N
+    bool m_hasRange;
+    qint64 m_rangeStart;
+    qint64 m_rangeEnd;
+    qint64 m_suffixLength;
+    qint64 m_nextOffset;
+    qint64 m_endOffset;
+
+    QPointer<QNetworkReply> m_reply;
+    qint64 m_fetchedIndex;
+    QByteArray m_fetchedData;   // 最近下载的块，缓存写入失败时也能直接使用
+};
+
+// 源站忽略Range返回完整资源（200）时的共享下载
+// 每个资源同时只有一个，边接收边按块写入缓存，内存中只保留不满一块的数据。
+// 等待其中数据块的连接（包括跳转后新建的连接）在每块写入后继续发送，
+// 不会各自再下载一份；播放器断开后下载继续完成以填充缓存。
+class WholeDownload : public QObject
+{
+public:
+    WholeDownload(StreamProxyServer *server, const QString &key, QNetworkReply *reply);
+
+    void addWaiter(ProxyConnection *connection);
+    // 处理创建前已经收到的数据，响应已结束时直接完成
+    void begin();
+    // 最近写入的块，缓存写入失败时也能直接使用
+    bool lastBlock(qint64 index, QByteArray *data) const;
+
+private:
+    void onData();
+    void onFinished();
+    void storeBlock(const QByteArray &data);
+
+    StreamProxyServer *m_server;
+    QString m_key;
+    QNetworkReply *m_reply;
+    bool m_finished;
+    qint64 m_nextBlock;         // 正在接收的块号
+    QByteArray m_buffer;
+    qint64 m_lastIndex;
+    QByteArray m_lastData;
+    QList<QPointer<ProxyConnection>> m_waiters;
+};
+
+quint16 StreamProxyServer::listen(const QString &cacheDirectory, qint64 cacheMaxBytes, const QByteArray &token)
+{
+    m_token = token;
+    m_cache = new StreamCache(cacheDirectory, cacheMaxBytes);
+    m_network = new QNetworkAccessManager(this);
+    m_server = new QTcpServer(this);
+
+    QObject::connect(m_server, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+            new ProxyConnection(socket, this);
+        }
+    });
+
+    if (!m_server->listen(QHostAddress::LocalHost, 0)) {
+        return 0;
+    }
+    return m_server->serverPort();
+}
+
+ProxyConnection::ProxyConnection(QTcpSocket *socket, StreamProxyServer *server)
+    : QObject(server)
+    , m_socket(socket)
+    , m_server(server)
+    , m_requestHandled(false)
+    , m_headOnly(false)
+    , m_socketGone(false)
+    , m_headersSent(false)
+    , m_finished(false)
+    , m_hasRange(false)
+    , m_rangeStart(0)
+    , m_rangeEnd(-1)
+    , m_suffixLength(-1)
+    , m_nextOffset(0)
+    , m_endOffset(0)
+    , m_fetchedIndex(-1)
+{
+    m_socket->setParent(this);
+    connect(m_socket, &QTcpSocket::readyRead, this, [this]() { onReadyRead(); });
+    connect(m_socket, &QTcpSocket::disconnected, this, [this]() { onDisconnected(); });
+    connect(m_socket, &QTcpSocket::bytesWritten, this, [this]() { pump(); });
+}
+
+void ProxyConnection::onReadyRead()
+{
+    if (m_requestHandled) {
+        m_socket->readAll();
+        return;
+    }
+
+    m_requestBuffer += m_socket->readAll();
+    int headerEnd = m_requestBuffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (m_requestBuffer.size() > 64 * 1024) {
+            sendError(400, "Bad Request");
+        }
+        return;
+    }
+    m_requestHandled = true;
+
+    QList<QByteArray> lines = m_requestBuffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    QByteArray hostHeader;
+    QByteArray rangeHeader;
+    for (int i = 1; i < lines.size(); ++i) {
+        QByteArray line = lines.at(i).trimmed();
+        int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        QByteArray name = line.left(colon).trimmed().toLower();
+        if (name == "range") {
+            rangeHeader = line.mid(colon + 1).trimmed();
+        } else if (name == "host") {
+            hostHeader = line.mid(colon + 1).trimmed().toLower();
+        }
+    }
+
+    handleRequest(requestLine.value(0), requestLine.value(1), hostHeader, rangeHeader);
+}
+
+void ProxyConnection::onDisconnected()
+{
+    // 播放器跳转时会直接断开连接；正在进行的下载继续完成以填充缓存
+    // （完整资源下载不属于连接，等待它的连接可以直接释放）
+    m_socketGone = true;
+    if (!m_reply) {
+        deleteLater();
+    }
+}
+
+void ProxyConnection::handleRequest(const QByteArray &method, const QByteArray &target, const QByteArray &hostHeader,
+                                    const QByteArray &rangeHeader)
+{
+    if (method != "GET" && method != "HEAD") {
+        sendError(405, "Method Not Allowed");
+        return;
+    }
+    m_headOnly = (method == "HEAD");
+
+    // 只接受发往本机地址的请求（网页经DNS重绑定发来的请求Host是其他域名），且必须带有本次启动的令牌
+    QByteArray port = QByteArray::number(m_server->port());
+    if (hostHeader != "127.0.0.1:" + port && hostHeader != "localhost:" + port) {
+        sendError(403, "Forbidden");
+        return;
+    }
+    QUrlQuery query(QUrl::fromEncoded(target));
+    if (query.queryItemValue("t").toLatin1() != m_server->token()) {
+        sendError(403, "Forbidden");
+        return;
+    }
+    QByteArray encoded = QByteArray::fromBase64(query.queryItemValue("u").toLatin1(), QByteArray::Base64UrlEncoding);
+    m_remoteUrl = QUrl::fromEncoded(encoded);
+    if (!isStreamUrl(m_remoteUrl.toString())) {
+        sendError(400, "Bad Request");
+        return;
+    }
+    m_key = StreamCache::keyForUrl(m_remoteUrl);
+
+    // 解析 Range: bytes=a-b / bytes=a- / bytes=-n
+    if (rangeHeader.startsWith("bytes=")) {
+        QByteArray spec = rangeHeader.mid(6).split(',').value(0).trimmed();
+        int dash = spec.indexOf('-');
+        if (dash >= 0) {
+            bool startOk = false;
+            bool endOk = false;
+            qint64 start = spec.left(dash).toLongLong(&startOk);
+            qint64 end = spec.mid(dash + 1).toLongLong(&endOk);
+            if (dash == 0 && endOk) {
+                m_hasRange = true;
+                m_suffixLength = end;
+            } else if (startOk) {
+                m_hasRange = true;
+                m_rangeStart = start;
+                m_rangeEnd = endOk ? end : -1;
+            }
+        }
+    }
+
+    if (isPlaylistUrl(m_remoteUrl)) {
+        servePlaylist();
+    } else {
+        serveBytes();
+    }
+}
+
+void ProxyConnection::servePlaylist()
+{
+    // 点播播放列表（带结束标记）不会再变化，直接使用缓存
+    QByteArray cached;
+    if (m_server->cache()->readBlock(m_key, 0, &cached) && cached.contains("#EXT-X-ENDLIST")) {
+        sendPlaylist(cached);
+        return;
+    }
+
+    QNetworkReply *reply = m_server->network()->get(QNetworkRequest(m_remoteUrl));
+    m_reply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() { onPlaylistFetched(reply); });
+}
+
+void ProxyConnection::onPlaylistFetched(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    m_reply = nullptr;
+
+    QByteArray playlist;
+    if (reply->error() == QNetworkReply::NoError) {
+        playlist = reply->readAll();
+        m_server->cache()->setResourceInfo(m_key, playlist.size(), PlaylistContentType);
+        m_server->cache()->writeBlock(m_key, 0, playlist);
+    } else if (!m_server->cache()->readBlock(m_key, 0, &playlist)) {
+        // 网络不可用且没有缓存
+        if (m_socketGone) {
+            deleteLater();
+        } else {
+            sendError(502, "Bad Gateway");
+        }
+        return;
+    }
+
+    if (m_socketGone) {
+        deleteLater();
+        return;
+    }
+    sendPlaylist(playlist);
+}
+
+void ProxyConnection::sendPlaylist(const QByteArray &playlist)
+{
+    QByteArray body = rewritePlaylist(playlist);
+    sendHeaders("HTTP/1.1 200 OK", {
+        {"Content-Type", PlaylistContentType},
+        {"Content-Length", QByteArray::number(body.size())},
+    });
+    if (!m_headOnly) {
+        m_socket->write(body);
+    }
+    finish();
+}
+
+QByteArray ProxyConnection::rewritePlaylist(const QByteArray &playlist) const
+{
+    // 把分段、子播放列表和 URI="..." 属性中的地址改写为代理地址
+    quint16 port = m_server->port();
+    QByteArray token = m_server->token();
+    auto rewrite = [this, port, token](const QByteArray &reference) -> QByteArray {
+        QUrl resolved = m_remoteUrl.resolved(QUrl::fromEncoded(reference));
+        if (!isStreamUrl(resolved.toString())) {
+            return reference;
+        }
+        return StreamProxy::proxyUrl(port, token, resolved).toEncoded();
+    };
+
+    QList<QByteArray> lines = playlist.split('\n');
+    for (QByteArray &line : lines) {
+        QByteArray trimmed = line.trimmed();
+        if (trimmed.isEmpty()) {
+            continue;
+        }
+        if (!trimmed.startsWith('#')) {
+            line = rewrite(trimmed);
+            continue;
+        }
+        int uriPos = trimmed.indexOf("URI=\"");
+        if (uriPos >= 0) {
+            int start = uriPos + 5;
+            int end = trimmed.indexOf('"', start);
+            if (end > start) {
+                trimmed.replace(start, end - start, rewrite(trimmed.mid(start, end - start)));
+                line = trimmed;
+            }
+        }
+    }
+    return lines.join('\n');
+}
+
+void ProxyConnection::serveBytes()
+{
+    if (m_server->cache()->resourceSize(m_key) >= 0) {
+        startBody();
+        return;
+    }
+
+    // 总大小未知，先下载请求起点所在的块，从响应中获得总大小
+    qint64 firstIndex = (m_hasRange && m_suffixLength < 0) ? m_rangeStart / StreamCache::BlockSize : 0;
+    fetchBlock(firstIndex);
+}
+
+void ProxyConnection::startBody()
+{
+    qint64 size = m_server->cache()->resourceSize(m_key);
+    qint64 start = 0;
+    qint64 end = size - 1;
+    if (m_hasRange) {
+        if (m_suffixLength >= 0) {
+            start = qMax<qint64>(0, size - m_suffixLength);
+        } else {
+            start = m_rangeStart;
+            if (m_rangeEnd >= 0) {
+                end = qMin(m_rangeEnd, size - 1);
+            }
+        }
+        if (start >= size || start > end) {
+            sendHeaders("HTTP/1.1 416 Range Not Satisfiable", {
+                {"Content-Range", "bytes */" + QByteArray::number(size)},
+                {"Content-Length", "0"},
+            });
+            finish();
+            return;
+        }
+    }
+
+    QByteArray contentType = m_server->cache()->contentType(m_key);
+    if (contentType.isEmpty()) {
+        contentType = "application/octet-stream";
+    }
+    QList<QPair<QByteArray, QByteArray>> headers = {
+        {"Content-Type", contentType},
+        {"Content-Length", QByteArray::number(end - start + 1)},
+        {"Accept-Ranges", "bytes"},
+    };
+    if (m_hasRange) {
+        headers.append({"Content-Range", "bytes " + QByteArray::number(start) + "-"
+                                             + QByteArray::number(end) + "/" + QByteArray::number(size)});
+        sendHeaders("HTTP/1.1 206 Partial Content", headers);
+    } else {
+        sendHeaders("HTTP/1.1 200 OK", headers);
+    }
+
+    if (m_headOnly) {
+        finish();
+        return;
+    }
+
+    m_nextOffset = start;
+    m_endOffset = end + 1;
+    pump();
+}
+
+void ProxyConnection::pump()
+{
+    if (!m_headersSent || m_finished || m_socketGone || m_headOnly) {
+        return;
+    }
+
+    while (m_nextOffset < m_endOffset && m_socket->bytesToWrite() < MaxPendingBytes) {
+        qint64 index = m_nextOffset / StreamCache::BlockSize;
+        QByteArray data;
+        if (!blockData(index, &data)) {
+            // 缓存未命中，下载完成后回到这里继续
+            if (!m_reply) {
+                fetchBlock(index);
+            }
+            return;
+        }
+
+        qint64 offsetInBlock = m_nextOffset - index * StreamCache::BlockSize;
+        qint64 length = qMin<qint64>(data.size() - offsetInBlock, m_endOffset - m_nextOffset);
+        if (length <= 0) {
+            sendError(502, "Bad Gateway");
+            return;
+        }
+        m_socket->write(data.constData() + offsetInBlock, length);
+        m_nextOffset += length;
+    }
+
+    if (m_nextOffset >= m_endOffset) {
+        finish();
+    }
+}
+
+bool ProxyConnection::blockData(qint64 index, QByteArray *data)
+{
+    if (index == m_fetchedIndex) {
+        *data = m_fetchedData;
+        return true;
+    }
+    WholeDownload *download = m_server->wholeDownload(m_key);
+    if (download && download->lastBlock(index, data)) {
+        return true;
+    }
+    if (!m_server->cache()->readBlock(m_key, index, data)) {
+        return false;
+    }
+    // 不完整的块视为未命中，重新下载
+    if (data->size() != m_server->cache()->expectedBlockSize(m_key, index)) {
+        return false;
+    }
+    return true;
+}
+
+void ProxyConnection::fetchBlock(qint64 index)
+{
+    // 该资源的完整下载正在进行，等它写到这一块，不再另外请求
+    if (WholeDownload *download = m_server->wholeDownload(m_key)) {
+        download->addWaiter(this);
+        return;
+    }
+
+    QNetworkRequest request(m_remoteUrl);
+    qint64 first = index * StreamCache::BlockSize;
+    qint64 last = first + StreamCache::BlockSize - 1;
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(first) + "-" + QByteArray::number(last));
+
+    QNetworkReply *reply = m_server->network()->get(request);
+    m_reply = reply;
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { onBlockData(reply); });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, index]() { onBlockFetched(reply, index); });
+}
+
+void ProxyConnection::onBlockData(QNetworkReply *reply)
+{
+    // 206只有请求的一块，完成时一次读取；200是完整资源，交给共享下载
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 200) {
+        adoptWholeDownload(reply);
+    }
+}
+
+void ProxyConnection::adoptWholeDownload(QNetworkReply *reply)
+{
+    reply->disconnect(this);
+    m_reply = nullptr;
+
+    WholeDownload *download = m_server->wholeDownload(m_key);
+    if (download) {
+        // 并发的请求已经开始下载同一资源，放弃这一份
+        reply->abort();
+        reply->deleteLater();
+        download->addWaiter(this);
+        return;
+    }
+    download = new WholeDownload(m_server, m_key, reply);
+    download->addWaiter(this);
+    download->begin();
+}
+
+void ProxyConnection::onWholeProgress()
+{
+    // 总大小已知时不必等整个资源下载完，请求的块一到就开始发送
+    if (m_server->cache()->resourceSize(m_key) >= 0) {
+        continueServing();
+    }
+}
+
+void ProxyConnection::onWholeFinished(bool ok)
+{
+    if (m_socketGone || m_finished) {
+        return;
+    }
+    if (!ok || m_server->cache()->resourceSize(m_key) < 0) {
+        sendError(502, "Bad Gateway");
+        return;
+    }
+    continueServing();
+}
+
+void ProxyConnection::continueServing()
+{
+    if (m_socketGone || m_finished) {
+        return;
+    }
+    if (!m_headersSent) {
+        startBody();
+    } else {
+        pump();
+    }
+}
+
+void ProxyConnection::onBlockFetched(QNetworkReply *reply, qint64 index)
+{
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() == QNetworkReply::NoError && status == 200) {
+        // 响应体为空或没有收到readyRead
+        adoptWholeDownload(reply);
+        return;
+    }
+
+    reply->deleteLater();
+    m_reply = nullptr;
+    StreamCache *cache = m_server->cache();
+
+    if (reply->error() != QNetworkReply::NoError || status != 206) {
+        if (m_socketGone) {
+            deleteLater();
+        } else if (!m_headersSent) {
+            sendError(502, "Bad Gateway");
+        } else {
+            m_socket->abort();
+        }
+        return;
+    }
+
+    QByteArray contentType = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+    QByteArray data = reply->readAll();
+    // Content-Range: bytes a-b/total
+    QByteArray contentRange = reply->rawHeader("Content-Range");
+    qint64 total = contentRange.mid(contentRange.lastIndexOf('/') + 1).toLongLong();
+    if (total > 0) {
+        cache->setResourceInfo(m_key, total, contentType);
+    }
+    if (data.size() == cache->expectedBlockSize(m_key, index)) {
+        cache->writeBlock(m_key, index, data);
+    }
+    m_fetchedIndex = index;
+    m_fetchedData = data;
+
+    if (m_socketGone) {
+        deleteLater();
+        return;
+    }
+    if (cache->resourceSize(m_key) < 0) {
+        sendError(502, "Bad Gateway");
+        return;
+    }
+    if (!m_headersSent) {
+        startBody();
+    } else {
+        pump();
+    }
+}
+
+WholeDownload::WholeDownload(StreamProxyServer *server, const QString &key, QNetworkReply *reply)
+    : QObject(server)
+    , m_server(server)
+    , m_key(key)
+    , m_reply(reply)
+    , m_finished(false)
+    , m_nextBlock(0)
+    , m_lastIndex(-1)
+{
+    m_server->setWholeDownload(m_key, this);
+
+    bool lengthOk = false;
+    qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&lengthOk);
+    if (lengthOk && length > 0) {
+        m_server->cache()->setResourceInfo(m_key, length, reply->header(QNetworkRequest::ContentTypeHeader).toByteArray());
+    }
+    connect(reply, &QNetworkReply::readyRead, this, [this]() { onData(); });
+    connect(reply, &QNetworkReply::finished, this, [this]() { onFinished(); });
+}
+
+void WholeDownload::addWaiter(ProxyConnection *connection)
+{
+    m_waiters.removeAll(nullptr);
+    if (!m_waiters.contains(connection)) {
+        m_waiters.append(connection);
+    }
+}
+
+void WholeDownload::begin()
+{
+    if (m_reply->isFinished()) {
+        onFinished();
+    } else {
+        onData();
+    }
+}
+
+bool WholeDownload::lastBlock(qint64 index, QByteArray *data) const
+{
+    if (index != m_lastIndex) {
+        return false;
+    }
+    *data = m_lastData;
+    return true;
+}
+
+void WholeDownload::onData()
+{
+    m_buffer += m_reply->readAll();
+    bool stored = false;
+    while (m_buffer.size() >= StreamCache::BlockSize) {
+        storeBlock(m_buffer.left(StreamCache::BlockSize));
+        m_buffer.remove(0, StreamCache::BlockSize);
+        stored = true;
+    }
+    if (!stored) {
+        return;
+    }
+    // 等待的连接可能在发送时再次加入等待，遍历副本
+    const QList<QPointer<ProxyConnection>> waiters = m_waiters;
+    for (const QPointer<ProxyConnection> &waiter : waiters) {
+        if (waiter) {
+            waiter->onWholeProgress();
+        }
+    }
+}
+
+void WholeDownload::onFinished()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_reply->deleteLater();
+    m_server->removeWholeDownload(m_key, this);
+
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool ok = m_reply->error() == QNetworkReply::NoError && status == 200;
+    if (ok) {
+        // 写入最后不满一块的数据，以实际长度为准
+        m_buffer += m_reply->readAll();
+        while (m_buffer.size() >= StreamCache::BlockSize) {
+            storeBlock(m_buffer.left(StreamCache::BlockSize));
+            m_buffer.remove(0, StreamCache::BlockSize);
+        }
+        QByteArray contentType = m_reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+        m_server->cache()->setResourceInfo(m_key, m_nextBlock * StreamCache::BlockSize + m_buffer.size(), contentType);
+        if (!m_buffer.isEmpty()) {
+            storeBlock(m_buffer);
+            m_buffer.clear();
+        }
+    }
+
+    // 已不再登记，等待的连接缺少的块（缓存写入失败时）会重新请求
+    const QList<QPointer<ProxyConnection>> waiters = m_waiters;
+    m_waiters.clear();
+    for (const QPointer<ProxyConnection> &waiter : waiters) {
+        if (waiter) {
+            waiter->onWholeFinished(ok);
+        }
+    }
+    deleteLater();
+}
+
+void WholeDownload::storeBlock(const QByteArray &data)
+{
+    m_server->cache()->writeBlock(m_key, m_nextBlock, data);
+    m_lastIndex = m_nextBlock;
+    m_lastData = data;
+    ++m_nextBlock;
+}
+
+void ProxyConnection::sendHeaders(const QByteArray &statusLine, const QList<QPair<QByteArray, QByteArray>> &headers)
+{
+    QByteArray response = statusLine + "\r\n";
+    for (const QPair<QByteArray, QByteArray> &header : headers) {
+        response += header.first + ": " + header.second + "\r\n";
+    }
+    response += "Connection: close\r\n\r\n";
+    m_socket->write(response);
+    m_headersSent = true;
+}
+
+void ProxyConnection::sendError(int status, const QByteArray &reason)
+{
+    if (m_headersSent) {
+        m_socket->abort();
+        return;
+    }
+    sendHeaders("HTTP/1.1 " + QByteArray::number(status) + " " + reason, {{"Content-Length", "0"}});
+    finish();
+}
+
+void ProxyConnection::finish()
+{
+    // 待发送的数据写完后再断开，disconnected信号负责释放对象
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_socket->disconnectFromHost();
+}
+
+StreamProxy::StreamProxy(const QString &cacheDirectory, qint64 cacheMaxBytes, QObject *parent)
+    : QObject(parent)
+    , m_cacheDirectory(cacheDirectory)
+    , m_cacheMaxBytes(cacheMaxBytes)
+    , m_thread(nullptr)
+    , m_server(nullptr)
+    , m_port(0)
+{
+}
+
+StreamProxy::~StreamProxy()
+{
+    stop();
+}
+
+bool StreamProxy::start()
+{
+    if (isRunning()) {
+        return true;
+    }
+
+    m_thread = new QThread();
+    m_server = new StreamProxyServer();
+    m_server->moveToThread(m_thread);
+    m_thread->start();
+
+    // 每次启动生成新的128位令牌
+    quint32 random[4];
+    QRandomGenerator::system()->fillRange(random);
+    QByteArray token = QByteArray(reinterpret_cast<const char *>(random), sizeof(random)).toHex();
+
+    // 监听套接字、网络访问和缓存都要在代理线程中创建
+    StreamProxyServer *server = m_server;
+    QString cacheDirectory = m_cacheDirectory;
+    qint64 cacheMaxBytes = m_cacheMaxBytes;
+    quint16 port = 0;
+    QMetaObject::invokeMethod(m_server, [server, cacheDirectory, cacheMaxBytes, token]() {
+        return server->listen(cacheDirectory, cacheMaxBytes, token);
+    }, Qt::BlockingQueuedConnection, &port);
+
+    if (port == 0) {
+        stop();
+        return false;
+    }
+    m_port = port;
+    m_token = token;
+    return true;
+}
+
+void StreamProxy::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    // 线程结束时会处理deleteLater，服务端对象在自己的线程中析构
+    m_server->deleteLater();
+    m_server = nullptr;
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_port = 0;
+    m_token.clear();
+}
+
+QUrl StreamProxy::proxyUrl(const QUrl &remoteUrl) const
+{
+    return proxyUrl(m_port, m_token, remoteUrl);
+}
+
+QUrl StreamProxy::proxyUrl(quint16 port, const QByteArray &token, const QUrl &remoteUrl)
+{
+    // 路径保留原文件名，方便后端按扩展名识别格式
+    QString fileName = remoteUrl.fileName();
+    if (fileName.isEmpty()) {
+        fileName = "media";
+    }
+
+    QUrl url;
+    url.setScheme("http");
+    url.setHost("127.0.0.1");
+    url.setPort(port);
+    url.setPath("/stream/" + fileName);
+
+    QUrlQuery query;
+    query.addQueryItem("t", QString::fromLatin1(token));
+    query.addQueryItem("u", QString::fromLatin1(remoteUrl.toEncoded().toBase64(
+                                QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals)));
+    url.setQuery(query);
+    return url;
+}
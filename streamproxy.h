@@ -0,0 +1,44 @@
+#ifndef STREAMPROXY_H
+#define STREAMPROXY_H
+
+#include <QObject>
+#include <QUrl>
+
+class QThread;
+class StreamProxyServer;
+
+// 网络视频本地代理
+// 在独立线程中监听127.0.0.1，播放器通过代理地址访问远程视频（渐进式MP4和HLS）。
+// 代理把数据按块缓存到磁盘，跳转回已下载的区域或重复播放时直接从本地读取；
+// HLS播放列表中的分段地址会被改写为代理地址，分段同样走缓存。
+// 远程地址可以是任意HTTP服务器，包括本机上的测试服务器。
+// 代理地址带有每次启动随机生成的令牌，并检查Host头，其他进程或网页（DNS重绑定）
+// 无法借用代理访问任意地址。
+class StreamProxy : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StreamProxy(const QString &cacheDirectory, qint64 cacheMaxBytes, QObject *parent = nullptr);
+    ~StreamProxy() override;
+    
+    // 启动代理线程并开始监听，返回是否成功
+    bool start();
+    void stop();
+    bool isRunning() const { return m_port != 0; }
+    quint16 port() const { return m_port; }
+    
+    // 把远程地址转换为交给QMediaPlayer的代理地址
+    QUrl proxyUrl(const QUrl &remoteUrl) const;
+    static QUrl proxyUrl(quint16 port, const QByteArray &token, const QUrl &remoteUrl);
+
+private:
+    QString m_cacheDirectory;
+    qint64 m_cacheMaxBytes;
+    QThread *m_thread;
+    StreamProxyServer *m_server;
+    quint16 m_port;
+    QByteArray m_token;
+};
+
+#endif // STREAMPROXY_H
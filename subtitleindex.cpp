@@ -0,0 +1,366 @@
+#include "subtitleindex.h"
+#include "subtitletrack.h"
+#include <QThread>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace {
+
+constexpr quint32 IndexMagic = 0x53554958;   // "SUIX"
+constexpr quint32 IndexVersion = 1;
+// 缓存中每条字幕至少占用的字节数：起止时间各8字节，文本长度4字节
+constexpr qint64 MinCueBytes = 8 + 8 + 4;
+
+bool isCjk(char16_t c)
+{
+    return (c >= 0x3040 && c <= 0x30FF)      // 平假名、片假名
+        || (c >= 0x3400 && c <= 0x4DBF)      // 扩展A
+        || (c >= 0x4E00 && c <= 0x9FFF)      // 基本汉字
+        || (c >= 0xAC00 && c <= 0xD7AF)      // 韩文音节
+        || (c >= 0xF900 && c <= 0xFAFF);     // 兼容汉字
+}
+
+// 索引时每个中日韩字符都产生单字和与后一字的两字词；
+// 查询时只在孤立的单字上使用单字词，连续文字用两字词，候选更少
+QStringList splitTokens(const QString &text, bool forQuery)
+{
+    QStringList tokens;
+    const QString lower = text.toLower();
+    QString word;
+    auto flushWord = [&]() {
+        if (!word.isEmpty()) {
+            tokens << word;
+            word.clear();
+        }
+    };
+    
+    for (qsizetype i = 0; i < lower.size(); ++i) {
+        QChar c = lower.at(i);
+        if (isCjk(c.unicode())) {
+            flushWord();
+            bool previousCjk = i > 0 && isCjk(lower.at(i - 1).unicode());
+            bool nextCjk = i + 1 < lower.size() && isCjk(lower.at(i + 1).unicode());
+            if (!forQuery || (!previousCjk && !nextCjk)) {
+                tokens << QString(c);
+            }
+            if (nextCjk) {
+                tokens << lower.mid(i, 2);
+            }
+        } else if (c.isLetterOrNumber()) {
+            word += c;
+        } else {
+            flushWord();
+        }
+    }
+    flushWord();
+    return tokens;
+}
+
+QList<int> intersectSorted(const QList<int> &a, const QList<int> &b)
+{
+    QList<int> result;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+    return result;
+}
+
+}
+
+// 一个视频的字幕及其倒排索引（词 -> 升序的字幕序号）
+struct IndexedDocument
+{
+    QString subtitlePath;
+    qint64 modified = -1;
+    qint64 size = -1;
+    QList<SubtitleCue> cues;
+    QMap<QString, QList<int>> postings;
+};
+
+// 运行在工作线程中，只在工作线程中访问
+class SubtitleIndexWorker : public QObject
+{
+public:
+    SubtitleIndexWorker(const QString &cacheDirectory, SubtitleIndex *owner)
+        : m_cacheDirectory(cacheDirectory)
+        , m_owner(owner)
+        , m_generation(0)
+        , m_indexed(0)
+        , m_total(0)
+    {
+    }
+    
+    void setVideos(quint64 generation, const QStringList &videoPaths)
+    {
+        m_generation = generation;
+        m_videoPaths = videoPaths;
+        m_queue = videoPaths;
+        m_indexed = 0;
+        m_total = videoPaths.size();
+        
+        // 丢弃已不在播放列表中的视频
+        const QSet<QString> wanted(videoPaths.cbegin(), videoPaths.cend());
+        for (auto it = m_documents.begin(); it != m_documents.end();) {
+            it = wanted.contains(it.key()) ? std::next(it) : m_documents.erase(it);
+        }
+        scheduleNext();
+    }
+    
+    void search(const QString &query, int maxResults)
+    {
+        QList<SubtitleSearchHit> hits;
+        const QString needle = query.simplified();
+        const QStringList tokens = splitTokens(needle, true);
+        
+        if (!needle.isEmpty()) {
+            // 按播放列表顺序查找，结果顺序固定，截断时保留的也总是靠前的视频
+            for (const QString &videoPath : std::as_const(m_videoPaths)) {
+                if (hits.size() >= maxResults) {
+                    break;
+                }
+                auto it = m_documents.constFind(videoPath);
+                if (it == m_documents.cend()) {
+                    continue;
+                }
+                const IndexedDocument &document = it.value();
+                for (int cueIndex : candidates(document, tokens)) {
+                    const SubtitleCue &cue = document.cues.at(cueIndex);
+                    if (cue.text.simplified().contains(needle, Qt::CaseInsensitive)) {
+                        hits.append({it.key(), cue.startMs, cue.text});
+                        if (hits.size() >= maxResults) {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        
+        SubtitleIndex *owner = m_owner;
+        QMetaObject::invokeMethod(owner, [owner, query, hits]() {
+            emit owner->searchFinished(query, hits);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    void scheduleNext()
+    {
+        // 每个文件单独排队处理，期间到达的查询可以插队执行
+        quint64 generation = m_generation;
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            processNext(generation);
+        }, Qt::QueuedConnection);
+    }
+    
+    void processNext(quint64 generation)
+    {
+        if (generation != m_generation || m_queue.isEmpty()) {
+            return;
+        }
+        indexVideo(m_queue.takeFirst());
+        ++m_indexed;
+        
+        SubtitleIndex *owner = m_owner;
+        int indexed = m_indexed;
+        int total = m_total;
+        QMetaObject::invokeMethod(owner, [owner, indexed, total]() {
+            emit owner->indexingProgress(indexed, total);
+        }, Qt::QueuedConnection);
+        
+        if (!m_queue.isEmpty()) {
+            scheduleNext();
+        }
+    }
+    
+    void indexVideo(const QString &videoPath)
+    {
+        QString subtitlePath = SubtitleTrack::findSidecar(videoPath);
+        if (subtitlePath.isEmpty()) {
+            m_documents.remove(videoPath);
+            return;
+        }
+        
+        QFileInfo info(subtitlePath);
+        qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        qint64 size = info.size();
+        auto existing = m_documents.constFind(videoPath);
+        if (existing != m_documents.cend() && existing->subtitlePath == subtitlePath
+            && existing->modified == modified && existing->size == size) {
+            return;
+        }
+        
+        IndexedDocument document;
+        if (!loadCache(subtitlePath, modified, size, document)) {
+            SubtitleTrack track;
+            if (!track.load(subtitlePath)) {
+                m_documents.remove(videoPath);
+                return;
+            }
+            document.subtitlePath = subtitlePath;
+            document.modified = modified;
+            document.size = size;
+            document.cues.reserve(track.count());
+            for (int i = 0; i < track.count(); ++i) {
+                document.cues.append(track.cue(i));
+                for (const QString &token : splitTokens(track.cue(i).text, false)) {
+                    QList<int> &posting = document.postings[token];
+                    if (posting.isEmpty() || posting.last() != i) {
+                        posting.append(i);
+                    }
+                }
+            }
+            saveCache(document);
+        }
+        m_documents.insert(videoPath, document);
+    }
+    
+    QList<int> candidates(const IndexedDocument &document, const QStringList &tokens) const
+    {
+        // 只有标点等无法切分的查询，逐条检查
+        if (tokens.isEmpty()) {
+            QList<int> all(document.cues.size());
+            std::iota(all.begin(), all.end(), 0);
+            return all;
+        }
+        
+        QList<int> result;
+        bool first = true;
+        for (const QString &token : tokens) {
+            QList<int> matches;
+            if (isCjk(token.at(0).unicode())) {
+                matches = document.postings.value(token);
+            } else {
+                // 单词按前缀匹配，输入到一半也能找到
+                for (auto it = document.postings.lowerBound(token);
+                     it != document.postings.cend() && it.key().startsWith(token); ++it) {
+                    matches += it.value();
+                }
+                std::sort(matches.begin(), matches.end());
+                matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+            }
+            result = first ? matches : intersectSorted(result, matches);
+            first = false;
+            if (result.isEmpty()) {
+                break;
+            }
+        }
+        return result;
+    }
+    
+    QString cachePath(const QString &subtitlePath) const
+    {
+        QByteArray key = QCryptographicHash::hash(subtitlePath.toUtf8(), QCryptographicHash::Md5).toHex();
+        return QDir(m_cacheDirectory).filePath(QString::fromLatin1(key) + ".idx");
+    }
+    
+    bool loadCache(const QString &subtitlePath, qint64 modified, qint64 size, IndexedDocument &document) const
+    {
+        QFile file(cachePath(subtitlePath));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+        if (magic != IndexMagic || version != IndexVersion) {
+            return false;
+        }
+        stream >> document.subtitlePath >> document.modified >> document.size;
+        if (document.subtitlePath != subtitlePath || document.modified != modified || document.size != size) {
+            return false;
+        }
+        
+        // 条数来自文件，可能已损坏；超过剩余字节所能容纳的条数时视为损坏，不按它预留内存
+        qint32 cueCount = 0;
+        stream >> cueCount;
+        if (cueCount < 0 || cueCount > (file.size() - file.pos()) / MinCueBytes) {
+            return false;
+        }
+        document.cues.reserve(cueCount);
+        for (qint32 i = 0; i < cueCount; ++i) {
+            SubtitleCue cue;
+            stream >> cue.startMs >> cue.endMs >> cue.text;
+            if (stream.status() != QDataStream::Ok) {
+                return false;
+            }
+            document.cues.append(cue);
+        }
+        stream >> document.postings;
+        return stream.status() == QDataStream::Ok;
+    }
+    
+    void saveCache(const IndexedDocument &document) const
+    {
+        QDir().mkpath(m_cacheDirectory);
+        QSaveFile file(cachePath(document.subtitlePath));
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << IndexMagic << IndexVersion
+               << document.subtitlePath << document.modified << document.size
+               << qint32(document.cues.size());
+        for (const SubtitleCue &cue : document.cues) {
+            stream << cue.startMs << cue.endMs << cue.text;
+        }
+        stream << document.postings;
+        file.commit();
+    }
+    
+    QString m_cacheDirectory;
+    SubtitleIndex *m_owner;
+    quint64 m_generation;
+    QStringList m_queue;
+    int m_indexed;
+    int m_total;
+    QStringList m_videoPaths;                      // 播放列表顺序
+    QHash<QString, IndexedDocument> m_documents;   // 视频路径 -> 字幕索引
+};
+
+SubtitleIndex::SubtitleIndex(const QString &cacheDirectory, QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+    , m_generation(0)
+{
+    m_worker = new SubtitleIndexWorker(cacheDirectory, this);
+    m_workerThread = new QThread(this);
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start(QThread::LowPriority);
+}
+
+SubtitleIndex::~SubtitleIndex()
+{
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void SubtitleIndex::setVideos(const QStringList &videoPaths)
+{
+    SubtitleIndexWorker *worker = m_worker;
+    quint64 generation = ++m_generation;
+    QMetaObject::invokeMethod(m_worker, [worker, generation, videoPaths]() {
+        worker->setVideos(generation, videoPaths);
+    }, Qt::QueuedConnection);
+}
+
+void SubtitleIndex::search(const QString &query, int maxResults)
+{
+    SubtitleIndexWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, query, maxResults]() {
+        worker->search(query, maxResults);
+    }, Qt::QueuedConnection);
+}
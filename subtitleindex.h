@@ -0,0 +1,47 @@
+#ifndef SUBTITLEINDEX_H
+#define SUBTITLEINDEX_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+
+class QThread;
+class SubtitleIndexWorker;
+
+// 字幕搜索结果
+struct SubtitleSearchHit
+{
+    QString videoPath;
+    qint64 startMs;
+    QString text;
+};
+
+// 播放列表字幕的全文索引
+// 在后台线程逐个文件建立倒排索引（中日韩文字按单字和相邻两字、其他文字按小写单词切分），
+// 每个字幕文件的解析结果和索引保存在缓存目录中，字幕文件修改时间或大小变化时重建。
+// 查询先用倒排索引求候选字幕，再逐条确认包含查询文本。
+class SubtitleIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SubtitleIndex(const QString &cacheDirectory, QObject *parent = nullptr);
+    ~SubtitleIndex() override;
+    
+    // 设置需要索引的视频（增量：已索引且未修改的文件直接从缓存加载）
+    void setVideos(const QStringList &videoPaths);
+    
+    // 异步查询，结果通过searchFinished返回
+    void search(const QString &query, int maxResults = 500);
+
+signals:
+    void indexingProgress(int indexed, int total);
+    void searchFinished(const QString &query, const QList<SubtitleSearchHit> &hits);
+
+private:
+    QThread *m_workerThread;
+    SubtitleIndexWorker *m_worker;
+    quint64 m_generation;
+};
+
+#endif // SUBTITLEINDEX_H
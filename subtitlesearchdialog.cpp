@@ -0,0 +1,122 @@
+#include "subtitlesearchdialog.h"
+#include "timeformat.h"
+#include <QFileInfo>
+
+namespace {
+
+constexpr int StartTimeRole = Qt::UserRole + 1;
+
+}
+
+SubtitleSearchDialog::SubtitleSearchDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_queryEdit(nullptr)
+    , m_resultList(nullptr)
+    , m_statusLabel(nullptr)
+    , m_queryTimer(nullptr)
+{
+    setupUI();
+    setupConnections();
+    
+    setWindowTitle("搜索字幕");
+    resize(560, 420);
+    setModal(false); // 非模态对话框，搜索时可以继续操作播放器
+}
+
+void SubtitleSearchDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    
+    m_queryEdit = new QLineEdit();
+    m_queryEdit->setPlaceholderText("输入要查找的台词");
+    m_queryEdit->setClearButtonEnabled(true);
+    m_queryEdit->setStyleSheet("QLineEdit { padding: 6px; border: 1px solid #ccc; border-radius: 4px; color: black; background-color: white; }");
+    
+    m_resultList = new QListWidget();
+    m_resultList->setUniformItemSizes(true);
+    m_resultList->setStyleSheet("QListWidget { background-color: white; border: 1px solid #ccc; color: black; } QListWidget::item { padding: 4px; border-bottom: 1px solid #eee; } QListWidget::item:selected { background-color: #0078d4; color: white; }");
+    
+    m_statusLabel = new QLabel();
+    m_statusLabel->setStyleSheet("color: #666; font-size: 12px;");
+    
+    mainLayout->addWidget(m_queryEdit);
+    mainLayout->addWidget(m_resultList, 1);
+    mainLayout->addWidget(m_statusLabel);
+    mainLayout->setContentsMargins(12, 12, 12, 12);
+    
+    setStyleSheet("QDialog { background-color: white; }");
+    
+    // 输入停顿后再查询，避免每个按键都触发一次搜索
+    m_queryTimer = new QTimer(this);
+    m_queryTimer->setSingleShot(true);
+    m_queryTimer->setInterval(250);
+}
+
+void SubtitleSearchDialog::setupConnections()
+{
+    connect(m_queryEdit, &QLineEdit::textChanged, m_queryTimer, qOverload<>(&QTimer::start));
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, &SubtitleSearchDialog::onQueryTimer);
+    connect(m_queryTimer, &QTimer::timeout, this, &SubtitleSearchDialog::onQueryTimer);
+    connect(m_resultList, &QListWidget::itemActivated, this, &SubtitleSearchDialog::onResultActivated);
+}
+
+void SubtitleSearchDialog::onQueryTimer()
+{
+    m_queryTimer->stop();
+    if (query().isEmpty()) {
+        m_resultList->clear();
+        m_statusLabel->setText(m_progressText);
+        return;
+    }
+    emit searchRequested(query());
+}
+
+void SubtitleSearchDialog::setResults(const QString &query, const QList<SubtitleSearchHit> &hits)
+{
+    // 丢弃已过时的查询结果
+    if (query != this->query()) {
+        return;
+    }
+    
+    m_resultList->setUpdatesEnabled(false);
+    m_resultList->clear();
+    for (const SubtitleSearchHit &hit : hits) {
+        QChar buffer[TimeTextCapacity];
+        int length = formatTimeTo(hit.startMs, buffer);
+        QString text = QString("[%1] %2  %3")
+                           .arg(QString(buffer, length),
+                                QFileInfo(hit.videoPath).completeBaseName(),
+                                QString(hit.text).replace('\n', ' '));
+        QListWidgetItem *item = new QListWidgetItem(text);
+        item->setData(Qt::UserRole, hit.videoPath);
+        item->setData(StartTimeRole, hit.startMs);
+        item->setToolTip(hit.videoPath);
+        m_resultList->addItem(item);
+    }
+    m_resultList->setUpdatesEnabled(true);
+    
+    QString status = QString("找到 %1 条").arg(hits.size());
+    if (!m_progressText.isEmpty()) {
+        status += "，" + m_progressText;
+    }
+    m_statusLabel->setText(status);
+}
+
+void SubtitleSearchDialog::setIndexingProgress(int indexed, int total)
+{
+    m_progressText = indexed < total ? QString("正在建立索引 %1/%2").arg(indexed).arg(total) : QString();
+    
+    // 索引完成后重新查询，包含新加入的文件
+    if (indexed >= total && !query().isEmpty()) {
+        emit searchRequested(query());
+    } else if (query().isEmpty()) {
+        m_statusLabel->setText(m_progressText);
+    }
+}
+
+void SubtitleSearchDialog::onResultActivated(QListWidgetItem *item)
+{
+    if (item) {
+        emit hitActivated(item->data(Qt::UserRole).toString(), item->data(StartTimeRole).toLongLong());
+    }
+}
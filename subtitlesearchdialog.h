@@ -0,0 +1,45 @@
+#ifndef SUBTITLESEARCHDIALOG_H
+#define SUBTITLESEARCHDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QTimer>
+#include "subtitleindex.h"
+
+// 字幕搜索面板（非模态），双击结果跳转到对应视频和字幕位置
+class SubtitleSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SubtitleSearchDialog(QWidget *parent = nullptr);
+    
+    QString query() const { return m_queryEdit->text().trimmed(); }
+
+public slots:
+    void setResults(const QString &query, const QList<SubtitleSearchHit> &hits);
+    void setIndexingProgress(int indexed, int total);
+
+signals:
+    void searchRequested(const QString &query);
+    void hitActivated(const QString &videoPath, qint64 startMs);
+
+private slots:
+    void onQueryTimer();
+    void onResultActivated(QListWidgetItem *item);
+
+private:
+    void setupUI();
+    void setupConnections();
+    
+    QLineEdit *m_queryEdit;
+    QListWidget *m_resultList;
+    QLabel *m_statusLabel;
+    QTimer *m_queryTimer;
+    QString m_progressText;
+};
+
+#endif // SUBTITLESEARCHDIALOG_H
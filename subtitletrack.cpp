@@ -0,0 +1,310 @@
+#include "subtitletrack.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringDecoder>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+
+// 解析 [h:]mm:ss[,.]fff 形式的时间，小数部分按位数换算（ASS为百分之一秒）
+qint64 parseTimestamp(QStringView text, bool *ok)
+{
+    text = text.trimmed();
+    qint64 fraction = 0;
+    int separator = -1;
+    for (int i = text.size() - 1; i >= 0; --i) {
+        if (text.at(i) == ',' || text.at(i) == '.') {
+            separator = i;
+            break;
+        }
+        if (text.at(i) == ':') {
+            break;
+        }
+    }
+    if (separator >= 0) {
+        QStringView digits = text.mid(separator + 1).left(3);
+        bool fractionOk = false;
+        fraction = digits.toLongLong(&fractionOk);
+        if (!fractionOk) {
+            *ok = false;
+            return 0;
+        }
+        for (qsizetype i = digits.size(); i < 3; ++i) {
+            fraction *= 10;
+        }
+        text = text.left(separator);
+    }
+    
+    qint64 total = 0;
+    const auto parts = text.split(u':');
+    if (parts.size() < 2 || parts.size() > 3) {
+        *ok = false;
+        return 0;
+    }
+    for (QStringView part : parts) {
+        bool partOk = false;
+        qint64 value = part.toLongLong(&partOk);
+        if (!partOk) {
+            *ok = false;
+            return 0;
+        }
+        total = total * 60 + value;
+    }
+    *ok = true;
+    return total * 1000 + fraction;
+}
+
+// 去除HTML样式标签（<i>、<font ...>等）和SRT中常见的ASS覆盖标签
+QString stripTags(const QString &text)
+{
+    static const QRegularExpression tagPattern("<[^>]*>|\\{\\\\[^}]*\\}");
+    QString result = text;
+    result.remove(tagPattern);
+    result.replace("&amp;", "&").replace("&lt;", "<").replace("&gt;", ">").replace("&nbsp;", " ");
+    return result;
+}
+
+// 字幕文件多为UTF-8，不是合法UTF-8时按系统本地编码（如GBK）解码
+QString decodeSubtitle(const QByteArray &data)
+{
+    QStringDecoder utf8(QStringDecoder::Utf8, QStringDecoder::Flag::Stateless);
+    QString text = utf8.decode(data);
+    if (!utf8.hasError()) {
+        return text;
+    }
+    QStringDecoder system(QStringDecoder::System);
+    return system.decode(data);
+}
+
+}
+
+bool SubtitleTrack::load(const QString &filePath)
+{
+    clear();
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    QString content = decodeSubtitle(file.readAll());
+    if (content.startsWith(QChar(0xFEFF))) {
+        content.remove(0, 1);
+    }
+    content.replace("\r\n", "\n").replace('\r', '\n');
+    const QStringList lines = content.split('\n');
+    
+    QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "ass" || suffix == "ssa") {
+        parseAss(lines);
+    } else {
+        parseSrtOrVtt(lines);
+    }
+    
+    if (m_cues.isEmpty()) {
+        m_errorString = "文件中没有可识别的字幕";
+        return false;
+    }
+    
+    // 按开始时间排序（稳定排序保留同一时刻字幕的原始顺序），再建立最大结束时间的线段树
+    std::stable_sort(m_cues.begin(), m_cues.end(), [](const SubtitleCue &a, const SubtitleCue &b) {
+        return a.startMs < b.startMs;
+    });
+    buildMaxEndTree();
+    
+    m_filePath = filePath;
+    return true;
+}
+
+void SubtitleTrack::clear()
+{
+    m_filePath.clear();
+    m_errorString.clear();
+    m_cues.clear();
+    m_maxEndTree.clear();
+}
+
+void SubtitleTrack::buildMaxEndTree()
+{
+    // 叶子数取2的幂，第i条字幕在节点 leaves + i，空叶子的结束时间为-1
+    int leaves = 1;
+    while (leaves < m_cues.size()) {
+        leaves *= 2;
+    }
+    m_maxEndTree.fill(-1, 2 * leaves);
+    for (int i = 0; i < m_cues.size(); ++i) {
+        m_maxEndTree[leaves + i] = m_cues.at(i).endMs;
+    }
+    for (int node = leaves - 1; node >= 1; --node) {
+        m_maxEndTree[node] = qMax(m_maxEndTree.at(2 * node), m_maxEndTree.at(2 * node + 1));
+    }
+}
+
+void SubtitleTrack::collectActive(int node, int begin, int end, int last, qint64 positionMs, QList<int> &result) const
+{
+    // 节点覆盖字幕 [begin, end)；区间内都已结束或都未开始时整棵子树跳过
+    if (begin > last || m_maxEndTree.at(node) <= positionMs) {
+        return;
+    }
+    if (end - begin == 1) {
+        result.append(begin);
+        return;
+    }
+    int middle = (begin + end) / 2;
+    collectActive(2 * node, begin, middle, last, positionMs, result);
+    collectActive(2 * node + 1, middle, end, last, positionMs, result);
+}
+
+QList<int> SubtitleTrack::activeCues(qint64 positionMs) const
+{
+    QList<int> result;
+    
+    // 开始时间不晚于positionMs的字幕是[0, last]
+    auto upper = std::upper_bound(m_cues.cbegin(), m_cues.cend(), positionMs,
+                                  [](qint64 position, const SubtitleCue &cue) {
+        return position < cue.startMs;
+    });
+    int last = int(upper - m_cues.cbegin()) - 1;
+    
+    // 先左后右遍历，结果按序号升序
+    if (last >= 0) {
+        collectActive(1, 0, m_maxEndTree.size() / 2, last, positionMs, result);
+    }
+    return result;
+}
+
+QString SubtitleTrack::findSidecar(const QString &videoPath)
+{
+    QFileInfo videoInfo(videoPath);
+    QDir dir = videoInfo.absoluteDir();
+    QString baseName = videoInfo.completeBaseName();
+    
+    // 优先完全同名，其次“同名.语言.后缀”
+    for (const QString &suffix : supportedSuffixes()) {
+        QString candidate = dir.filePath(baseName + "." + suffix);
+        if (QFileInfo::exists(candidate)) {
+            return candidate;
+        }
+    }
+    QStringList filters;
+    for (const QString &suffix : supportedSuffixes()) {
+        filters << QString("%1.*.%2").arg(baseName, suffix);
+    }
+    const QStringList matches = dir.entryList(filters, QDir::Files, QDir::Name);
+    return matches.isEmpty() ? QString() : dir.filePath(matches.first());
+}
+
+QStringList SubtitleTrack::supportedSuffixes()
+{
+    return {"srt", "vtt", "ass", "ssa"};
+}
+
+void SubtitleTrack::parseSrtOrVtt(const QStringList &lines)
+{
+    // SRT和WebVTT都由“时间行 + 文本行”组成、以空行分隔；
+    // 序号行、WEBVTT头和NOTE/STYLE块不含“-->”，会被跳过
+    int i = 0;
+    while (i < lines.size()) {
+        const QString &line = lines.at(i++);
+        int arrow = line.indexOf("-->");
+        if (arrow < 0) {
+            continue;
+        }
+        
+        // WebVTT的时间后面可能带有位置设置
+        QStringView endText = QStringView(line).mid(arrow + 3).trimmed();
+        int space = endText.indexOf(u' ');
+        if (space >= 0) {
+            endText = endText.left(space);
+        }
+        bool startOk = false;
+        bool endOk = false;
+        SubtitleCue cue;
+        cue.startMs = parseTimestamp(QStringView(line).left(arrow), &startOk);
+        cue.endMs = parseTimestamp(endText, &endOk);
+        if (!startOk || !endOk) {
+            continue;
+        }
+        
+        QStringList textLines;
+        while (i < lines.size() && !lines.at(i).trimmed().isEmpty()) {
+            textLines << stripTags(lines.at(i++)).trimmed();
+        }
+        cue.text = textLines.join('\n').trimmed();
+        if (!cue.text.isEmpty() && cue.endMs > cue.startMs) {
+            m_cues.append(cue);
+        }
+    }
+}
+
+void SubtitleTrack::parseAss(const QStringList &lines)
+{
+    static const QRegularExpression overridePattern("\\{[^}]*\\}");
+    
+    // 默认字段顺序，[Events]中的Format行可以覆盖
+    QStringList format = {"layer", "start", "end", "style", "name", "marginl", "marginr", "marginv", "effect", "text"};
+    bool inEvents = false;
+    
+    for (const QString &rawLine : lines) {
+        QString line = rawLine.trimmed();
+        if (line.startsWith('[')) {
+            inEvents = line.compare("[Events]", Qt::CaseInsensitive) == 0;
+            continue;
+        }
+        if (!inEvents) {
+            continue;
+        }
+        
+        if (line.startsWith("Format:", Qt::CaseInsensitive)) {
+            format.clear();
+            for (const QString &field : line.mid(7).split(',')) {
+                format << field.trimmed().toLower();
+            }
+            continue;
+        }
+        if (!line.startsWith("Dialogue:", Qt::CaseInsensitive)) {
+            continue;
+        }
+        
+        // 最后一个字段（文本）中可以包含逗号
+        int startIndex = format.indexOf("start");
+        int endIndex = format.indexOf("end");
+        int textIndex = format.indexOf("text");
+        if (startIndex < 0 || endIndex < 0 || textIndex != format.size() - 1) {
+            continue;
+        }
+        QString body = line.mid(9);
+        QStringList fields;
+        int position = 0;
+        for (int field = 0; field < format.size() - 1; ++field) {
+            int comma = body.indexOf(',', position);
+            if (comma < 0) {
+                break;
+            }
+            fields << body.mid(position, comma - position);
+            position = comma + 1;
+        }
+        if (fields.size() != format.size() - 1) {
+            continue;
+        }
+        
+        bool startOk = false;
+        bool endOk = false;
+        SubtitleCue cue;
+        cue.startMs = parseTimestamp(fields.at(startIndex), &startOk);
+        cue.endMs = parseTimestamp(fields.at(endIndex), &endOk);
+        if (!startOk || !endOk) {
+            continue;
+        }
+        
+        QString text = body.mid(position);
+        text.remove(overridePattern);
+        text.replace("\\N", "\n").replace("\\n", "\n").replace("\\h", " ");
+        cue.text = text.trimmed();
+        if (!cue.text.isEmpty() && cue.endMs > cue.startMs) {
+            m_cues.append(cue);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SUBTITLETRACK_H
+#define SUBTITLETRACK_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+// 一条字幕
+struct SubtitleCue
+{
+    qint64 startMs;
+    qint64 endMs;
+    QString text;   // 已去除样式标签，多行用换行符分隔
+};
+
+// 外挂字幕（SRT/WebVTT/ASS/SSA）
+// 加载时一次性解析并按开始时间排序，再在排序后的字幕上建立线段树，每个节点记录区间内的最大结束时间。
+// 查询某一时刻的字幕先二分查找已开始的范围，再只进入最大结束时间晚于该时刻的节点，
+// 耗时为 O(log n + k log n)（k为结果数），不受个别超长字幕影响。
+class SubtitleTrack
+{
+public:
+    bool load(const QString &filePath);
+    void clear();
+    
+    QString filePath() const { return m_filePath; }
+    QString errorString() const { return m_errorString; }
+    bool isEmpty() const { return m_cues.isEmpty(); }
+    int count() const { return m_cues.size(); }
+    const SubtitleCue &cue(int index) const { return m_cues.at(index); }
+    
+    // 在positionMs时刻显示的字幕序号（升序）
+    QList<int> activeCues(qint64 positionMs) const;
+    
+    // 查找视频旁的字幕文件：同名或“同名.语言”的.srt/.vtt/.ass/.ssa
+    static QString findSidecar(const QString &videoPath);
+    static QStringList supportedSuffixes();
+
+private:
+    void parseSrtOrVtt(const QStringList &lines);
+    void parseAss(const QStringList &lines);
+    void buildMaxEndTree();
+    void collectActive(int node, int begin, int end, int last, qint64 positionMs, QList<int> &result) const;
+    
+    QString m_filePath;
+    QString m_errorString;
+    QList<SubtitleCue> m_cues;
+    QList<qint64> m_maxEndTree;   // 线段树，节点1为根，节点n的子节点为2n和2n+1
+};
+
+#endif // SUBTITLETRACK_H
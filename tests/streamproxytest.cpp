@@ -0,0 +1,399 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include <QTimer>
+#include <memory>
+#include "streamproxy.h"
+#include "streamcache.h"
+
+namespace {
+
+// 跨越多个缓存块，最后一块不满
+QByteArray makeResource(qint64 size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (qint64 i = 0; i < size; ++i) {
+        data[i] = char((i * 131 + i / 997) & 0xFF);
+    }
+    return data;
+}
+
+// 代替远程服务器的HTTP源站，每个连接处理一个请求
+class OriginServer : public QObject
+{
+public:
+    explicit OriginServer(QObject *parent = nullptr)
+        : QObject(parent)
+        , m_supportsRanges(true)
+        , m_throttleBytes(0)
+        , m_throttleIntervalMs(0)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool start() { return m_server.listen(QHostAddress::LocalHost, 0); }
+    void stop() { m_server.close(); }
+
+    QUrl url(const QString &path) const
+    {
+        return QUrl(QString("http://127.0.0.1:%1%2").arg(m_server.serverPort()).arg(path));
+    }
+
+    void setResource(const QString &path, const QByteArray &data, const QByteArray &contentType)
+    {
+        m_resources.insert(path, {data, contentType});
+    }
+    // 关闭后忽略Range，总是返回完整资源
+    void setSupportsRanges(bool supported) { m_supportsRanges = supported; }
+    // 每隔intervalMs只发送bytes字节，模拟慢速源站
+    void setThrottle(int bytes, int intervalMs)
+    {
+        m_throttleBytes = bytes;
+        m_throttleIntervalMs = intervalMs;
+    }
+
+    int requestCount() const { return m_ranges.size(); }
+    QList<QByteArray> ranges() const { return m_ranges; }
+
+private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+        socket->setProperty("request", request);
+        int headerEnd = request.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+
+        QList<QByteArray> lines = request.left(headerEnd).split('\n');
+        QByteArray path = lines.value(0).split(' ').value(1);
+        QByteArray range;
+        for (const QByteArray &line : std::as_const(lines)) {
+            if (line.toLower().startsWith("range:")) {
+                range = line.mid(6).trimmed();
+            }
+        }
+        m_ranges.append(range);
+
+        auto it = m_resources.constFind(QString::fromLatin1(path));
+        if (it == m_resources.constEnd()) {
+            socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            socket->disconnectFromHost();
+            return;
+        }
+
+        const QByteArray &data = it->first;
+        QByteArray response;
+        if (m_supportsRanges && range.startsWith("bytes=")) {
+            QList<QByteArray> bounds = range.mid(6).split('-');
+            qint64 first = bounds.value(0).toLongLong();
+            qint64 last = qMin<qint64>(bounds.value(1).toLongLong(), data.size() - 1);
+            response = "HTTP/1.1 206 Partial Content\r\n";
+            response += "Content-Range: bytes " + QByteArray::number(first) + "-" + QByteArray::number(last)
+                        + "/" + QByteArray::number(data.size()) + "\r\n";
+            response += "Content-Length: " + QByteArray::number(last - first + 1) + "\r\n";
+            response += "Content-Type: " + it->second + "\r\nConnection: close\r\n\r\n";
+            response += data.mid(first, last - first + 1);
+        } else {
+            response = "HTTP/1.1 200 OK\r\n";
+            response += "Content-Length: " + QByteArray::number(data.size()) + "\r\n";
+            response += "Content-Type: " + it->second + "\r\nConnection: close\r\n\r\n";
+            response += data;
+        }
+        if (m_throttleBytes <= 0) {
+            socket->write(response);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        // 计时器属于套接字，客户端断开后随之释放
+        QTimer *timer = new QTimer(socket);
+        auto offset = std::make_shared<qint64>(0);
+        int chunk = m_throttleBytes;
+        connect(timer, &QTimer::timeout, socket, [socket, timer, response, offset, chunk]() {
+            socket->write(response.mid(*offset, chunk));
+            *offset += chunk;
+            if (*offset >= response.size()) {
+                timer->stop();
+                socket->disconnectFromHost();
+            }
+        });
+        timer->start(m_throttleIntervalMs);
+    }
+
+    QTcpServer m_server;
+    QHash<QString, QPair<QByteArray, QByteArray>> m_resources;   // 路径 -> 数据、类型
+    bool m_supportsRanges;
+    int m_throttleBytes;
+    int m_throttleIntervalMs;
+    QList<QByteArray> m_ranges;   // 每个请求的Range头（没有时为空）
+};
+
+struct Response
+{
+    int status = 0;
+    QByteArray contentRange;
+    QByteArray body;
+};
+
+QNetworkReply *startGet(QNetworkAccessManager &network, const QUrl &url, const QByteArray &range = QByteArray())
+{
+    QNetworkRequest request(url);
+    if (!range.isEmpty()) {
+        request.setRawHeader("Range", range);
+    }
+    return network.get(request);
+}
+
+Response waitForReply(QNetworkReply *reply)
+{
+    QSignalSpy finished(reply, &QNetworkReply::finished);
+    if (!reply->isFinished()) {
+        finished.wait(10000);
+    }
+    Response response;
+    response.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    response.contentRange = reply->rawHeader("Content-Range");
+    response.body = reply->readAll();
+    reply->deleteLater();
+    return response;
+}
+
+Response get(QNetworkAccessManager &network, const QUrl &url, const QByteArray &range = QByteArray())
+{
+    return waitForReply(startGet(network, url, range));
+}
+
+// 直接发送原始请求，可以指定任意Host头
+QByteArray rawStatusLine(quint16 port, const QByteArray &target, const QByteArray &host)
+{
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, port);
+    if (!socket.waitForConnected(5000)) {
+        return QByteArray();
+    }
+    socket.write("GET " + target + " HTTP/1.1\r\nHost: " + host + "\r\n\r\n");
+    QByteArray response;
+    while (!response.contains("\r\n") && socket.waitForReadyRead(5000)) {
+        response += socket.readAll();
+    }
+    return response.left(response.indexOf("\r\n"));
+}
+
+}
+
+class StreamProxyTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void rangeRequestUsesPartialContent();
+    void fullResponseFallback();
+    void seeksShareWholeDownload();
+    void servesCachedBlocksWhenOriginIsGone();
+    void rewritesHlsPlaylist();
+    void rejectsRequestsWithoutToken();
+
+private:
+    QTemporaryDir *m_cacheDir = nullptr;
+    OriginServer *m_origin = nullptr;
+    StreamProxy *m_proxy = nullptr;
+    QNetworkAccessManager *m_network = nullptr;
+    QByteArray m_resource;
+};
+
+void StreamProxyTest::init()
+{
+    m_cacheDir = new QTemporaryDir;
+    QVERIFY(m_cacheDir->isValid());
+    m_origin = new OriginServer;
+    QVERIFY(m_origin->start());
+    m_resource = makeResource(2 * StreamCache::BlockSize + 12345);
+    m_origin->setResource("/video.mp4", m_resource, "video/mp4");
+    m_proxy = new StreamProxy(m_cacheDir->path(), 64 * 1024 * 1024);
+    QVERIFY(m_proxy->start());
+    m_network = new QNetworkAccessManager;
+}
+
+void StreamProxyTest::cleanup()
+{
+    delete m_network;
+    delete m_proxy;
+    delete m_origin;
+    delete m_cacheDir;
+    m_network = nullptr;
+    m_proxy = nullptr;
+    m_origin = nullptr;
+    m_cacheDir = nullptr;
+}
+
+void StreamProxyTest::rangeRequestUsesPartialContent()
+{
+    QUrl url = m_proxy->proxyUrl(m_origin->url("/video.mp4"));
+    const qint64 first = StreamCache::BlockSize - 100;
+    const qint64 last = StreamCache::BlockSize + 100;
+    Response response = get(*m_network, url, "bytes=" + QByteArray::number(first) + "-" + QByteArray::number(last));
+
+    QCOMPARE(response.status, 206);
+    QCOMPARE(response.contentRange, "bytes " + QByteArray::number(first) + "-" + QByteArray::number(last)
+                                        + "/" + QByteArray::number(m_resource.size()));
+    QCOMPARE(response.body, m_resource.mid(first, last - first + 1));
+    // 源站只收到按块对齐的范围请求
+    for (const QByteArray &range : m_origin->ranges()) {
+        QVERIFY(range.startsWith("bytes="));
+        QCOMPARE(range.mid(6).split('-').value(0).toLongLong() % StreamCache::BlockSize, 0);
+    }
+}
+
+void StreamProxyTest::fullResponseFallback()
+{
+    m_origin->setSupportsRanges(false);
+    QUrl url = m_proxy->proxyUrl(m_origin->url("/video.mp4"));
+
+    // 源站返回200完整资源，代理仍按请求的范围回复
+    const qint64 first = 2 * StreamCache::BlockSize + 10;
+    Response range = get(*m_network, url, "bytes=" + QByteArray::number(first) + "-");
+    QCOMPARE(range.status, 206);
+    QCOMPARE(range.body, m_resource.mid(first));
+
+    // 整个资源已按块写入缓存，不再访问源站
+    int requests = m_origin->requestCount();
+    Response whole = get(*m_network, url);
+    QCOMPARE(whole.status, 200);
+    QCOMPARE(whole.body.size(), m_resource.size());
+    QVERIFY(whole.body == m_resource);
+    QCOMPARE(m_origin->requestCount(), requests);
+}
+
+void StreamProxyTest::seeksShareWholeDownload()
+{
+    m_origin->setSupportsRanges(false);
+    m_origin->setThrottle(256 * 1024, 50);
+    QUrl url = m_proxy->proxyUrl(m_origin->url("/video.mp4"));
+
+    // 第一块到达后完整资源仍在下载，此时跳转两次
+    QNetworkReply *first = startGet(*m_network, url, "bytes=0-");
+    QSignalSpy firstData(first, &QNetworkReply::readyRead);
+    QVERIFY(firstData.wait(10000));
+    QVERIFY(!first->isFinished());
+
+    const qint64 secondStart = StreamCache::BlockSize + 5;
+    const qint64 thirdStart = 2 * StreamCache::BlockSize + 10;
+    QNetworkReply *second = startGet(*m_network, url, "bytes=" + QByteArray::number(secondStart) + "-");
+    QNetworkReply *third = startGet(*m_network, url, "bytes=" + QByteArray::number(thirdStart) + "-");
+
+    Response thirdResponse = waitForReply(third);
+    Response secondResponse = waitForReply(second);
+    Response firstResponse = waitForReply(first);
+    QCOMPARE(thirdResponse.status, 206);
+    QVERIFY(thirdResponse.body == m_resource.mid(thirdStart));
+    QCOMPARE(secondResponse.status, 206);
+    QVERIFY(secondResponse.body == m_resource.mid(secondStart));
+    QCOMPARE(firstResponse.status, 206);
+    QVERIFY(firstResponse.body == m_resource);
+
+    // 跳转后的连接等待同一个下载，源站只收到一个请求
+    QCOMPARE(m_origin->requestCount(), 1);
+}
+
+void StreamProxyTest::servesCachedBlocksWhenOriginIsGone()
+{
+    QUrl url = m_proxy->proxyUrl(m_origin->url("/video.mp4"));
+    Response first = get(*m_network, url);
+    QCOMPARE(first.status, 200);
+    QVERIFY(first.body == m_resource);
+
+    m_origin->stop();
+    const qint64 start = StreamCache::BlockSize / 2;
+    Response cached = get(*m_network, url, "bytes=" + QByteArray::number(start) + "-" + QByteArray::number(start + 999));
+    QCOMPARE(cached.status, 206);
+    QCOMPARE(cached.body, m_resource.mid(start, 1000));
+
+    // 没有缓存过的资源在源站不可用时返回错误
+    Response missing = get(*m_network, m_proxy->proxyUrl(m_origin->url("/other.mp4")));
+    QCOMPARE(missing.status, 502);
+}
+
+void StreamProxyTest::rewritesHlsPlaylist()
+{
+    QByteArray segment = makeResource(50000);
+    m_origin->setResource("/hls/seg0.ts", segment, "video/mp2t");
+    QByteArray playlist = "#EXTM3U\n"
+                          "#EXT-X-TARGETDURATION:4\n"
+                          "#EXT-X-KEY:METHOD=AES-128,URI=\"key.bin\"\n"
+                          "#EXTINF:4.0,\n"
+                          "seg0.ts\n"
+                          "#EXTINF:4.0,\n"
+                          + m_origin->url("/other/seg1.ts").toEncoded() + "\n"
+                          "#EXT-X-ENDLIST\n";
+    m_origin->setResource("/hls/index.m3u8", playlist, "application/vnd.apple.mpegurl");
+
+    Response response = get(*m_network, m_proxy->proxyUrl(m_origin->url("/hls/index.m3u8")));
+    QCOMPARE(response.status, 200);
+
+    // 相对地址、绝对地址和URI属性都改写为带令牌的代理地址，并指向源站上解析后的位置
+    QList<QUrl> rewritten;
+    for (QByteArray line : response.body.split('\n')) {
+        int uri = line.indexOf("URI=\"");
+        if (uri >= 0) {
+            line = line.mid(uri + 5, line.indexOf('"', uri + 5) - uri - 5);
+        } else if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        rewritten.append(QUrl::fromEncoded(line));
+    }
+    QCOMPARE(rewritten.size(), 3);
+    const QList<QUrl> expected = {m_origin->url("/hls/key.bin"), m_origin->url("/hls/seg0.ts"),
+                                  m_origin->url("/other/seg1.ts")};
+    for (int i = 0; i < rewritten.size(); ++i) {
+        QCOMPARE(rewritten.at(i).host(), QString("127.0.0.1"));
+        QCOMPARE(rewritten.at(i).port(), int(m_proxy->port()));
+        QCOMPARE(rewritten.at(i), m_proxy->proxyUrl(expected.at(i)));
+    }
+
+    // 改写后的分段地址可以直接通过代理播放
+    Response segmentResponse = get(*m_network, rewritten.at(1));
+    QCOMPARE(segmentResponse.status, 200);
+    QVERIFY(segmentResponse.body == segment);
+}
+
+void StreamProxyTest::rejectsRequestsWithoutToken()
+{
+    QUrl url = m_proxy->proxyUrl(m_origin->url("/video.mp4"));
+    const QByteArray host = "127.0.0.1:" + QByteArray::number(m_proxy->port());
+    const QByteArray target = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+
+    QUrlQuery query(url);
+    query.removeQueryItem("t");
+    QUrl withoutToken = url;
+    withoutToken.setQuery(query);
+    const QByteArray targetWithoutToken = withoutToken.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+
+    // 被拒绝的请求不会访问源站
+    QVERIFY(rawStatusLine(m_proxy->port(), targetWithoutToken, host).contains(" 403 "));
+    // DNS重绑定时Host是网页的域名
+    QVERIFY(rawStatusLine(m_proxy->port(), target, "attacker.example:" + QByteArray::number(m_proxy->port()))
+                .contains(" 403 "));
+    QCOMPARE(m_origin->requestCount(), 0);
+
+    // 带令牌、Host正确的请求正常转发
+    QCOMPARE(get(*m_network, url).status, 200);
+    QVERIFY(m_origin->requestCount() > 0);
+}
+
+QTEST_GUILESS_MAIN(StreamProxyTest)
+
+#include "streamproxytest.moc"
@@ -0,0 +1,22 @@
+# 本地网络视频代理的测试，用本机上的QTcpServer代替远程服务器
+# 运行: ./tests
+
+QT       += core network testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tests
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    streamproxytest.cpp \
+    ../streamproxy.cpp \
+    ../streamcache.cpp \
+    ../mediapath.cpp
+
+HEADERS += \
+    ../streamproxy.h \
+    ../streamcache.h \
+    ../mediapath.h
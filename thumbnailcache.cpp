@@ -0,0 +1,116 @@
+#include "thumbnailcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+ThumbnailCache::ThumbnailCache(const QString &directory, qint64 maxBytes)
+    : m_directory(directory)
+    , m_maxBytes(maxBytes)
+    , m_totalBytes(0)
+    , m_lastStamp(0)
+    , m_loaded(false)
+{
+}
+
+void ThumbnailCache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+    QDir().mkpath(m_directory);
+    const QFileInfoList files = QDir(m_directory).entryInfoList({"*.jpg"}, QDir::Files);
+    for (const QFileInfo &fileInfo : files) {
+        Entry entry;
+        entry.size = fileInfo.size();
+        entry.stamp = fileInfo.lastModified().toMSecsSinceEpoch();
+        while (m_lru.contains(entry.stamp)) {
+            ++entry.stamp;
+        }
+        QString key = fileInfo.completeBaseName();
+        m_entries.insert(key, entry);
+        m_lru.insert(entry.stamp, key);
+        m_totalBytes += entry.size;
+        m_lastStamp = qMax(m_lastStamp, entry.stamp);
+    }
+    evictIfNeeded(QString());
+}
+
+void ThumbnailCache::setMaxBytes(qint64 maxBytes)
+{
+    m_maxBytes = maxBytes;
+    evictIfNeeded(QString());
+}
+
+QString ThumbnailCache::filePath(const QString &key) const
+{
+    return m_directory + "/" + key + ".jpg";
+}
+
+qint64 ThumbnailCache::touch(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return 0;
+    }
+    m_lru.remove(it->stamp);
+    it->stamp = nextStamp();
+    m_lru.insert(it->stamp, key);
+    return it->stamp;
+}
+
+void ThumbnailCache::insert(const QString &key, qint64 size)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_totalBytes -= it->size;
+        it->size = size;
+        m_totalBytes += size;
+        touch(key);
+    } else {
+        Entry entry;
+        entry.size = size;
+        entry.stamp = nextStamp();
+        m_entries.insert(key, entry);
+        m_lru.insert(entry.stamp, key);
+        m_totalBytes += size;
+    }
+    evictIfNeeded(key);
+}
+
+void ThumbnailCache::remove(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_lru.remove(it->stamp);
+    m_totalBytes -= it->size;
+    m_entries.erase(it);
+    QFile::remove(filePath(key));
+}
+
+qint64 ThumbnailCache::nextStamp()
+{
+    m_lastStamp = qMax(m_lastStamp + 1, QDateTime::currentMSecsSinceEpoch());
+    return m_lastStamp;
+}
+
+void ThumbnailCache::evictIfNeeded(const QString &keepKey)
+{
+    auto it = m_lru.begin();
+    while (m_totalBytes > m_maxBytes && it != m_lru.end()) {
+        if (it.value() == keepKey) {
+            ++it;
+            continue;
+        }
+        auto entry = m_entries.find(it.value());
+        if (entry != m_entries.end()) {
+            m_totalBytes -= entry->size;
+            m_entries.erase(entry);
+        }
+        QFile::remove(filePath(it.value()));
+        it = m_lru.erase(it);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QMap>
+
+// 缩略图的磁盘缓存索引
+// 每张缩略图是目录中的一个JPEG文件（键为视频标识），文件的读写由调用方在工作线程中完成，
+// 这里只维护索引和访问顺序；总大小超过上限时按最近最少使用的顺序删除。
+// 文件修改时间作为最近访问时间，重启后恢复访问顺序；目录在第一次使用前才扫描，不拖慢启动。
+// 非线程安全，只在GUI线程中使用。
+class ThumbnailCache
+{
+public:
+    ThumbnailCache(const QString &directory, qint64 maxBytes);
+    
+    bool isLoaded() const { return m_loaded; }
+    void load();
+    
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 totalBytes() const { return m_totalBytes; }
+    
+    bool contains(const QString &key) const { return m_entries.contains(key); }
+    QString filePath(const QString &key) const;
+    
+    // 记录一次访问，返回新的访问时间戳（调用方读取文件时据此更新修改时间）
+    qint64 touch(const QString &key);
+    // 登记调用方已写入的文件
+    void insert(const QString &key, qint64 size);
+    // 文件损坏或已被外部删除
+    void remove(const QString &key);
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 stamp;
+    };
+    
+    qint64 nextStamp();
+    void evictIfNeeded(const QString &keepKey);
+    
+    QString m_directory;
+    qint64 m_maxBytes;
+    qint64 m_totalBytes;
+    qint64 m_lastStamp;
+    bool m_loaded;
+    QHash<QString, Entry> m_entries;
+    QMap<qint64, QString> m_lru;   // 访问时间戳 -> 键，最早的排在前面
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,216 @@
+#include "thumbnailprovider.h"
+#include "framesampler.h"
+#include "videohash.h"
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QImage>
+#include <QImageReader>
+#include <QDateTime>
+
+namespace {
+
+constexpr qreal RepresentativeFraction = 0.1;   // 避开片头黑场，又不至于剧透
+constexpr int JpegQuality = 80;
+
+// 按比例放大填满后居中裁剪，所有缩略图尺寸一致
+QImage cropToThumbnail(const QImage &image)
+{
+    const QSize size(ThumbnailProvider::ImageWidth, ThumbnailProvider::ImageHeight);
+    QImage scaled = image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    int x = (scaled.width() - size.width()) / 2;
+    int y = (scaled.height() - size.height()) / 2;
+    return scaled.copy(x, y, size.width(), size.height()).convertToFormat(QImage::Format_RGB32);
+}
+
+}
+
+ThumbnailProvider::ThumbnailProvider(const QString &cacheDirectory, qint64 cacheBytes, QObject *parent)
+    : QObject(parent)
+    , m_cache(cacheDirectory, cacheBytes)
+{
+    for (int i = 0; i < SamplerCount; ++i) {
+        FrameSampler *sampler = new FrameSampler(this);
+        connect(sampler, &FrameSampler::frameSampled, this, [this, sampler](int, const QVideoFrame &frame) {
+            onFrameSampled(sampler, frame);
+        });
+        connect(sampler, &FrameSampler::finished, this, [this, sampler]() {
+            onSamplerFinished(sampler);
+        });
+        m_samplers.append(sampler);
+    }
+    // 缩放和编解码都很快，少量线程即可，不与播放争抢CPU
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 4, 2));
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+    for (FrameSampler *sampler : std::as_const(m_samplers)) {
+        sampler->cancel();
+    }
+    m_pool.waitForDone();
+}
+
+void ThumbnailProvider::setCacheBytes(qint64 bytes)
+{
+    m_cache.setMaxBytes(bytes);
+}
+
+void ThumbnailProvider::setVisible(const QStringList &paths)
+{
+    if (!m_cache.isLoaded() && !paths.isEmpty()) {
+        m_cache.load();
+    }
+    m_visibleSet = QSet<QString>(paths.cbegin(), paths.cend());
+
+    // 只保留屏幕上的行的缩略图
+    for (auto it = m_pixmaps.begin(); it != m_pixmaps.end();) {
+        if (m_visibleSet.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_pixmaps.erase(it);
+        }
+    }
+
+    // 已滚出视野的文件不再等待抽帧；正在进行的抽帧照常完成，结果写入磁盘缓存
+    m_pending.clear();
+    for (const QString &path : paths) {
+        if (m_pixmaps.contains(path) || m_loading.contains(path) || m_sampling.contains(path)
+            || m_encoding.contains(path) || m_failed.contains(path)) {
+            continue;
+        }
+        QString key = keyFor(path);
+        if (m_cache.contains(key)) {
+            startLoad(path, key);
+        } else {
+            m_pending.append(path);
+        }
+    }
+    schedule();
+}
+
+QString ThumbnailProvider::keyFor(const QString &path)
+{
+    auto it = m_keys.constFind(path);
+    if (it == m_keys.constEnd()) {
+        // 标识包含文件大小和修改时间，视频被替换后生成新的缩略图
+        it = m_keys.insert(path, VideoHash::compute(path));
+    }
+    return it.value();
+}
+
+void ThumbnailProvider::startLoad(const QString &path, const QString &key)
+{
+    m_loading.insert(path);
+    qint64 stamp = m_cache.touch(key);
+    QString filePath = m_cache.filePath(key);
+
+    QPointer<ThumbnailProvider> guard(this);
+    m_pool.start([guard, path, key, filePath, stamp]() {
+        QImage image;
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadWrite)) {
+            QImageReader reader(&file, "jpg");
+            image = reader.read();
+            // 修改时间记录最近访问，下次启动时恢复淘汰顺序
+            file.setFileTime(QDateTime::fromMSecsSinceEpoch(stamp), QFileDevice::FileModificationTime);
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, path, key, image]() {
+            if (guard) {
+                guard->onImageLoaded(path, key, image);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ThumbnailProvider::onImageLoaded(const QString &path, const QString &key, const QImage &image)
+{
+    m_loading.remove(path);
+    if (image.isNull()) {
+        // 缓存文件损坏或已被删除，重新生成
+        m_cache.remove(key);
+        if (m_visibleSet.contains(path)) {
+            m_pending.prepend(path);
+            schedule();
+        }
+        return;
+    }
+    if (m_visibleSet.contains(path)) {
+        m_pixmaps.insert(path, QPixmap::fromImage(image));
+        emit thumbnailReady(path);
+    }
+}
+
+void ThumbnailProvider::schedule()
+{
+    for (FrameSampler *sampler : std::as_const(m_samplers)) {
+        if (m_pending.isEmpty()) {
+            return;
+        }
+        if (sampler->isBusy()) {
+            continue;
+        }
+        QString path = m_pending.takeFirst();
+        m_sampling.insert(path);
+        m_activePaths.insert(sampler, path);
+        sampler->start(path, {RepresentativeFraction});
+    }
+}
+
+void ThumbnailProvider::onFrameSampled(FrameSampler *sampler, const QVideoFrame &frame)
+{
+    QString path = m_activePaths.value(sampler);
+    if (!m_sampling.remove(path)) {
+        return;
+    }
+    m_encoding.insert(path);
+
+    QString key = keyFor(path);
+    QString filePath = m_cache.filePath(key);
+    QPointer<ThumbnailProvider> guard(this);
+    m_pool.start([guard, path, key, filePath, frame]() {
+        QImage image = frame.toImage();
+        qint64 bytes = -1;
+        if (!image.isNull()) {
+            image = cropToThumbnail(image);
+            QSaveFile file(filePath);
+            if (file.open(QIODevice::WriteOnly) && image.save(&file, "jpg", JpegQuality) && file.commit()) {
+                bytes = QFileInfo(filePath).size();
+            }
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, path, key, image, bytes]() {
+            if (guard) {
+                guard->onImageStored(path, key, image, bytes);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ThumbnailProvider::onSamplerFinished(FrameSampler *sampler)
+{
+    // 抽帧结束时仍未取到帧（无法打开或定位超时），本次运行不再尝试
+    QString path = m_activePaths.take(sampler);
+    if (m_sampling.remove(path)) {
+        m_failed.insert(path);
+    }
+    schedule();
+}
+
+void ThumbnailProvider::onImageStored(const QString &path, const QString &key, const QImage &image, qint64 bytes)
+{
+    m_encoding.remove(path);
+    if (image.isNull()) {
+        m_failed.insert(path);
+        return;
+    }
+    if (bytes >= 0) {
+        m_cache.insert(key, bytes);
+    }
+    if (m_visibleSet.contains(path)) {
+        m_pixmaps.insert(path, QPixmap::fromImage(image));
+        emit thumbnailReady(path);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPixmap>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVideoFrame>
+#include "thumbnailcache.h"
+
+class FrameSampler;
+
+// 播放列表缩略图
+// 只为可见的行准备缩略图：磁盘缓存中已有的在线程池中读取，没有的由少量抽帧器
+// 取视频10%处的一帧，在线程池中缩小、编码并写入磁盘缓存。
+// 内存中只保留可见行的缩略图，滚出视野即释放；打不开的文件本次运行不再重试。
+class ThumbnailProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    ThumbnailProvider(const QString &cacheDirectory, qint64 cacheBytes, QObject *parent = nullptr);
+    ~ThumbnailProvider() override;
+
+    void setCacheBytes(qint64 bytes);
+
+    // 设置当前可见的本地文件（按显示顺序），只为这些文件准备缩略图
+    void setVisible(const QStringList &paths);
+    // 内存中的缩略图，尚未准备好时返回空图
+    QPixmap thumbnail(const QString &path) const { return m_pixmaps.value(path); }
+
+    // 缓存中保存的尺寸，显示时按一半绘制，高分屏上依然清晰
+    static constexpr int ImageWidth = 96;
+    static constexpr int ImageHeight = 54;
+    static constexpr int SamplerCount = 2;
+
+signals:
+    void thumbnailReady(const QString &path);
+
+private:
+    void schedule();
+    QString keyFor(const QString &path);
+    void startLoad(const QString &path, const QString &key);
+    void onFrameSampled(FrameSampler *sampler, const QVideoFrame &frame);
+    void onSamplerFinished(FrameSampler *sampler);
+    void onImageLoaded(const QString &path, const QString &key, const QImage &image);
+    void onImageStored(const QString &path, const QString &key, const QImage &image, qint64 bytes);
+
+    ThumbnailCache m_cache;
+    QThreadPool m_pool;
+    QList<FrameSampler *> m_samplers;
+    QHash<FrameSampler *, QString> m_activePaths;
+    QSet<QString> m_visibleSet;
+    QStringList m_pending;          // 等待抽帧的可见文件，按显示顺序
+    QSet<QString> m_loading;        // 正在从磁盘缓存读取
+    QSet<QString> m_sampling;       // 正在抽帧
+    QSet<QString> m_encoding;       // 已取到帧，正在编码写入
+    QSet<QString> m_failed;
+    QHash<QString, QString> m_keys; // 路径 -> 缓存键
+    QHash<QString, QPixmap> m_pixmaps;
+};
+
+#endif // THUMBNAILPROVIDER_H
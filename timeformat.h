@@ -0,0 +1,51 @@
+#ifndef TIMEFORMAT_H
+#define TIMEFORMAT_H
+
+#include <QChar>
+#include <QtGlobal>
+
+// 时间文本缓冲区所需的最大长度（足够容纳 "hh:mm:ss / hh:mm:ss"）
+constexpr int TimeTextCapacity = 64;
+
+// 将毫秒格式化为 mm:ss 或 hh:mm:ss 写入buffer，返回写入的字符数
+// 直接写入调用方提供的缓冲区，不分配内存
+inline int formatTimeTo(qint64 timeInMs, QChar *buffer)
+{
+    if (timeInMs < 0) {
+        timeInMs = 0;
+    }
+    
+    qint64 seconds = timeInMs / 1000;
+    qint64 minutes = seconds / 60;
+    qint64 hours = minutes / 60;
+    
+    seconds %= 60;
+    minutes %= 60;
+    
+    int length = 0;
+    if (hours > 0) {
+        // 小时至少两位，超过两位时按实际位数输出
+        char digits[20];
+        int count = 0;
+        while (hours > 0) {
+            digits[count++] = char('0' + hours % 10);
+            hours /= 10;
+        }
+        if (count < 2) {
+            digits[count++] = '0';
+        }
+        while (count > 0) {
+            buffer[length++] = QChar(digits[--count]);
+        }
+        buffer[length++] = QChar(':');
+    }
+    
+    buffer[length++] = QChar(char('0' + minutes / 10));
+    buffer[length++] = QChar(char('0' + minutes % 10));
+    buffer[length++] = QChar(':');
+    buffer[length++] = QChar(char('0' + seconds / 10));
+    buffer[length++] = QChar(char('0' + seconds % 10));
+    return length;
+}
+
+#endif // TIMEFORMAT_H
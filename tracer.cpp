@@ -0,0 +1,228 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+namespace {
+
+constexpr quint64 RingCapacity = 8192;   // 每个线程保留最近的事件数，必须是2的幂
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 timestampNs;
+    qint64 durationNs;
+    quint64 id;
+    qint64 argument;
+    char phase;   // X: 同步区间，b/n/e: 异步区间开始/中间点/结束，i: 瞬时事件
+};
+
+// 单个线程的环形缓冲区：只有所属线程写入，dump()在其他线程读取
+struct TraceRing
+{
+    TraceEvent events[RingCapacity];
+    std::atomic<quint64> written{0};
+    int threadIndex = 0;
+    QString threadName;
+
+    void push(const TraceEvent &event)
+    {
+        quint64 count = written.load(std::memory_order_relaxed);
+        events[count & (RingCapacity - 1)] = event;
+        written.store(count + 1, std::memory_order_release);
+    }
+};
+
+QElapsedTimer g_clock;
+std::atomic<quint64> g_nextId{1};
+QString g_outputPath;
+
+// 缓冲区只在线程第一次记录时登记，之后记录不再加锁；线程退出后保留，dump时仍可读出
+QMutex g_ringsMutex;
+QList<TraceRing *> g_rings;
+thread_local TraceRing *t_ring = nullptr;
+
+TraceRing *currentRing()
+{
+    if (t_ring) {
+        return t_ring;
+    }
+    TraceRing *ring = new TraceRing;
+    QThread *thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        ring->threadName = "主线程";
+    } else {
+        ring->threadName = thread->objectName();
+    }
+    QMutexLocker locker(&g_ringsMutex);
+    ring->threadIndex = int(g_rings.size()) + 1;
+    if (ring->threadName.isEmpty()) {
+        ring->threadName = QString("线程 %1").arg(ring->threadIndex);
+    }
+    g_rings.append(ring);
+    t_ring = ring;
+    return ring;
+}
+
+void record(const char *name, char phase, qint64 timestampNs, qint64 durationNs = 0,
+            quint64 id = 0, qint64 argument = -1)
+{
+    currentRing()->push({name, timestampNs, durationNs, id, argument, phase});
+}
+
+// 复制一个缓冲区中仍然有效的事件；复制期间被覆盖的部分丢弃
+QList<TraceEvent> snapshot(const TraceRing *ring)
+{
+    quint64 end = ring->written.load(std::memory_order_acquire);
+    quint64 begin = end > RingCapacity ? end - RingCapacity : 0;
+    QList<TraceEvent> events;
+    events.reserve(int(end - begin));
+    for (quint64 i = begin; i < end; ++i) {
+        events.append(ring->events[i & (RingCapacity - 1)]);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    quint64 after = ring->written.load(std::memory_order_relaxed);
+    // 写入线程可能正在写第after个事件（尚未发布），它与第after - RingCapacity个事件是同一个槽位，也要丢弃
+    quint64 overwritten = after + 1 > RingCapacity ? after + 1 - RingCapacity : 0;
+    if (overwritten > begin) {
+        events.remove(0, int(qMin(overwritten, end) - begin));
+    }
+    return events;
+}
+
+}
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+void Tracer::start(const QString &outputPath)
+{
+    g_outputPath = outputPath;
+    g_clock.start();
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+qint64 Tracer::now()
+{
+    return g_clock.nsecsElapsed();
+}
+
+quint64 Tracer::nextId()
+{
+    return g_nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tracer::complete(const char *name, qint64 startNs)
+{
+    if (isEnabled()) {
+        record(name, 'X', startNs, now() - startNs);
+    }
+}
+
+void Tracer::asyncBegin(const char *name, quint64 id, qint64 argument)
+{
+    if (isEnabled()) {
+        record(name, 'b', now(), 0, id, argument);
+    }
+}
+
+void Tracer::asyncStep(const char *name, quint64 id)
+{
+    if (isEnabled()) {
+        record(name, 'n', now(), 0, id);
+    }
+}
+
+void Tracer::asyncEnd(const char *name, quint64 id)
+{
+    if (isEnabled()) {
+        record(name, 'e', now(), 0, id);
+    }
+}
+
+void Tracer::instant(const char *name)
+{
+    if (isEnabled()) {
+        record(name, 'i', now());
+    }
+}
+
+QString Tracer::outputPath()
+{
+    return g_outputPath;
+}
+
+bool Tracer::dump(QString *errorString)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+
+    QList<TraceRing *> rings;
+    {
+        QMutexLocker locker(&g_ringsMutex);
+        rings = g_rings;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const TraceRing *ring : std::as_const(rings)) {
+        QJsonObject threadName;
+        threadName.insert("name", "thread_name");
+        threadName.insert("ph", "M");
+        threadName.insert("pid", pid);
+        threadName.insert("tid", ring->threadIndex);
+        threadName.insert("args", QJsonObject{{"name", ring->threadName}});
+        traceEvents.append(threadName);
+
+        const QList<TraceEvent> events = snapshot(ring);
+        for (const TraceEvent &event : events) {
+            QJsonObject object;
+            object.insert("name", QString::fromUtf8(event.name));
+            object.insert("cat", "player");
+            object.insert("ph", QString(QLatin1Char(event.phase)));
+            object.insert("pid", pid);
+            object.insert("tid", ring->threadIndex);
+            // 跟踪格式的时间单位是微秒
+            object.insert("ts", event.timestampNs / 1000.0);
+            if (event.phase == 'X') {
+                object.insert("dur", event.durationNs / 1000.0);
+            } else if (event.phase == 'i') {
+                object.insert("s", "t");
+            } else {
+                object.insert("id", QString::number(event.id));
+            }
+            if (event.argument >= 0) {
+                object.insert("args", QJsonObject{{"value", event.argument}});
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", "ms");
+
+    QSaveFile file(g_outputPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <atomic>
+
+// 播放流程时间线记录器，输出Chrome/Perfetto跟踪格式（chrome://tracing 或 ui.perfetto.dev 打开）
+// 通过 --trace 参数启用；未启用时每个记录点只读一次原子标志。
+// 每个线程写入自己的环形缓冲区，记录时不加锁，缓冲区满后覆盖最早的事件。
+// 事件名必须是字符串字面量（只保存指针）。
+class Tracer
+{
+public:
+    // 开始记录，dump()写入outputPath
+    static void start(const QString &outputPath);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // 自start()起的纳秒数
+    static qint64 now();
+    // 异步区间的编号，begin和end使用同一编号
+    static quint64 nextId();
+
+    // 同步区间（开始时间到现在）
+    static void complete(const char *name, qint64 startNs);
+    // 跨越多个回调的异步区间，argument < 0 表示没有参数
+    static void asyncBegin(const char *name, quint64 id, qint64 argument = -1);
+    static void asyncStep(const char *name, quint64 id);
+    static void asyncEnd(const char *name, quint64 id);
+    static void instant(const char *name);
+
+    // 把各线程缓冲区中的事件写入文件，返回是否成功
+    static bool dump(QString *errorString = nullptr);
+    static QString outputPath();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// 作用域内的同步区间
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_start(m_name ? Tracer::now() : 0)
+    {
+    }
+    ~TraceScope()
+    {
+        if (m_name) {
+            Tracer::complete(m_name, m_start);
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#endif // TRACER_H
@@ -0,0 +1,44 @@
+#include "uirefreshscheduler.h"
+#include <QGuiApplication>
+#include <QScreen>
+
+UiRefreshScheduler::UiRefreshScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(nullptr)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    updateFrameInterval();
+    
+    connect(m_timer, &QTimer::timeout, this, &UiRefreshScheduler::onTimeout);
+}
+
+void UiRefreshScheduler::requestRefresh()
+{
+    if (!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+void UiRefreshScheduler::refreshNow()
+{
+    m_timer->stop();
+    emit refresh();
+}
+
+void UiRefreshScheduler::onTimeout()
+{
+    emit refresh();
+}
+
+void UiRefreshScheduler::updateFrameInterval()
+{
+    // 按主屏幕刷新率计算帧间隔，获取不到时按60Hz处理
+    qreal refreshRate = 60.0;
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 1.0) {
+        refreshRate = screen->refreshRate();
+    }
+    m_timer->setInterval(qMax(1, qRound(1000.0 / refreshRate)));
+}
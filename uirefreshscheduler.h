@@ -0,0 +1,35 @@
+#ifndef UIREFRESHSCHEDULER_H
+#define UIREFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+
+// 界面刷新调度器
+// 把播放过程中高频的刷新请求合并为每个显示帧最多一次 refresh() 信号，
+// 没有请求时定时器不运行，GUI线程保持空闲
+class UiRefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UiRefreshScheduler(QObject *parent = nullptr);
+    
+    // 请求在下一帧刷新，同一帧内的多次请求只触发一次
+    void requestRefresh();
+    
+    // 立即刷新，并取消已排队的请求
+    void refreshNow();
+
+signals:
+    void refresh();
+
+private slots:
+    void onTimeout();
+
+private:
+    void updateFrameInterval();
+    
+    QTimer *m_timer;
+};
+
+#endif // UIREFRESHSCHEDULER_H
@@ -0,0 +1,124 @@
+#include "videoframeutils.h"
+#include <QImage>
+#include <cstring>
+
+namespace {
+
+// 采样网格：输出格子中心对应的源坐标
+inline int sourceCoordinate(int index, int outSize, int sourceSize)
+{
+    return int((qint64(index) * 2 + 1) * sourceSize / (qint64(outSize) * 2));
+}
+
+void sampleBytes(const uchar *bits, int bytesPerLine, int width, int height,
+                 int bytesPerPixel, int offset, quint8 *out, int outWidth, int outHeight)
+{
+    for (int oy = 0; oy < outHeight; ++oy) {
+        const uchar *line = bits + qint64(sourceCoordinate(oy, outHeight, height)) * bytesPerLine;
+        for (int ox = 0; ox < outWidth; ++ox) {
+            *out++ = line[sourceCoordinate(ox, outWidth, width) * bytesPerPixel + offset];
+        }
+    }
+}
+
+void sampleRgb(const uchar *bits, int bytesPerLine, int width, int height,
+               int redOffset, int greenOffset, int blueOffset,
+               quint8 *out, int outWidth, int outHeight)
+{
+    for (int oy = 0; oy < outHeight; ++oy) {
+        const uchar *line = bits + qint64(sourceCoordinate(oy, outHeight, height)) * bytesPerLine;
+        for (int ox = 0; ox < outWidth; ++ox) {
+            const uchar *pixel = line + sourceCoordinate(ox, outWidth, width) * 4;
+            // BT.601 亮度近似
+            *out++ = quint8((77 * pixel[redOffset] + 150 * pixel[greenOffset] + 29 * pixel[blueOffset]) >> 8);
+        }
+    }
+}
+
+bool sampleMapped(const QVideoFrame &frame, quint8 *out, int outWidth, int outHeight)
+{
+    const int width = frame.width();
+    const int height = frame.height();
+    const uchar *bits = frame.bits(0);
+    const int bytesPerLine = frame.bytesPerLine(0);
+    
+    switch (frame.pixelFormat()) {
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_Y8:
+        sampleBytes(bits, bytesPerLine, width, height, 1, 0, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+    case QVideoFrameFormat::Format_Y16:
+        // 16位小端亮度，取高字节
+        sampleBytes(bits, bytesPerLine, width, height, 2, 1, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_YUYV:
+        sampleBytes(bits, bytesPerLine, width, height, 2, 0, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_UYVY:
+        sampleBytes(bits, bytesPerLine, width, height, 2, 1, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_XRGB8888:
+        sampleRgb(bits, bytesPerLine, width, height, 1, 2, 3, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+        sampleRgb(bits, bytesPerLine, width, height, 2, 1, 0, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+        sampleRgb(bits, bytesPerLine, width, height, 3, 2, 1, out, outWidth, outHeight);
+        return true;
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+        sampleRgb(bits, bytesPerLine, width, height, 0, 1, 2, out, outWidth, outHeight);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+namespace VideoFrameUtils {
+
+bool downscaleLuma(const QVideoFrame &frame, quint8 *out, int outWidth, int outHeight)
+{
+    if (!frame.isValid() || outWidth <= 0 || outHeight <= 0) {
+        return false;
+    }
+    
+    QVideoFrame mapped(frame);
+    if (mapped.map(QtVideo::MapMode::ReadOnly)) {
+        bool sampled = sampleMapped(mapped, out, outWidth, outHeight);
+        mapped.unmap();
+        if (sampled) {
+            return true;
+        }
+    }
+    
+    QImage image = frame.toImage();
+    if (image.isNull()) {
+        return false;
+    }
+    image = image.scaled(outWidth, outHeight, Qt::IgnoreAspectRatio, Qt::FastTransformation)
+                 .convertToFormat(QImage::Format_Grayscale8);
+    for (int y = 0; y < outHeight; ++y) {
+        std::memcpy(out + y * outWidth, image.constScanLine(y), outWidth);
+    }
+    return true;
+}
+
+}
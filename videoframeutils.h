@@ -0,0 +1,16 @@
+#ifndef VIDEOFRAMEUTILS_H
+#define VIDEOFRAMEUTILS_H
+
+#include <QVideoFrame>
+
+// 视频帧辅助函数
+namespace VideoFrameUtils {
+
+// 把帧的亮度缩小采样到 outWidth x outHeight 的8位缓冲区（最近邻采样）
+// 平面YUV、半平面YUV、打包YUV和32位RGB格式直接读取映射后的内存，
+// 其他格式（包括无法映射的硬件帧）退回到QVideoFrame::toImage()
+bool downscaleLuma(const QVideoFrame &frame, quint8 *out, int outWidth, int outHeight);
+
+}
+
+#endif // VIDEOFRAMEUTILS_H
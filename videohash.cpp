@@ -0,0 +1,27 @@
+#include "videohash.h"
+#include "mediapath.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+
+namespace VideoHash {
+
+QString compute(const QString &filePath)
+{
+    // 网络视频没有文件信息，直接以地址作为标识
+    if (isStreamUrl(filePath)) {
+        return QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Md5).toHex();
+    }
+    
+    QFileInfo fileInfo(filePath);
+    QString hashSource = QString("%1_%2_%3")
+                           .arg(fileInfo.absoluteFilePath())
+                           .arg(fileInfo.size())
+                           .arg(fileInfo.lastModified().toString(Qt::ISODate));
+    
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(hashSource.toUtf8());
+    return hash.result().toHex();
+}
+
+}
@@ -0,0 +1,15 @@
+#ifndef VIDEOHASH_H
+#define VIDEOHASH_H
+
+#include <QString>
+
+// 视频标识，用作播放位置、章节等设置项的键
+namespace VideoHash {
+
+// 本地文件由绝对路径、大小和修改时间计算（文件被替换后标识随之改变），
+// 网络视频直接由地址计算
+QString compute(const QString &filePath);
+
+}
+
+#endif // VIDEOHASH_H
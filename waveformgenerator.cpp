@@ -0,0 +1,264 @@
+#include "waveformgenerator.h"
+#include "simdkernels.h"
+#include "audiobufferutils.h"
+#include <QThread>
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QUrl>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr quint32 PeaksMagic = 0x57415645;   // "WAVE"
+constexpr quint32 PeaksVersion = 1;
+constexpr int AnalysisSampleRate = 8000;     // 波形只需要包络，低采样率即可
+constexpr int MinTopLevelBuckets = 256;
+
+inline qint8 quantize(float value)
+{
+    return qint8(qBound(-127, int(std::lround(value * 127.0f)), 127));
+}
+
+}
+
+// 运行在工作线程中，解码器也在工作线程中创建
+class WaveformWorker : public QObject
+{
+public:
+    WaveformWorker(const QString &cacheDirectory, WaveformGenerator *owner)
+        : m_cacheDirectory(cacheDirectory)
+        , m_owner(owner)
+        , m_decoder(nullptr)
+        , m_samplesPerBucket(0)
+        , m_bucketFill(0)
+        , m_bucketMin(0.0f)
+        , m_bucketMax(0.0f)
+    {
+    }
+    
+    void start(const QString &filePath, const QString &videoHash)
+    {
+        stopDecoder();
+        m_videoHash = videoHash;
+        
+        WaveformPeaks peaks;
+        if (loadCache(peaks)) {
+            deliver(peaks);
+            return;
+        }
+        
+        if (!m_decoder) {
+            m_decoder = new QAudioDecoder(this);
+            QObject::connect(m_decoder, &QAudioDecoder::bufferReady, this, [this]() { onBufferReady(); });
+            QObject::connect(m_decoder, &QAudioDecoder::finished, this, [this]() { onFinished(true); });
+            QObject::connect(m_decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+                             [this](QAudioDecoder::Error error) {
+                // 只有格式错误且没有解出任何音频（没有音轨）才值得记住；
+                // 共享暂时不可用、中途解码失败等情况只交付已有结果，下次打开时重试
+                onFinished(error == QAudioDecoder::FormatError && m_base.isEmpty() && m_bucketFill == 0);
+            });
+        }
+        
+        QAudioFormat format;
+        format.setSampleFormat(QAudioFormat::Float);
+        format.setChannelCount(1);
+        format.setSampleRate(AnalysisSampleRate);
+        m_decoder->setAudioFormat(format);
+        m_decoder->setSource(QUrl::fromLocalFile(filePath));
+        
+        m_base.clear();
+        m_samplesPerBucket = 0;
+        m_bucketFill = 0;
+        m_decoding = true;
+        m_decoder->start();
+    }
+    
+    void stopDecoder()
+    {
+        m_decoding = false;
+        if (m_decoder) {
+            m_decoder->stop();
+        }
+    }
+
+private:
+    void onBufferReady()
+    {
+        QAudioBuffer buffer = m_decoder->read();
+        if (!m_decoding || !buffer.isValid()) {
+            return;
+        }
+        if (m_samplesPerBucket == 0) {
+            // 后端不支持请求的格式时按实际采样率分桶
+            m_samplesPerBucket = qMax(1, buffer.format().sampleRate() * WaveformGenerator::BucketMs / 1000);
+        }
+        AudioBufferUtils::toMonoFloat(buffer, m_samples);
+        
+        const float *data = m_samples.data();
+        int remaining = int(m_samples.size());
+        while (remaining > 0) {
+            if (m_bucketFill == 0) {
+                m_bucketMin = data[0];
+                m_bucketMax = data[0];
+            }
+            int take = qMin(remaining, m_samplesPerBucket - m_bucketFill);
+            SimdKernels::minMaxF32(data, take, &m_bucketMin, &m_bucketMax);
+            data += take;
+            remaining -= take;
+            m_bucketFill += take;
+            if (m_bucketFill == m_samplesPerBucket) {
+                appendBucket();
+            }
+        }
+    }
+    
+    void appendBucket()
+    {
+        m_base.append(char(quantize(m_bucketMin)));
+        m_base.append(char(quantize(m_bucketMax)));
+        m_bucketFill = 0;
+    }
+    
+    // persist为false时结果只交付，不写入缓存
+    void onFinished(bool persist)
+    {
+        if (!m_decoding) {
+            return;
+        }
+        m_decoding = false;
+        if (m_bucketFill > 0) {
+            appendBucket();
+        }
+        
+        // 没有音轨的视频也保存空结果，下次不再解码
+        WaveformPeaks peaks;
+        peaks.bucketMs = WaveformGenerator::BucketMs;
+        if (!m_base.isEmpty()) {
+            peaks.levels.append(m_base);
+            buildPyramid(peaks);
+        }
+        if (persist) {
+            saveCache(peaks);
+        }
+        m_base.clear();
+        deliver(peaks);
+    }
+    
+    static void buildPyramid(WaveformPeaks &peaks)
+    {
+        while (peaks.levels.last().size() / 2 > MinTopLevelBuckets) {
+            const QByteArray &lower = peaks.levels.last();
+            const qsizetype buckets = lower.size() / 2;
+            QByteArray upper((buckets + 1) / 2 * 2, Qt::Uninitialized);
+            for (qsizetype i = 0; i < buckets; i += 2) {
+                qint8 low = qint8(lower[i * 2]);
+                qint8 high = qint8(lower[i * 2 + 1]);
+                if (i + 1 < buckets) {
+                    low = qMin(low, qint8(lower[i * 2 + 2]));
+                    high = qMax(high, qint8(lower[i * 2 + 3]));
+                }
+                upper[i] = char(low);
+                upper[i + 1] = char(high);
+            }
+            peaks.levels.append(upper);
+        }
+    }
+    
+    QString cachePath() const
+    {
+        return QDir(m_cacheDirectory).filePath(m_videoHash + ".peaks");
+    }
+    
+    bool loadCache(WaveformPeaks &peaks) const
+    {
+        QFile file(cachePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        quint32 magic = 0;
+        quint32 version = 0;
+        qint32 bucketMs = 0;
+        stream >> magic >> version >> bucketMs >> peaks.levels;
+        peaks.bucketMs = bucketMs;
+        return stream.status() == QDataStream::Ok && magic == PeaksMagic && version == PeaksVersion
+               && bucketMs == WaveformGenerator::BucketMs;
+    }
+    
+    void saveCache(const WaveformPeaks &peaks) const
+    {
+        QDir().mkpath(m_cacheDirectory);
+        QSaveFile file(cachePath());
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << PeaksMagic << PeaksVersion << qint32(peaks.bucketMs) << peaks.levels;
+        file.commit();
+    }
+    
+    void deliver(const WaveformPeaks &peaks)
+    {
+        WaveformGenerator *owner = m_owner;
+        QString videoHash = m_videoHash;
+        QMetaObject::invokeMethod(owner, [owner, videoHash, peaks]() {
+            emit owner->ready(videoHash, peaks);
+        }, Qt::QueuedConnection);
+    }
+    
+    QString m_cacheDirectory;
+    WaveformGenerator *m_owner;
+    QAudioDecoder *m_decoder;
+    QString m_videoHash;
+    bool m_decoding = false;
+    
+    QByteArray m_base;              // 第0级峰值
+    std::vector<float> m_samples;
+    int m_samplesPerBucket;
+    int m_bucketFill;
+    float m_bucketMin;
+    float m_bucketMax;
+};
+
+WaveformGenerator::WaveformGenerator(const QString &cacheDirectory, QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+{
+    m_worker = new WaveformWorker(cacheDirectory, this);
+    m_workerThread = new QThread(this);
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start(QThread::LowestPriority);
+}
+
+WaveformGenerator::~WaveformGenerator()
+{
+    cancel();
+    m_workerThread->quit();
+    m_workerThread->wait();
+}
+
+void WaveformGenerator::load(const QString &filePath, const QString &videoHash)
+{
+    WaveformWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, filePath, videoHash]() {
+        worker->start(filePath, videoHash);
+    }, Qt::QueuedConnection);
+}
+
+void WaveformGenerator::cancel()
+{
+    WaveformWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() {
+        worker->stopDecoder();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,48 @@
+#ifndef WAVEFORMGENERATOR_H
+#define WAVEFORMGENERATOR_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+
+class QThread;
+class WaveformWorker;
+
+// 多分辨率的音频峰值
+// levels[0]每个桶bucketMs毫秒，之后每一级合并相邻两个桶；
+// 每个桶两个字节：最小值和最大值（-127 ~ 127）
+struct WaveformPeaks
+{
+    int bucketMs = 0;
+    QList<QByteArray> levels;
+    
+    bool isEmpty() const { return levels.isEmpty() || levels.first().isEmpty(); }
+    qint64 durationMs() const { return isEmpty() ? 0 : qint64(levels.first().size() / 2) * bucketMs; }
+};
+
+// 后台生成音频波形
+// 低优先级线程中用QAudioDecoder解码为单声道浮点，按时间桶求最小/最大峰值，
+// 再逐级合并为金字塔。结果按视频哈希保存在缓存目录中，再次打开同一视频时直接读取。
+class WaveformGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WaveformGenerator(const QString &cacheDirectory, QObject *parent = nullptr);
+    ~WaveformGenerator() override;
+    
+    // 开始为视频生成波形（会取消正在进行的生成）
+    void load(const QString &filePath, const QString &videoHash);
+    void cancel();
+    
+    static constexpr int BucketMs = 10;
+
+signals:
+    void ready(const QString &videoHash, const WaveformPeaks &peaks);
+
+private:
+    QThread *m_workerThread;
+    WaveformWorker *m_worker;
+};
+
+#endif // WAVEFORMGENERATOR_H
@@ -0,0 +1,195 @@
+#include "waveformstrip.h"
+#include <QPainter>
+#include <QWheelEvent>
+#include <QMouseEvent>
+
+namespace {
+
+constexpr qint64 MinViewMs = 2000;
+
+}
+
+WaveformStrip::WaveformStrip(QWidget *parent)
+    : QWidget(parent)
+    , m_waveformDirty(true)
+    , m_duration(0)
+    , m_position(0)
+    , m_viewStart(0)
+    , m_viewEnd(0)
+    , m_playheadX(-1)
+{
+    setFixedHeight(24);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setToolTip("音频波形：单击跳转，滚轮缩放，双击恢复");
+}
+
+void WaveformStrip::setPeaks(const WaveformPeaks &peaks)
+{
+    m_peaks = peaks;
+    m_waveformDirty = true;
+    update();
+}
+
+void WaveformStrip::clear()
+{
+    m_peaks = WaveformPeaks();
+    m_duration = 0;
+    m_position = 0;
+    m_viewStart = 0;
+    m_viewEnd = 0;
+    m_playheadX = -1;
+    m_waveformDirty = true;
+    update();
+}
+
+void WaveformStrip::setDuration(qint64 duration)
+{
+    if (duration == m_duration) {
+        return;
+    }
+    m_duration = duration;
+    m_viewStart = 0;
+    m_viewEnd = duration;
+    m_waveformDirty = true;
+    update();
+}
+
+void WaveformStrip::setPosition(qint64 position)
+{
+    m_position = position;
+    
+    // 放大时播放头离开视图，整页滚动跟随
+    qint64 span = m_viewEnd - m_viewStart;
+    if (span > 0 && span < m_duration && (position < m_viewStart || position >= m_viewEnd)) {
+        m_viewStart = qBound<qint64>(0, position - span / 10, m_duration - span);
+        m_viewEnd = m_viewStart + span;
+        m_waveformDirty = true;
+        update();
+        return;
+    }
+    
+    // 播放头像素不变时不重绘
+    int x = xForPosition(position);
+    if (x != m_playheadX) {
+        int oldX = m_playheadX;
+        m_playheadX = x;
+        update(QRect(qMin(oldX, x) - 1, 0, qAbs(x - oldX) + 3, height()));
+    }
+}
+
+qint64 WaveformStrip::positionAt(int x) const
+{
+    if (width() <= 0) {
+        return 0;
+    }
+    return m_viewStart + (m_viewEnd - m_viewStart) * qBound(0, x, width()) / width();
+}
+
+int WaveformStrip::xForPosition(qint64 position) const
+{
+    qint64 span = m_viewEnd - m_viewStart;
+    if (span <= 0) {
+        return -1;
+    }
+    return int((position - m_viewStart) * width() / span);
+}
+
+void WaveformStrip::renderWaveform()
+{
+    m_waveformDirty = false;
+    qreal ratio = devicePixelRatioF();
+    m_waveform = QPixmap((QSizeF(size()) * ratio).toSize());
+    m_waveform.setDevicePixelRatio(ratio);
+    m_waveform.fill(QColor("#f5f5f5"));
+    
+    qint64 span = m_viewEnd - m_viewStart;
+    if (m_peaks.isEmpty() || span <= 0 || width() <= 0) {
+        return;
+    }
+    
+    // 选择每个桶不长于一个像素的最粗级别，每像素只需合并少量桶
+    qreal msPerPixel = qreal(span) / width();
+    int level = 0;
+    while (level + 1 < m_peaks.levels.size() && (qint64(m_peaks.bucketMs) << (level + 1)) <= msPerPixel) {
+        ++level;
+    }
+    const QByteArray &peaks = m_peaks.levels.at(level);
+    const qint64 bucketMs = qint64(m_peaks.bucketMs) << level;
+    const qint64 bucketCount = peaks.size() / 2;
+    
+    QPainter painter(&m_waveform);
+    painter.setPen(QColor("#5a9bd5"));
+    const qreal centerY = height() / 2.0;
+    const qreal scale = (height() / 2.0 - 1) / 127.0;
+    for (int x = 0; x < width(); ++x) {
+        qint64 firstBucket = positionAt(x) / bucketMs;
+        qint64 lastBucket = qMax(firstBucket + 1, positionAt(x + 1) / bucketMs);
+        if (firstBucket >= bucketCount) {
+            break;
+        }
+        lastBucket = qMin(lastBucket, bucketCount);
+        
+        int low = 127;
+        int high = -127;
+        for (qint64 bucket = firstBucket; bucket < lastBucket; ++bucket) {
+            low = qMin(low, int(qint8(peaks[bucket * 2])));
+            high = qMax(high, int(qint8(peaks[bucket * 2 + 1])));
+        }
+        painter.drawLine(QPointF(x + 0.5, centerY - high * scale), QPointF(x + 0.5, centerY - low * scale));
+    }
+}
+
+void WaveformStrip::paintEvent(QPaintEvent *)
+{
+    if (m_waveformDirty) {
+        renderWaveform();
+        m_playheadX = xForPosition(m_position);
+    }
+    
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_waveform);
+    if (m_playheadX >= 0 && m_playheadX < width()) {
+        painter.setPen(QColor("#0078d4"));
+        painter.drawLine(m_playheadX, 0, m_playheadX, height());
+    }
+}
+
+void WaveformStrip::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_waveformDirty = true;
+}
+
+void WaveformStrip::wheelEvent(QWheelEvent *event)
+{
+    if (m_duration <= 0) {
+        return;
+    }
+    // 以鼠标所在时间为中心缩放
+    qint64 anchor = positionAt(int(event->position().x()));
+    qreal factor = event->angleDelta().y() > 0 ? 0.5 : 2.0;
+    qint64 span = qBound<qint64>(qMin(MinViewMs, m_duration), qint64((m_viewEnd - m_viewStart) * factor), m_duration);
+    qreal anchorRatio = width() > 0 ? event->position().x() / width() : 0.5;
+    m_viewStart = qBound<qint64>(0, anchor - qint64(span * anchorRatio), m_duration - span);
+    m_viewEnd = m_viewStart + span;
+    m_waveformDirty = true;
+    update();
+    event->accept();
+}
+
+void WaveformStrip::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_duration > 0) {
+        emit seekRequested(positionAt(int(event->position().x())));
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void WaveformStrip::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    m_viewStart = 0;
+    m_viewEnd = m_duration;
+    m_waveformDirty = true;
+    update();
+    QWidget::mouseDoubleClickEvent(event);
+}
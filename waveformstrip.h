@@ -0,0 +1,48 @@
+#ifndef WAVEFORMSTRIP_H
+#define WAVEFORMSTRIP_H
+
+#include <QWidget>
+#include <QPixmap>
+#include "waveformgenerator.h"
+
+// 进度条下方的音频波形条
+// 根据每像素对应的时长选择合适的峰值级别，波形渲染到缓存图中，
+// 播放位置变化只重绘播放头。滚轮以鼠标位置为中心缩放，双击恢复全长，单击跳转。
+class WaveformStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit WaveformStrip(QWidget *parent = nullptr);
+    
+    void setPeaks(const WaveformPeaks &peaks);
+    void clear();
+    void setDuration(qint64 duration);
+    void setPosition(qint64 position);
+
+signals:
+    void seekRequested(qint64 position);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    void renderWaveform();
+    qint64 positionAt(int x) const;
+    int xForPosition(qint64 position) const;
+    
+    WaveformPeaks m_peaks;
+    QPixmap m_waveform;
+    bool m_waveformDirty;
+    qint64 m_duration;
+    qint64 m_position;
+    qint64 m_viewStart;
+    qint64 m_viewEnd;
+    int m_playheadX;
+};
+
+#endif // WAVEFORMSTRIP_H